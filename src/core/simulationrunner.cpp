@@ -0,0 +1,217 @@
+/*
+  Copyright (c) 2012, BuildmLearn Contributors listed at http://buildmlearn.org/people/
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+
+  * Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+
+  * Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+
+  * Neither the name of the BuildmLearn nor the names of its
+    contributors may be used to endorse or promote products derived from
+    this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "core/simulationrunner.h"
+
+#include "definitions/definitions.h"
+#include "core/templatecore.h"
+#include "core/templateeditor.h"
+#include "core/templatesimulator.h"
+#include "core/templateentrypoint.h"
+#include "core/templatefactory.h"
+#include "miscellaneous/application.h"
+
+#include <QFile>
+#include <QTextStream>
+#include <QElapsedTimer>
+
+
+SimulationRunner::SimulationRunner(QObject *parent)
+  : QObject(parent), m_core(NULL), m_steps(QList<Step>()) {
+}
+
+SimulationRunner::~SimulationRunner() {
+  qDebug("Destroying SimulationRunner instance.");
+
+  if (m_core != NULL) {
+    // Event loop is not running anymore, so objects must be deleted right away.
+    delete m_core->simulator();
+    delete m_core->editor();
+    delete m_core;
+  }
+}
+
+bool SimulationRunner::loadBundle(const QString &bundle_file_name) {
+  QFile bundle_file(bundle_file_name);
+
+  if (!bundle_file.open(QIODevice::Text | QIODevice::ReadOnly | QIODevice::Unbuffered)) {
+    qWarning("Bundle file '%s' cannot be opened for reading.", qPrintable(bundle_file_name));
+    return false;
+  }
+
+  QString bundle_data(bundle_file.readAll());
+  bundle_file.close();
+
+  TemplateEntryPoint *entry_point = qApp->templateManager()->entryPointForBundle(bundle_data);
+
+  if (entry_point == NULL) {
+    qWarning("Bundle file '%s' does not belong to any template.", qPrintable(bundle_file_name));
+    return false;
+  }
+
+  m_core = entry_point->loadCoreFromBundleData(bundle_data);
+
+  if (m_core == NULL) {
+    qWarning("Template was not able to load bundle file '%s'.", qPrintable(bundle_file_name));
+    return false;
+  }
+
+  m_core->launch();
+  return true;
+}
+
+bool SimulationRunner::loadScript(const QString &script_file_name) {
+  QFile script_file(script_file_name);
+
+  if (!script_file.open(QIODevice::Text | QIODevice::ReadOnly)) {
+    qWarning("Script file '%s' cannot be opened for reading.", qPrintable(script_file_name));
+    return false;
+  }
+
+  QTextStream stream(&script_file);
+
+  m_steps.clear();
+
+  while (!stream.atEnd()) {
+    QString line = stream.readLine().trimmed();
+
+    if (line.isEmpty() || line.startsWith('#')) {
+      continue;
+    }
+
+    Step step;
+    step.m_action = line.section(' ', 0, 0);
+    step.m_argument = line.section(' ', 1).trimmed();
+
+    m_steps.append(step);
+  }
+
+  script_file.close();
+  return true;
+}
+
+int SimulationRunner::run(QTextStream &report) {
+  if (m_core == NULL) {
+    return -1;
+  }
+
+  TemplateSimulator *simulator = m_core->simulator();
+  QElapsedTimer timer;
+  int failed_steps = 0;
+  int slowest_step = 0;
+  qint64 slowest_time = 0;
+  qint64 total_time = 0;
+
+  report << "#\taction\targument\tresult\ttime_us\tstate\n";
+
+  // Starting of the simulation is measured as well, it is
+  // reported as step zero.
+  timer.start();
+  bool started = simulator->startSimulation();
+  QCoreApplication::processEvents();
+  slowest_time = total_time = timer.nsecsElapsed() / 1000;
+
+  report << "0\tlaunch\t\t" << (started ? "ok" : "failed") << '\t' << total_time << '\t' << simulator->simulationState() << '\n';
+
+  if (!started) {
+    report.flush();
+    return -1;
+  }
+
+  for (int i = 0; i < m_steps.size(); i++) {
+    const Step &step = m_steps.at(i);
+
+    timer.restart();
+    bool performed = simulator->performAction(step.m_action, step.m_argument);
+
+    // Deliver events posted by the step, so that their cost is accounted too.
+    QCoreApplication::processEvents();
+    qint64 elapsed = timer.nsecsElapsed() / 1000;
+
+    if (!performed) {
+      failed_steps++;
+    }
+
+    if (elapsed > slowest_time) {
+      slowest_time = elapsed;
+      slowest_step = i + 1;
+    }
+
+    total_time += elapsed;
+    report << (i + 1) << '\t' << step.m_action << '\t' << step.m_argument << '\t' <<
+              (performed ? "ok" : "failed") << '\t' << elapsed << '\t' << simulator->simulationState() << '\n';
+  }
+
+  report << "# steps=" << m_steps.size() << " failed=" << failed_steps << " total_us=" << total_time <<
+            " slowest_step=" << slowest_step << " slowest_us=" << slowest_time << '\n';
+  report.flush();
+
+  return failed_steps;
+}
+
+int SimulationRunner::execute(const QStringList &arguments) {
+  int simulate_index = arguments.indexOf(APP_ARG_SIMULATE);
+  int report_index = arguments.indexOf(APP_ARG_REPORT);
+  QString bundle_file_name = arguments.value(simulate_index + 1);
+  QString script_file_name = arguments.value(simulate_index + 2);
+
+  if (script_file_name.startsWith("--")) {
+    // Script is optional, without it only start of simulation is measured.
+    script_file_name.clear();
+  }
+
+  if (simulate_index < 0 || bundle_file_name.isEmpty()) {
+    qWarning("No bundle file specified for headless simulation.");
+    return EXIT_FAILURE;
+  }
+
+  SimulationRunner runner;
+
+  if (!runner.loadBundle(bundle_file_name) ||
+      (!script_file_name.isEmpty() && !runner.loadScript(script_file_name))) {
+    return EXIT_FAILURE;
+  }
+
+  QFile report_file;
+  QTextStream report(stdout);
+
+  if (report_index >= 0) {
+    report_file.setFileName(arguments.value(report_index + 1));
+
+    if (!report_file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text)) {
+      qWarning("Report file '%s' cannot be opened for writing.", qPrintable(report_file.fileName()));
+      return EXIT_FAILURE;
+    }
+
+    report.setDevice(&report_file);
+  }
+
+  return runner.run(report) == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,96 @@
+/*
+  Copyright (c) 2012, BuildmLearn Contributors listed at http://buildmlearn.org/people/
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+
+  * Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+
+  * Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+
+  * Neither the name of the BuildmLearn nor the names of its
+    contributors may be used to endorse or promote products derived from
+    this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef SIMULATIONRUNNER_H
+#define SIMULATIONRUNNER_H
+
+#include <QObject>
+
+#include <QStringList>
+
+
+class TemplateCore;
+class QTextStream;
+
+/// \brief Headless runner of scripted simulations.
+///
+/// Runner loads template core from XML bundle, starts its simulation and
+/// performs scripted sequence of actions via TemplateSimulator::performAction(),
+/// no user interaction is needed. Result and latency of each step
+/// is reported, so runner can be used for automated regression checks
+/// and benchmarking of simulators.
+///
+/// Script is plain text file with one step per line in form "action [argument]",
+/// for example "answer 2". Empty lines and lines starting with '#' are ignored.
+/// \see TemplateSimulator::performAction()
+/// \ingroup template-interfaces
+class SimulationRunner : public QObject {
+    Q_OBJECT
+
+  public:
+    /// \brief Single scripted step of the simulation.
+    struct Step {
+      QString m_action;
+      QString m_argument;
+    };
+
+    // Constructors and destructors.
+    explicit SimulationRunner(QObject *parent = 0);
+    virtual ~SimulationRunner();
+
+    /// \brief Loads template core from XML bundle file.
+    /// \param bundle_file_name File name of XML bundle.
+    /// \return Returns true if bundle was loaded, otherwise returns false.
+    bool loadBundle(const QString &bundle_file_name);
+
+    /// \brief Loads steps of the simulation from script file.
+    /// \param script_file_name File name of the script.
+    /// \return Returns true if script was loaded, otherwise returns false.
+    bool loadScript(const QString &script_file_name);
+
+    /// \brief Runs loaded script against simulation of loaded bundle.
+    /// \param report Stream into which report is written.
+    /// \return Returns number of failed steps or -1 if simulation
+    /// cannot be started at all.
+    int run(QTextStream &report);
+
+    /// \brief Performs complete headless run as specified by command line arguments.
+    /// \param arguments Arguments of the application, they contain
+    /// APP_ARG_SIMULATE followed by bundle file name and optional script file name
+    /// and optionally APP_ARG_REPORT followed by report file name.
+    /// \return Returns exit code of the application.
+    static int execute(const QStringList &arguments);
+
+  private:
+    TemplateCore *m_core;
+    QList<Step> m_steps;
+};
+
+#endif // SIMULATIONRUNNER_H
@@ -43,10 +43,21 @@ TemplateCore::~TemplateCore() {
 }
 
 void TemplateCore::launch() {
+  // Running simulation follows changes made in the editor.
+  connect(m_editor, SIGNAL(itemInserted(int)), m_simulator, SLOT(onItemInserted(int)), Qt::UniqueConnection);
+  connect(m_editor, SIGNAL(itemRemoved(int)), m_simulator, SLOT(onItemRemoved(int)), Qt::UniqueConnection);
+  connect(m_editor, SIGNAL(itemMoved(int,int)), m_simulator, SLOT(onItemMoved(int,int)), Qt::UniqueConnection);
+  connect(m_editor, SIGNAL(itemModified(int)), m_simulator, SLOT(onItemModified(int)), Qt::UniqueConnection);
+  connect(m_editor, SIGNAL(metadataModified()), m_simulator, SLOT(onMetadataModified()), Qt::UniqueConnection);
+
   m_editor->launch();
   m_simulator->launch();
 }
 
+void TemplateCore::prepareGeneration() {
+  emit generationPrepared(true);
+}
+
 QString TemplateCore::assignedFile() const {
     return m_assignedFile;
 }
@@ -67,6 +67,12 @@ class TemplateCore : public QObject {
     /// must contain sufficient data for doing so.
     virtual GenerationResult generateMobileApplication(const QString &input_apk_file, QString &output_file) = 0;
 
+    /// \brief Prepares data which must be obtained asynchronously
+    /// before mobile application is generated.
+    /// \remarks generationPrepared() must be emitted when preparation is done,
+    /// default implementation emits it right away.
+    virtual void prepareGeneration();
+
     /// \brief Called after this template is fully loaded in toolkit.
     /// \note Template is fully loaded only and only if its editor is set as
     /// active and its simulator is set as active. During "launching" usually
@@ -117,6 +123,10 @@ class TemplateCore : public QObject {
     /// generating process.
     void generationProgress(int percent_completed, const QString &progress_info);
 
+    /// \brief Emitted when preparation of generating is done.
+    /// \param ok True if generating can proceed.
+    void generationPrepared(bool ok);
+
   protected:
     TemplateEntryPoint *m_entryPoint;
     TemplateEditor *m_editor;
@@ -142,6 +142,29 @@ class TemplateEditor : public QWidget {
     /// question item to Quiz template editor.
     void canGenerateChanged(bool can_generate, const QString &message = QString());
 
+    /// \brief Emitted when new item (question, word, ...) is inserted
+    /// into the editor.
+    /// \param index Position of newly inserted item.
+    /// \remarks This and following "item" signals are used by running simulation
+    /// to patch only affected parts of its contents.
+    void itemInserted(int index);
+
+    /// \brief Emitted when item is removed from the editor.
+    /// \param index Position which item occupied before its removal.
+    void itemRemoved(int index);
+
+    /// \brief Emitted when item is moved to different position.
+    /// \param from_index Original position of item.
+    /// \param to_index New position of item.
+    void itemMoved(int from_index, int to_index);
+
+    /// \brief Emitted when contents of item are modified.
+    /// \param index Position of modified item.
+    void itemModified(int index);
+
+    /// \brief Emitted when project metadata (name, author) are modified.
+    void metadataModified();
+
   protected:
     bool m_canGenerate;
     QString m_generateMessage;
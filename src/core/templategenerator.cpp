@@ -12,7 +12,8 @@
 #include <QInputDialog>
 
 
-TemplateGenerator::TemplateGenerator(QObject *parent) : QObject(parent) {
+TemplateGenerator::TemplateGenerator(QObject *parent)
+  : QObject(parent), m_activeCore(NULL), m_inputFileName(QString()) {
 }
 
 TemplateGenerator::~TemplateGenerator() {
@@ -38,31 +39,68 @@ void TemplateGenerator::generateMobileApplication(TemplateCore *core) {
       input_file_name += ".apk";
     }
 
+    m_activeCore = core;
+    m_inputFileName = input_file_name;
+
     connect(core, SIGNAL(generationProgress(int,QString)), this, SIGNAL(generationProgress(int,QString)));
+    connect(core, SIGNAL(generationPrepared(bool)), this, SLOT(onGenerationPrepared(bool)));
+    connect(core, SIGNAL(destroyed()), this, SLOT(onActiveCoreDestroyed()));
     emit generationStarted();
 
-    // TODO: upravit signaturu metody generationMobileApplication,
-    // aby brala i ten vstupni nazev ciloveho apk souboru.
+    // Generating continues once the core obtains all its data, lock
+    // is held meanwhile.
+    core->prepareGeneration();
+  }
+  else {
+    qApp->trayIcon()->showMessage(tr("Cannot generate application"),
+                                  tr("Master generation lock is locked, try to\ngenerate application later."),
+                                  QSystemTrayIcon::Warning);
+  }
+}
+
+void TemplateGenerator::onGenerationPrepared(bool ok) {
+  TemplateCore *core = m_activeCore;
 
-    QString output_file;
-    TemplateCore::GenerationResult result = core->generateMobileApplication(input_file_name, output_file);
+  if (core == NULL || sender() != core) {
+    return;
+  }
 
-    disconnect(core, SIGNAL(generationProgress(int,QString)), this, SIGNAL(generationProgress(int,QString)));
+  disconnect(core, SIGNAL(generationPrepared(bool)), this, SLOT(onGenerationPrepared(bool)));
+  disconnect(core, SIGNAL(destroyed()), this, SLOT(onActiveCoreDestroyed()));
 
-    if (result == TemplateCore::Success) {
-      emit generationFinished(result, output_file);
-    }
-    else {
-      emit generationFinished(result);
-    }
+  // TODO: upravit signaturu metody generationMobileApplication,
+  // aby brala i ten vstupni nazev ciloveho apk souboru.
 
-    qApp->closeLock()->unlock();
+  QString output_file;
+  TemplateCore::GenerationResult result = ok ?
+                                            core->generateMobileApplication(m_inputFileName, output_file) :
+                                            TemplateCore::OtherProblem;
+
+  disconnect(core, SIGNAL(generationProgress(int,QString)), this, SIGNAL(generationProgress(int,QString)));
+
+  m_activeCore = NULL;
+  m_inputFileName.clear();
+
+  if (result == TemplateCore::Success) {
+    emit generationFinished(result, output_file);
   }
   else {
-    qApp->trayIcon()->showMessage(tr("Cannot generate application"),
-                                  tr("Master generation lock is locked, try to\ngenerate application later."),
-                                  QSystemTrayIcon::Warning);
+    emit generationFinished(result);
   }
+
+  qApp->closeLock()->unlock();
+}
+
+void TemplateGenerator::onActiveCoreDestroyed() {
+  if (m_activeCore == NULL) {
+    return;
+  }
+
+  m_activeCore = NULL;
+  m_inputFileName.clear();
+
+  emit generationFinished(TemplateCore::Aborted);
+  qApp->closeLock()->unlock();
 }
 
 void TemplateGenerator::cleanWorkspace() {
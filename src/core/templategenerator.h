@@ -43,6 +43,17 @@ class TemplateGenerator : public QObject {
     /// \param progress Number of percent passed.
     /// \param message Progress message description.
     void generationProgress(int progress, const QString &message);
+
+  private slots:
+    // Generates the application once the core is prepared.
+    void onGenerationPrepared(bool ok);
+
+    // Aborts generating if the core is destroyed while it is prepared.
+    void onActiveCoreDestroyed();
+
+  private:
+    TemplateCore *m_activeCore;
+    QString m_inputFileName;
 };
 
 #endif // TEMPLATEGENERATOR_H
@@ -58,6 +58,44 @@ void TemplateSimulator::launch() {
   emit canGoBackChanged(false);
 }
 
+bool TemplateSimulator::performAction(const QString &action, const QString &argument) {
+  Q_UNUSED(argument)
+
+  if (action == "back") {
+    return goBack();
+  }
+  else if (action == "stop") {
+    return stopSimulation();
+  }
+  else {
+    return false;
+  }
+}
+
+QString TemplateSimulator::simulationState() const {
+  return QString();
+}
+
+void TemplateSimulator::onItemInserted(int index) {
+  Q_UNUSED(index)
+}
+
+void TemplateSimulator::onItemRemoved(int index) {
+  Q_UNUSED(index)
+}
+
+void TemplateSimulator::onItemMoved(int from_index, int to_index) {
+  Q_UNUSED(from_index)
+  Q_UNUSED(to_index)
+}
+
+void TemplateSimulator::onItemModified(int index) {
+  Q_UNUSED(index)
+}
+
+void TemplateSimulator::onMetadataModified() {
+}
+
 TemplateCore *TemplateSimulator::core() const {
   return m_core;
 }
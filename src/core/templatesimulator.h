@@ -59,6 +59,21 @@ class TemplateSimulator : public QWidget {
     /// \see TemplateCore
     TemplateCore *core() const;
 
+    /// \brief Performs single scripted step of the simulation.
+    /// \param action Name of the action, for example "start", "answer" or "next".
+    /// \param argument Optional argument of the action, for example index of the answer.
+    /// \return Returns true if action was performed, false if action is unknown
+    /// or cannot be performed in current state of the simulation.
+    /// \remarks This allows to drive simulation without user interaction.
+    /// Default implementation handles "back" and "stop" actions.
+    /// \see SimulationRunner
+    virtual bool performAction(const QString &action, const QString &argument = QString());
+
+    /// \brief Describes current state of the simulation for scripted runs.
+    /// \return Returns short description of the state, for example
+    /// position of active question or final results.
+    virtual QString simulationState() const;
+
   public slots:
     /// \brief (Re)starts the simulation.
     /// \return Returns true if simulation was (re)started, false otherwise.
@@ -73,6 +88,30 @@ class TemplateSimulator : public QWidget {
     /// \return Returns true if simulation was rolled one step back, false otherwise.
     virtual bool goBack() = 0;
 
+    /// \brief Called when new item is inserted into the editor
+    /// during running simulation.
+    /// \param index Position of newly inserted item.
+    /// \remarks Default implementation does nothing, simulators which are able
+    /// to patch their contents in place should reimplement this and
+    /// following "item" slots.
+    virtual void onItemInserted(int index);
+
+    /// \brief Called when item is removed from the editor.
+    /// \param index Position which item occupied before its removal.
+    virtual void onItemRemoved(int index);
+
+    /// \brief Called when item is moved within the editor.
+    /// \param from_index Original position of item.
+    /// \param to_index New position of item.
+    virtual void onItemMoved(int from_index, int to_index);
+
+    /// \brief Called when contents of item are modified.
+    /// \param index Position of modified item.
+    virtual void onItemModified(int index);
+
+    /// \brief Called when project metadata (name, author) are modified.
+    virtual void onMetadataModified();
+
   signals:
     /// \brief Emitted if "can go back" status of simulator changes.
     /// \param can_go_back True if simulation can be rolled back one step, false otherwise.
@@ -0,0 +1,246 @@
+/*
+  Copyright (c) 2012, BuildmLearn Contributors listed at http://buildmlearn.org/people/
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+
+  * Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+
+  * Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+
+  * Neither the name of the BuildmLearn nor the names of its
+    contributors may be used to endorse or promote products derived from
+    this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "gui/formdiagnostics.h"
+
+#include "miscellaneous/iconfactory.h"
+#include "network-web/networkmetrics.h"
+#include "network-web/networkfactory.h"
+#include "miscellaneous/performancemonitor.h"
+#include "miscellaneous/application.h"
+#include "miscellaneous/settings.h"
+
+#include <QHeaderView>
+#include <QFileDialog>
+#include <QMessageBox>
+#include <QDir>
+
+
+FormDiagnostics::FormDiagnostics(QWidget *parent) : QDialog(parent), m_ui(new Ui::FormDiagnostics) {
+  m_ui->setupUi(this);
+
+  // Set flags and attributes.
+  setWindowFlags(Qt::Dialog | Qt::WindowSystemMenuHint | Qt::WindowTitleHint | Qt::WindowMaximizeButtonHint);
+  setWindowIcon(IconFactory::instance()->fromTheme("application-about"));
+
+  m_btnClear = m_ui->m_buttonBox->addButton(tr("C&lear"), QDialogButtonBox::ActionRole);
+  m_btnClear->setToolTip(tr("Clear all collected data."));
+  m_btnExport = m_ui->m_buttonBox->addButton(tr("&Export..."), QDialogButtonBox::ActionRole);
+  m_btnExport->setToolTip(tr("Export performance data to JSON file."));
+
+  m_ui->m_treeNetwork->setHeaderLabels(QStringList() << tr("Started") << tr("Method") << tr("URL") <<
+                                       tr("Status") << tr("Redirects") << tr("Connection (ms)") <<
+                                       tr("Upload (ms)") << tr("First byte (ms)") << tr("Transfer (ms)") <<
+                                       tr("Total (ms)") << tr("Sent (B)") << tr("Received (B)"));
+  m_ui->m_treeNetwork->header()->setStretchLastSection(false);
+
+  m_ui->m_treePerformance->setHeaderLabels(QStringList() << tr("Operation") << tr("Count") << tr("Total (ms)") <<
+                                           tr("Mean (ms)") << tr("Minimum (ms)") << tr("Maximum (ms)") <<
+                                           tr("Histogram"));
+  m_ui->m_treeSlowest->setHeaderLabels(QStringList() << tr("Operation") << tr("Duration (ms)") << tr("Finished"));
+  m_ui->m_checkPerformance->setChecked(PerformanceMonitor::isEnabled());
+
+  connect(m_btnClear, SIGNAL(clicked()), this, SLOT(clearMetrics()));
+  connect(m_btnExport, SIGNAL(clicked()), this, SLOT(exportPerformanceData()));
+  connect(m_ui->m_checkPerformance, SIGNAL(toggled(bool)), this, SLOT(setPerformanceMonitoring(bool)));
+  connect(m_ui->m_tabDiagnostics, SIGNAL(currentChanged(int)), this, SLOT(loadPerformanceData()));
+  connect(NetworkMetrics::instance(), SIGNAL(recordsChanged()), this, SLOT(loadNetworkMetrics()), Qt::QueuedConnection);
+
+  loadNetworkMetrics();
+  loadPerformanceData();
+}
+
+FormDiagnostics::~FormDiagnostics() {
+  delete m_ui;
+}
+
+void FormDiagnostics::loadNetworkMetrics() {
+  QList<NetworkRequestMetrics> records = NetworkMetrics::instance()->records();
+  QList<qint64> first_byte_times;
+  QList<qint64> total_times;
+  int failed_requests = 0;
+
+  m_ui->m_treeNetwork->setSortingEnabled(false);
+  m_ui->m_treeNetwork->clear();
+
+  foreach (const NetworkRequestMetrics &record, records) {
+    QTreeWidgetItem *item = new QTreeWidgetItem(m_ui->m_treeNetwork);
+
+    item->setText(0, record.m_started.toString("hh:mm:ss.zzz"));
+    item->setText(1, record.m_operation);
+    item->setText(2, record.m_url);
+    item->setToolTip(2, record.m_url);
+    item->setText(3, record.m_error == QNetworkReply::NoError ?
+                    QString::number(record.m_httpStatus) + (record.m_fromCache ? tr(" (cache)") : QString()) :
+                    NetworkFactory::networkErrorText(record.m_error));
+
+    // Numeric columns are sorted by their values.
+    item->setData(4, Qt::DisplayRole, record.m_redirects);
+    item->setData(5, Qt::DisplayRole, record.m_connectionTime);
+    item->setData(6, Qt::DisplayRole, record.m_uploadTime);
+    item->setData(7, Qt::DisplayRole, record.m_firstByteTime);
+    item->setData(8, Qt::DisplayRole, record.m_transferTime);
+    item->setData(9, Qt::DisplayRole, record.m_totalTime);
+    item->setData(10, Qt::DisplayRole, record.m_bytesSent);
+    item->setData(11, Qt::DisplayRole, record.m_bytesReceived);
+
+    if (record.m_error != QNetworkReply::NoError) {
+      failed_requests++;
+    }
+    else if (!record.m_fromCache) {
+      first_byte_times.append(record.m_firstByteTime);
+      total_times.append(record.m_totalTime);
+    }
+  }
+
+  m_ui->m_treeNetwork->setSortingEnabled(true);
+
+  if (total_times.isEmpty()) {
+    m_ui->m_lblNetworkSummary->setText(tr("%n request(s) recorded, %1 failed.", 0, records.size()).arg(failed_requests));
+  }
+  else {
+    qSort(first_byte_times);
+    qSort(total_times);
+
+    // Percentiles help to choose reasonable timeouts.
+    m_ui->m_lblNetworkSummary->setText(tr("%n request(s) recorded, %1 failed. Time to first byte: median %2 ms, "
+                                          "95th percentile %3 ms, maximum %4 ms. Total time: median %5 ms, "
+                                          "95th percentile %6 ms, maximum %7 ms.", 0, records.size()).arg(
+                                         QString::number(failed_requests),
+                                         QString::number(first_byte_times.at(first_byte_times.size() / 2)),
+                                         QString::number(first_byte_times.at((first_byte_times.size() * 95) / 100)),
+                                         QString::number(first_byte_times.last()),
+                                         QString::number(total_times.at(total_times.size() / 2)),
+                                         QString::number(total_times.at((total_times.size() * 95) / 100)),
+                                         QString::number(total_times.last())));
+  }
+}
+
+void FormDiagnostics::loadPerformanceData() {
+  QList<PerformanceMonitor::Statistics> all_statistics = PerformanceMonitor::statistics();
+  QList<qint64> bounds = PerformanceMonitor::histogramBounds();
+  QHash<QString, qint64> counters = PerformanceMonitor::counters();
+  QStringList counter_texts;
+
+  m_ui->m_treePerformance->setSortingEnabled(false);
+  m_ui->m_treePerformance->clear();
+
+  foreach (const PerformanceMonitor::Statistics &statistics, all_statistics) {
+    QTreeWidgetItem *item = new QTreeWidgetItem(m_ui->m_treePerformance);
+    qint64 highest_bucket = 0;
+    QString histogram;
+    QStringList histogram_tooltip;
+
+    item->setText(0, statistics.m_name);
+
+    // Durations are shown in milliseconds rounded to two decimals.
+    item->setData(1, Qt::DisplayRole, statistics.m_count);
+    item->setData(2, Qt::DisplayRole, qRound64(statistics.m_totalTime / 10.0) / 100.0);
+    item->setData(3, Qt::DisplayRole, qRound64(statistics.m_totalTime / (statistics.m_count * 10.0)) / 100.0);
+    item->setData(4, Qt::DisplayRole, qRound64(statistics.m_minimumTime / 10.0) / 100.0);
+    item->setData(5, Qt::DisplayRole, qRound64(statistics.m_maximumTime / 10.0) / 100.0);
+
+    foreach (qint64 bucket, statistics.m_histogram) {
+      highest_bucket = qMax(highest_bucket, bucket);
+    }
+
+    // Each bucket is drawn as one character, taller character means more samples.
+    const QString levels = QString(" .:-=+*#");
+
+    for (int i = 0; i < statistics.m_histogram.size(); i++) {
+      qint64 bucket = statistics.m_histogram.at(i);
+
+      histogram += levels.at(bucket == 0 ? 0 : 1 + (int) ((bucket * (levels.size() - 2)) / highest_bucket));
+      histogram_tooltip << (i < bounds.size() ?
+                              tr("up to %1 ms: %2").arg(QString::number(bounds.at(i) / 1000.0), QString::number(bucket)) :
+                              tr("over %1 ms: %2").arg(QString::number(bounds.last() / 1000.0), QString::number(bucket)));
+    }
+
+    item->setText(6, '[' + histogram + ']');
+    item->setToolTip(6, histogram_tooltip.join("\n"));
+    item->setFont(6, QFont("Monospace"));
+  }
+
+  m_ui->m_treePerformance->setSortingEnabled(true);
+  m_ui->m_treeSlowest->clear();
+
+  foreach (const PerformanceMonitor::Sample &sample, PerformanceMonitor::slowestSamples()) {
+    QTreeWidgetItem *item = new QTreeWidgetItem(m_ui->m_treeSlowest);
+
+    item->setText(0, sample.m_name);
+    item->setData(1, Qt::DisplayRole, qRound64(sample.m_duration / 10.0) / 100.0);
+    item->setText(2, sample.m_finished.toString("hh:mm:ss.zzz"));
+  }
+
+  QStringList counter_names = counters.keys();
+  counter_names.sort();
+
+  foreach (const QString &counter_name, counter_names) {
+    counter_texts << QString("%1 = %2").arg(counter_name, QString::number(counters.value(counter_name)));
+  }
+
+  if (!PerformanceMonitor::isEnabled()) {
+    m_ui->m_lblPerformanceSummary->setText(tr("Performance data are not collected now."));
+  }
+  else if (all_statistics.isEmpty() && counter_texts.isEmpty()) {
+    m_ui->m_lblPerformanceSummary->setText(tr("No operation was measured yet."));
+  }
+  else {
+    m_ui->m_lblPerformanceSummary->setText(tr("%n operation(s) measured. Counters: %1.", 0, all_statistics.size()).arg(
+                                             counter_texts.isEmpty() ? tr("none") : counter_texts.join(", ")));
+  }
+}
+
+void FormDiagnostics::setPerformanceMonitoring(bool enabled) {
+  PerformanceMonitor::setEnabled(enabled);
+  qApp->settings()->setValue(APP_CFG_GEN, "performance_monitoring", enabled);
+
+  loadPerformanceData();
+}
+
+void FormDiagnostics::exportPerformanceData() {
+  QString file_name = QFileDialog::getSaveFileName(this,
+                                                   tr("Export performance data"),
+                                                   QDir::homePath() + QDir::separator() + "buildmlearn-performance.json",
+                                                   tr("JSON files (*.json)"));
+
+  if (!file_name.isEmpty() && !PerformanceMonitor::exportJson(file_name)) {
+    QMessageBox::warning(this,
+                         tr("Cannot export performance data"),
+                         tr("Performance data cannot be written into selected file."));
+  }
+}
+
+void FormDiagnostics::clearMetrics() {
+  NetworkMetrics::instance()->clear();
+  PerformanceMonitor::clear();
+
+  loadPerformanceData();
+}
@@ -0,0 +1,77 @@
+/*
+  Copyright (c) 2012, BuildmLearn Contributors listed at http://buildmlearn.org/people/
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+
+  * Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+
+  * Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+
+  * Neither the name of the BuildmLearn nor the names of its
+    contributors may be used to endorse or promote products derived from
+    this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef FORMDIAGNOSTICS_H
+#define FORMDIAGNOSTICS_H
+
+#include "ui_formdiagnostics.h"
+
+#include <QDialog>
+#include <QPushButton>
+
+
+namespace Ui {
+  class FormDiagnostics;
+}
+
+/// \brief Dialog which shows runtime diagnostics of the application.
+/// \see NetworkMetrics, PerformanceMonitor
+class FormDiagnostics : public QDialog {
+    Q_OBJECT
+
+  public:
+    /// \brief Constructor.
+    /// \param parent Parent widget.
+    explicit FormDiagnostics(QWidget *parent = 0);
+    virtual ~FormDiagnostics();
+
+  private slots:
+    // Reloads list of network requests and their summary.
+    void loadNetworkMetrics();
+
+    // Reloads measured operations and counters.
+    void loadPerformanceData();
+
+    // Turns collecting of performance data on or off.
+    void setPerformanceMonitoring(bool enabled);
+
+    // Exports performance data to JSON file.
+    void exportPerformanceData();
+
+    // Clears all collected data.
+    void clearMetrics();
+
+  private:
+    Ui::FormDiagnostics *m_ui;
+    QPushButton *m_btnClear;
+    QPushButton *m_btnExport;
+};
+
+#endif // FORMDIAGNOSTICS_H
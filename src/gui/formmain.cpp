@@ -40,6 +40,7 @@
 #include "gui/formnewproject.h"
 #include "gui/custommessagebox.h"
 #include "gui/formuploadbundle.h"
+#include "gui/formdiagnostics.h"
 #include "miscellaneous/iconfactory.h"
 #include "core/templatesimulator.h"
 #include "core/templatefactory.h"
@@ -51,6 +52,7 @@
 #include <QStackedWidget>
 #include <QMessageBox>
 #include <QFileDialog>
+#include <QFile>
 #include <QInputDialog>
 #include <QHBoxLayout>
 #include <QVBoxLayout>
@@ -68,7 +70,8 @@ FormMain::FormMain(QWidget *parent)
     m_centralLayout(new QVBoxLayout(m_centralArea)),
     m_firstTimeShow(true),
     m_ui(new Ui::FormMain),
-    m_simulatorWindow(NULL) {
+    m_simulatorWindow(NULL),
+    m_generationRequested(false) {
   m_ui->setupUi(this);
 
   m_normalTitle = APP_LONG_NAME;
@@ -160,6 +163,7 @@ void FormMain::createConnections() {
   connect(m_ui->m_actionCheckForUpdates, SIGNAL(triggered()), this, SLOT(showUpdates()));
   connect(m_ui->m_actionAboutToolkit, SIGNAL(triggered()), this, SLOT(showAbout()));
   connect(m_ui->m_actionSettings, SIGNAL(triggered()), this, SLOT(showSettings()));
+  connect(m_ui->m_actionDiagnostics, SIGNAL(triggered()), this, SLOT(showDiagnostics()));
   connect(m_ui->m_actionHelp, SIGNAL(triggered()), this, SLOT(showHelp()));
 
   // View connections.
@@ -224,6 +228,7 @@ void FormMain::setupIcons() {
   m_ui->m_actionSimulatorStop->setIcon(factory->fromTheme("simulation-stop"));
   m_ui->m_actionSimulatorGoBack->setIcon(factory->fromTheme("simulation-back"));
   m_ui->m_actionOpenOutputDirectory->setIcon(factory->fromTheme("view-output"));
+  m_ui->m_actionDiagnostics->setIcon(factory->fromTheme("application-about"));
 }
 
 void FormMain::setupToolbar() {
@@ -303,10 +308,13 @@ void FormMain::onCanGenerateChanged(bool can_generate, const QString &informativ
   if (can_generate) {
     // Editor of active template can generate applications.
     if (!qApp->externalApplicationChecked()) {
-      qApp->recheckExternalApplications(false);
-    }
+      // Result comes via externalApplicationsRechecked() signal.
+      qApp->recheckExternalApplications();
 
-    if (!qApp->externalApplicationsReady()) {
+      m_ui->m_actionGenerateMobileApplication->setEnabled(false);
+      m_ui->m_actionGenerateMobileApplication->setToolTip(tr("Checking external applications..."));
+    }
+    else if (!qApp->externalApplicationsReady()) {
       m_ui->m_actionGenerateMobileApplication->setEnabled(false);
       m_ui->m_actionGenerateMobileApplication->setToolTip(qApp->externalApplicationsStatus());
     }
@@ -344,6 +352,10 @@ void FormMain::onExternalApplicationsChanged() {
     // but still update generator buttons.
     onCanGenerateChanged(false, QString());
   }
+
+  if (m_generationRequested) {
+    generateRequestedApplication();
+  }
 }
 
 void FormMain::onEditorChanged() {
@@ -523,6 +535,12 @@ void FormMain::showUpdates() {
   delete form_update.data();
 }
 
+void FormMain::showDiagnostics() {
+  QPointer<FormDiagnostics> form_diagnostics = new FormDiagnostics(this);
+  form_diagnostics.data()->exec();
+  delete form_diagnostics.data();
+}
+
 void FormMain::showHelp(bool enable_do_not_show_again_option) {
   QPointer<FormHelp> form_help = new FormHelp(enable_do_not_show_again_option, this);
   form_help.data()->exec();
@@ -631,9 +649,73 @@ void FormMain::openLoadProjectDialog() {
     return;
   }
 
-  if (qApp->templateManager()->loadProject(selected_file)) {
+  openProject(selected_file);
+}
+
+bool FormMain::openProject(const QString &file_name) {
+  if (qApp->templateManager()->loadProject(file_name)) {
     m_ui->m_actionSaveProjectAs->setEnabled(true);
     m_ui->m_actionSaveProject->setEnabled(false);
+    return true;
+  }
+  else {
+    return false;
+  }
+}
+
+void FormMain::openProjectFromArguments(const QStringList &arguments) {
+  foreach (const QString &argument, arguments) {
+    if (argument.endsWith(".buildmlearn", Qt::CaseInsensitive) && QFile::exists(argument)) {
+      if (saveUnsavedProject()) {
+        openProject(argument);
+      }
+
+      return;
+    }
+  }
+}
+
+void FormMain::processInstanceMessage(const QString &command, const QStringList &arguments) {
+  if (command == APP_QUIT_INSTANCE) {
+    m_ui->m_actionQuit->trigger();
+  }
+  else if (command == APP_IS_RUNNING) {
+    display();
+    openProjectFromArguments(arguments);
+  }
+  else if (command == APP_GENERATE_BUNDLE) {
+    QString project_file = arguments.value(arguments.indexOf(APP_ARG_GENERATE) + 1);
+
+    display();
+
+    if (saveUnsavedProject() && openProject(project_file)) {
+      if (qApp->externalApplicationChecked()) {
+        generateRequestedApplication();
+      }
+      else {
+        // Result comes via externalApplicationsRechecked() signal.
+        m_generationRequested = true;
+      }
+    }
+  }
+}
+
+void FormMain::generateRequestedApplication() {
+  TemplateCore *active_core = qApp->templateManager()->activeCore();
+
+  m_generationRequested = false;
+
+  // The same conditions as for enabling of generate action.
+  if (active_core != NULL && !active_core->editor()->canGenerateApplications()) {
+    CustomMessageBox::show(this, QMessageBox::Warning, tr("Cannot generate application"),
+                           active_core->editor()->generationStatusDescription());
+  }
+  else if (active_core != NULL && !qApp->externalApplicationsReady()) {
+    CustomMessageBox::show(this, QMessageBox::Warning, tr("Cannot generate application"),
+                           qApp->externalApplicationsStatus());
+  }
+  else {
+    generateMobileApplication();
   }
 }
 
@@ -86,6 +86,10 @@ class FormMain : public QMainWindow {
     void loadSizeAndPosition();
     void saveSizeAndPosition();
 
+    // Generates application requested by APP_GENERATE_BUNDLE if generating
+    // is possible, otherwise tells user why it is not.
+    void generateRequestedApplication();
+
   private slots:
     // Called when user hits "Quit" button.
     void quit();
@@ -125,6 +129,7 @@ class FormMain : public QMainWindow {
     void showSettings();
     void showAbout();
     void showUpdates();
+    void showDiagnostics();
     void showHelp(bool enable_do_not_show_again_option = false);
     void showUpdatesAfterBubbleClick();
 
@@ -149,6 +154,22 @@ class FormMain : public QMainWindow {
     void openSaveProjectAsDialog();
     void openLoadProjectDialog();
 
+    /// \brief Opens project from file.
+    /// \param file_name Path to project file.
+    /// \return Returns true if project was loaded.
+    bool openProject(const QString &file_name);
+
+    /// \brief Opens first project file given among application arguments.
+    /// \param arguments Arguments of application.
+    void openProjectFromArguments(const QStringList &arguments);
+
+    /// \brief Handles message sent by other launch of the application.
+    /// \param command APP_IS_RUNNING, APP_QUIT_INSTANCE or APP_GENERATE_BUNDLE
+    /// which opens project given after APP_ARG_GENERATE and generates application from it.
+    /// \param arguments Arguments of other launch.
+    /// \see SingleInstance
+    void processInstanceMessage(const QString &command, const QStringList &arguments);
+
     /// \brief Generates mobile APK application from currently active
     /// project.
     void generateMobileApplication();
@@ -196,6 +217,9 @@ class FormMain : public QMainWindow {
     QString m_unsavedTitle;
 
     QString m_generatedApplicationPath;
+
+    // Generation was requested before external applications were checked.
+    bool m_generationRequested;
 };
 
 #endif // FORMMAIN_H
@@ -33,6 +33,7 @@
 #include "core/templateentrypoint.h"
 #include "core/templatefactory.h"
 #include "miscellaneous/iconfactory.h"
+#include "miscellaneous/resourcepack.h"
 
 #include <QShowEvent>
 
@@ -92,9 +93,9 @@ void FormNewProject::templateSelected(int index) {
     TemplateEntryPoint *entry_point = static_cast<TemplateEntryPoint*>(m_ui->m_listTemplates->currentItem()->data(Qt::UserRole).value<void*>());
 
     m_ui->m_lblDescription->setText(entry_point->description());
-    m_ui->m_lblThumbnail->setPixmap(QPixmap(APP_TEMPLATES_PATH + QDir::separator() +
-                                            entry_point->baseFolder() + QDir::separator() +
-                                            entry_point->thumbnailImage()));
+    m_ui->m_lblThumbnail->setPixmap(QPixmap(ResourcePack::filePath(ResourcePack::Templates,
+                                                                   entry_point->baseFolder() + '/' +
+                                                                   entry_point->thumbnailImage())));
   }
 }
 
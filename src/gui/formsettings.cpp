@@ -47,15 +47,19 @@
 #include "core/templatefactory.h"
 
 #include <QProcess>
+#include <QTimer>
 #include <QNetworkProxy>
 #include <QColorDialog>
 #include <QFileDialog>
 
 
 FormSettings::FormSettings(QWidget *parent)
-  : QDialog(parent), m_ui(new Ui::FormSettings) {
+  : QDialog(parent), m_ui(new Ui::FormSettings), m_probeTimer(new QTimer(this)) {
   m_ui->setupUi(this);
 
+  m_probeTimer->setInterval(TOOL_PROBE_DELAY);
+  m_probeTimer->setSingleShot(true);
+
   // Set flags and attributes.
   setWindowFlags(Qt::MSWindowsFixedSizeDialogHint | Qt::Dialog | Qt::WindowSystemMenuHint | Qt::WindowTitleHint);
   setWindowIcon(IconFactory::instance()->fromTheme("application-settings"));
@@ -138,6 +142,8 @@ void FormSettings::createConnections() {
   connect(m_ui->m_btnSelectZip, SIGNAL(clicked()), this, SLOT(selectZip()));
   connect(m_ui->m_btnSelectJava, SIGNAL(clicked()), this, SLOT(selectJava()));
   connect(m_ui->m_btnSelectSignapk, SIGNAL(clicked()), this, SLOT(selectSignApk()));
+  connect(m_probeTimer, SIGNAL(timeout()), this, SLOT(probeExternalUtilities()));
+  connect(qApp->toolProber(), SIGNAL(probed(ToolProber::Tool,QString,int,int)), this, SLOT(onToolProbed(ToolProber::Tool,QString,int)));
   connect(m_ui->m_btnGenerationOutputSelect, SIGNAL(clicked()), this, SLOT(selectOutputDirectory()));
   connect(m_ui->m_btnGenerationTempSelect, SIGNAL(clicked()), this, SLOT(selectTempDirectory()));
   connect(m_ui->m_treeSkins, SIGNAL(currentItemChanged(QTreeWidgetItem*,QTreeWidgetItem*)),
@@ -292,76 +298,128 @@ void FormSettings::saveExternalUtilites() {
   qApp->setZipUtilityPath(m_ui->m_lblExternalZip->label()->text());
   qApp->setJavaInterpreterPath(m_ui->m_lblExternalJava->label()->text());
   qApp->setSignApkUtilityPath(m_ui->m_lblExternalSignapk->label()->text());
-  qApp->recheckExternalApplications(true);
+  qApp->recheckExternalApplications();
 }
 
 void FormSettings::checkZip(const QString &new_path) {
-  int zip_output = qApp->checkZip(new_path);
+  m_ui->m_lblExternalZip->setStatus(WidgetWithStatus::Information,
+                                    new_path,
+                                    tr("Checking ZIP..."));
+  m_probeTimer->start();
+}
+
+void FormSettings::checkJava(const QString &new_path) {
+  m_ui->m_lblExternalJava->setStatus(WidgetWithStatus::Information,
+                                     new_path,
+                                     tr("Checking JAVA..."));
+  m_probeTimer->start();
+}
+
+void FormSettings::checkSignApk(const QString &new_path) {
+  m_ui->m_lblExternalSignapk->setStatus(WidgetWithStatus::Information,
+                                        new_path,
+                                        tr("Checking SIGNAPK..."));
+  m_probeTimer->start();
+}
+
+void FormSettings::probeExternalUtilities() {
+  // Paths may change several times in a row, tools are probed only once after that.
+  qApp->toolProber()->probe(ToolProber::Zip, m_ui->m_lblExternalZip->label()->text());
+  qApp->toolProber()->probe(ToolProber::Java, m_ui->m_lblExternalJava->label()->text());
+  qApp->toolProber()->probe(ToolProber::SignApk, m_ui->m_lblExternalSignapk->label()->text(),
+                            m_ui->m_lblExternalJava->label()->text());
+}
+
+void FormSettings::onToolProbed(ToolProber::Tool tool, const QString &path, int exit_code) {
+  switch (tool) {
+    case ToolProber::Zip:
+      if (path == m_ui->m_lblExternalZip->label()->text()) {
+        displayZipStatus(path, exit_code);
+      }
+
+      break;
+
+    case ToolProber::Java:
+      if (path == m_ui->m_lblExternalJava->label()->text()) {
+        displayJavaStatus(path, exit_code);
+      }
+
+      break;
+
+    case ToolProber::SignApk:
+    default:
+      if (path == m_ui->m_lblExternalSignapk->label()->text()) {
+        displaySignApkStatus(path, exit_code);
+      }
+
+      break;
+  }
+}
+
+void FormSettings::displayZipStatus(const QString &path, int zip_output) {
   QString textual_info = qApp->interpretZip(zip_output);
 
   switch (zip_output) {
     case EXIT_STATUS_NOT_STARTED:
       m_ui->m_lblExternalZip->setStatus(WidgetWithStatus::Error,
-                                        new_path,
+                                        path,
                                         textual_info);
       break;
 
     case EXIT_STATUS_ZIP_NORMAL:
       m_ui->m_lblExternalZip->setStatus(WidgetWithStatus::Ok,
-                                        new_path,
+                                        path,
                                         textual_info);
       break;
 
     case EXIT_STATUS_CRASH:
     default:
       m_ui->m_lblExternalZip->setStatus(WidgetWithStatus::Warning,
-                                        new_path,
+                                        path,
                                         textual_info);
       break;
   }
 }
 
-void FormSettings::checkJava(const QString &new_path) {
-  int java_output = qApp->checkJava(new_path);
+void FormSettings::displayJavaStatus(const QString &path, int java_output) {
   QString textual_info = qApp->interpretJava(java_output);
 
   switch (java_output) {
     case EXIT_STATUS_NOT_STARTED:
       m_ui->m_lblExternalJava->setStatus(WidgetWithStatus::Error,
-                                         new_path,
+                                         path,
                                          textual_info);
       break;
 
     case EXIT_STATUS_JAVA_NORMAL:
       m_ui->m_lblExternalJava->setStatus(WidgetWithStatus::Ok,
-                                         new_path,
+                                         path,
                                          textual_info);
       break;
 
     case EXIT_STATUS_CRASH:
     default:
       m_ui->m_lblExternalJava->setStatus(WidgetWithStatus::Warning,
-                                         new_path,
+                                         path,
                                          textual_info);
       break;
   }
 }
 
-void FormSettings::checkSignApk(const QString &new_path) {
-  int signapk_output = qApp->checkSignApk(new_path, m_ui->m_lblExternalJava->label()->text());
+void FormSettings::displaySignApkStatus(const QString &path, int signapk_output) {
   QString textual_info = qApp->interpretSignApk(signapk_output);
 
   switch (signapk_output) {
     case EXIT_STATUS_SIGNAPK_NOT_FOUND:
     case EXIT_STATUS_NOT_STARTED:
       m_ui->m_lblExternalSignapk->setStatus(WidgetWithStatus::Error,
-                                            new_path,
+                                            path,
                                             textual_info);
       break;
 
     case EXIT_STATUS_SIGNAPK_NORMAL:
       m_ui->m_lblExternalSignapk->setStatus(WidgetWithStatus::Ok,
-                                            new_path,
+                                            path,
                                             textual_info);
       break;
 
@@ -369,7 +427,7 @@ void FormSettings::checkSignApk(const QString &new_path) {
     case EXIT_STATUS_SIGNAPK_WORKING:
     default:
       m_ui->m_lblExternalSignapk->setStatus(WidgetWithStatus::Warning,
-                                            new_path,
+                                            path,
                                             textual_info);
       break;
   }
@@ -33,6 +33,8 @@
 
 #include "ui_formsettings.h"
 
+#include "miscellaneous/toolprober.h"
+
 #include <QDialog>
 
 
@@ -40,6 +42,8 @@ namespace Ui {
   class FormSettings;
 }
 
+class QTimer;
+
 /// \brief Structure holding some initial values.
 struct TemporarySettings {
 
@@ -87,6 +91,10 @@ class FormSettings : public QDialog {
     void checkZip(const QString& new_path);
     void checkSignApk(const QString& new_path);
 
+    // Probes external utilities shown in the dialog.
+    void probeExternalUtilities();
+    void onToolProbed(ToolProber::Tool tool, const QString &path, int exit_code);
+
     void selectJava();
     void selectZip();
     void selectSignApk();
@@ -112,7 +120,13 @@ class FormSettings : public QDialog {
     void onProxyTypeChanged(int index);
 
   private:
+    // Displays results of probes of external utilities.
+    void displayZipStatus(const QString &path, int zip_output);
+    void displayJavaStatus(const QString &path, int java_output);
+    void displaySignApkStatus(const QString &path, int signapk_output);
+
     Ui::FormSettings *m_ui;
+    QTimer *m_probeTimer;
     TemporarySettings m_initialSettings;
     QStringList m_changedDataTexts;
 };
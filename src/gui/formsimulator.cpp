@@ -8,6 +8,7 @@
 #include "core/templatesimulator.h"
 #include "core/templatecore.h"
 #include "core/templateeditor.h"
+#include "miscellaneous/performancemonitor.h"
 
 #include <QWidget>
 #include <QCloseEvent>
@@ -87,6 +88,8 @@ void FormSimulator::goBack() {
 }
 
 void FormSimulator::startSimulation() {
+  PERF_SCOPE("simulation.start");
+
   if (m_activeSimulation != NULL) {
     if (m_activeSimulation->startSimulation()) {
       emit stopEnableChanged(true);
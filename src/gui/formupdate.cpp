@@ -34,7 +34,7 @@
 #include "miscellaneous/systemfactory.h"
 #include "miscellaneous/iconfactory.h"
 #include "network-web/webfactory.h"
-#include "network-web/downloader.h"
+#include "network-web/filedownloader.h"
 #include "network-web/networkfactory.h"
 #include "gui/custommessagebox.h"
 #include "gui/systemtrayicon.h"
@@ -70,6 +70,12 @@ bool FormUpdate::isUpdateForThisSystem() const {
   return m_updateInfo.m_urls.keys().contains(OS_ID);
 }
 
+bool FormUpdate::isDirectDownloadAvailable() const {
+  // Only packages with published checksum are downloaded directly,
+  // other links lead to web pages rather than to files.
+  return !m_updateInfo.m_urls.value(OS_ID).m_checksum.isEmpty();
+}
+
 bool FormUpdate::isSelfUpdateSupported() const {
   // DO NOT allow self-updating for now.
 #if defined(Q_OS_WIN) || defined(Q_OS_OS2)
@@ -80,8 +86,16 @@ bool FormUpdate::isSelfUpdateSupported() const {
 }
 
 void FormUpdate::checkForUpdates() {
-  UpdateCheck update = qApp->checkForUpdates();
+  m_ui->m_lblStatus->setStatus(WidgetWithStatus::Information,
+                               tr("Checking for updates..."),
+                               tr("List with updates is being downloaded."));
+  m_btnUpdate->setEnabled(false);
+
+  connect(qApp, SIGNAL(updatesChecked(UpdateCheck)), this, SLOT(updatesChecked(UpdateCheck)), Qt::UniqueConnection);
+  qApp->checkForUpdates();
+}
 
+void FormUpdate::updatesChecked(const UpdateCheck &update) {
   m_updateInfo = update.first;
 
   if (update.second != QNetworkReply::NoError) {
@@ -109,7 +123,7 @@ void FormUpdate::checkForUpdates() {
                                 tr("Installation file is not available directly.\n"
                                    "Go to application website to obtain it manually."));
 
-      if (isUpdateForThisSystem() /* && isSelfUpdateSupported() */ ) {
+      if (isUpdateForThisSystem() && isDirectDownloadAvailable()) {
         m_btnUpdate->setText(tr("Download update"));
       }
     }
@@ -124,19 +138,26 @@ void FormUpdate::checkForUpdates() {
 }
 
 void FormUpdate::updateProgress(qint64 bytes_received, qint64 bytes_total) {
-  qApp->processEvents();
-  m_ui->m_lblStatus->setStatus(WidgetWithStatus::Information,
-                               tr("Downloaded %1% (update size is %2 kB).").arg(QString::number((bytes_received * 100.0) / bytes_total,
-                                                                                                'f',
-                                                                                                2),
-                                                                                QString::number(bytes_total / 1000,
-                                                                                                'f',
-                                                                                                2)),
-                               tr("Downloading update..."));
+  if (bytes_total > 0) {
+    m_ui->m_lblStatus->setStatus(WidgetWithStatus::Information,
+                                 tr("Downloaded %1% (update size is %2 kB).").arg(QString::number((bytes_received * 100.0) / bytes_total,
+                                                                                                  'f',
+                                                                                                  2),
+                                                                                  QString::number(bytes_total / 1000.0,
+                                                                                                  'f',
+                                                                                                  2)),
+                                 tr("Downloading update..."));
+  }
+  else {
+    m_ui->m_lblStatus->setStatus(WidgetWithStatus::Information,
+                                 tr("Downloaded %1 kB.").arg(QString::number(bytes_received / 1000.0, 'f', 2)),
+                                 tr("Downloading update..."));
+  }
 }
 
-void FormUpdate::saveUpdateFile(const QByteArray &file_contents) {
-  QString url_file = m_updateInfo.m_urls.value(OS_ID).m_fileUrl;;
+QString FormUpdate::updateTargetFile() const {
+  QString url_file = QUrl(m_updateInfo.m_urls.value(OS_ID).m_fileUrl).path();
+  QString output_file_name = url_file.mid(url_file.lastIndexOf('/') + 1);
 
 #if QT_VERSION >= 0x050000
   QString temp_directory = QStandardPaths::writableLocation(QStandardPaths::TempLocation);
@@ -144,40 +165,24 @@ void FormUpdate::saveUpdateFile(const QByteArray &file_contents) {
   QString temp_directory = QDesktopServices::storageLocation(QDesktopServices::TempLocation);
 #endif
 
-  if (!temp_directory.isEmpty()) {
-    QString output_file_name = url_file.mid(url_file.lastIndexOf('/') + 1);
-    QFile output_file(temp_directory + QDir::separator() + output_file_name);
-
-    if (output_file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
-      qDebug("Storing update file to temporary location '%s'.",
-             qPrintable(output_file.fileName()));
-
-      output_file.write(file_contents);
-      output_file.flush();
-      output_file.close();
-
-      qDebug("Update file contents was successfuly saved.");
-
-      m_updateFilePath = output_file.fileName();
-      m_readyToInstall = true;
-    }
-    else {
-      qDebug("Cannot save downloaded update file because target temporary file '%s' cannot be "
-             "opened for writing.", qPrintable(output_file_name));
-    }
+  if (temp_directory.isEmpty() || output_file_name.isEmpty()) {
+    qDebug("Cannot determine target file for update, no TEMP folder or file name is available.");
+    return QString();
   }
   else {
-    qDebug("Cannot save downloaded update file because no TEMP folder is available.");
+    // Name of the file does not change between sessions, so interrupted download can be resumed.
+    return QDir::toNativeSeparators(temp_directory + QDir::separator() + output_file_name);
   }
 }
 
-void FormUpdate::updateCompleted(QNetworkReply::NetworkError status, QByteArray contents) {
+void FormUpdate::updateCompleted(QNetworkReply::NetworkError status, const QString &file_path) {
   qDebug("Download of application update file was completed with code '%d'.",
          status);
 
   switch (status) {
     case QNetworkReply::NoError:
-      saveUpdateFile(contents);
+      m_updateFilePath = file_path;
+      m_readyToInstall = true;
 
       m_ui->m_lblStatus->setStatus(WidgetWithStatus::Ok,
                                    tr("Downloaded successfully, stored in file '%1'.").arg(m_updateFilePath),
@@ -186,19 +191,67 @@ void FormUpdate::updateCompleted(QNetworkReply::NetworkError status, QByteArray
       m_btnUpdate->setEnabled(true);
       break;
 
+    case QNetworkReply::UnknownContentError:
+      m_ui->m_lblStatus->setStatus(WidgetWithStatus::Error,
+                                   tr("Package is corrupted."),
+                                   tr("Downloaded package could not be verified\nor stored, download it again."));
+      m_btnUpdate->setText(tr("Download update"));
+      m_btnUpdate->setEnabled(true);
+      break;
+
     default:
       m_ui->m_lblStatus->setStatus(WidgetWithStatus::Error,
-                                   tr("Error occured."),
-                                   tr("Error occured during downloading of the package."));
-      m_btnUpdate->setText(tr("Error occured"));
+                                   tr("Error: '%1'.").arg(NetworkFactory::networkErrorText(status)),
+                                   tr("Error occured during downloading of the package.\n"
+                                      "Already downloaded data are kept."));
+      m_btnUpdate->setText(tr("Resume download"));
+      m_btnUpdate->setEnabled(true);
       break;
   }
 }
 
 void FormUpdate::startUpdate() {
+  if (m_readyToInstall) {
+    if (!QDesktopServices::openUrl(QUrl::fromLocalFile(m_updateFilePath))) {
+      CustomMessageBox::show(this,
+                             QMessageBox::Warning,
+                             tr("Cannot open update file"),
+                             tr("Update file '%1' cannot be opened, open it manually.").arg(m_updateFilePath));
+    }
+
+    return;
+  }
+
   QString url_file;
   bool update_for_this_system = isUpdateForThisSystem();
 
+  if (update_for_this_system && isDirectDownloadAvailable()) {
+    QString target_file = updateTargetFile();
+
+    if (!target_file.isEmpty()) {
+      if (m_downloader == NULL) {
+        m_downloader = new FileDownloader(this);
+
+        connect(m_downloader, SIGNAL(progress(qint64,qint64)), this, SLOT(updateProgress(qint64,qint64)));
+        connect(m_downloader, SIGNAL(completed(QNetworkReply::NetworkError,QString)),
+                this, SLOT(updateCompleted(QNetworkReply::NetworkError,QString)));
+      }
+
+      m_downloader->setTimeout(UPDATE_DOWNLOAD_TIMEOUT);
+      m_downloader->setSegments(qApp->settings()->value(APP_CFG_GEN, "update_download_segments",
+                                                        UPDATE_DOWNLOAD_SEGMENTS).toInt());
+
+      m_btnUpdate->setEnabled(false);
+      m_ui->m_lblStatus->setStatus(WidgetWithStatus::Information,
+                                   tr("Starting download..."),
+                                   tr("Downloading update..."));
+
+      m_downloader->download(m_updateInfo.m_urls.value(OS_ID).m_fileUrl, target_file,
+                             m_updateInfo.m_urls.value(OS_ID).m_checksum);
+      return;
+    }
+  }
+
   if (update_for_this_system) {
     url_file = m_updateInfo.m_urls.value(OS_ID).m_fileUrl;
   }
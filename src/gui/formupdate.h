@@ -34,6 +34,7 @@
 #include "ui_formupdate.h"
 
 #include "miscellaneous/systemfactory.h"
+#include "miscellaneous/application.h"
 
 #include <QDialog>
 #include <QPushButton>
@@ -44,7 +45,7 @@ namespace Ui {
   class FormUpdate;
 }
 
-class Downloader;
+class FileDownloader;
 
 /// \brief Dialog for showing update details.
 /// \see UpdateInfo, UpdateUrl, SystemFactory::checkForUpdates()
@@ -61,6 +62,11 @@ class FormUpdate : public QDialog {
     /// installation file for current platform.
     bool isUpdateForThisSystem() const;
 
+    /// \brief Indication of directly downloadable installation file.
+    /// \return Returns true if installation file for current platform
+    /// can be downloaded and verified by application itself.
+    bool isDirectDownloadAvailable() const;
+
     /// \brief Indication of presence of self-update feature.
     /// \return Returns true if application can self-update
     /// on current platform.
@@ -68,17 +74,26 @@ class FormUpdate : public QDialog {
     bool isSelfUpdateSupported() const;
 
   protected slots:
-    /// \brief Check for updates and interprets the results.
+    /// \brief Starts check for updates.
     void checkForUpdates();
 
+    /// \brief Interprets the results of check for updates.
+    void updatesChecked(const UpdateCheck &update);
+
+    /// \brief Downloads installation file or opens it if it is already downloaded.
+    /// \remarks If file cannot be downloaded directly, download page is opened
+    /// in external browser.
     void startUpdate();
 
     void updateProgress(qint64 bytes_received, qint64 bytes_total);
-    void updateCompleted(QNetworkReply::NetworkError status, QByteArray contents);
-    void saveUpdateFile(const QByteArray &file_contents);
+    void updateCompleted(QNetworkReply::NetworkError status, const QString &file_path);
+
+  private:
+    // Returns path in which installation file is stored.
+    QString updateTargetFile() const;
 
   private:
-    Downloader *m_downloader;
+    FileDownloader *m_downloader;
     bool m_readyToInstall;
     QString m_updateFilePath;
     Ui::FormUpdate *m_ui;
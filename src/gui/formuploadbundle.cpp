@@ -34,6 +34,8 @@
 #include "miscellaneous/application.h"
 #include "miscellaneous/iconfactory.h"
 #include "network-web/downloader.h"
+#include "network-web/bundleuploader.h"
+#include "network-web/uploadqueue.h"
 #include "network-web/networkfactory.h"
 #include "core/templatefactory.h"
 #include "core/templatecore.h"
@@ -41,11 +43,13 @@
 #include "definitions/definitions.h"
 
 #include <QPushButton>
+#include <QBuffer>
 #include "QFileDialog"
 
 
 FormUploadBundle::FormUploadBundle(QWidget *parent)
-  : QDialog(parent), m_ui(new Ui::FormUploadBundle), m_uploader(NULL), m_uploadStatus(StoreFactory::OtherError) {
+  : QDialog(parent), m_ui(new Ui::FormUploadBundle), m_uploader(NULL),
+    m_bundleData(QString()), m_uploadStatus(StoreFactory::OtherError) {
   m_ui->setupUi(this);
 
   setWindowFlags(Qt::MSWindowsFixedSizeDialogHint | Qt::Dialog | Qt::WindowSystemMenuHint | Qt::WindowTitleHint);
@@ -55,6 +59,9 @@ FormUploadBundle::FormUploadBundle(QWidget *parent)
   m_btnClose = m_ui->m_buttonBox->button(QDialogButtonBox::Close);
   m_btnUpload = m_ui->m_buttonBox->addButton(tr("&Upload application"),
                                              QDialogButtonBox::ActionRole);
+  m_btnQueue = m_ui->m_buttonBox->addButton(tr("Upload in &background"),
+                                            QDialogButtonBox::ActionRole);
+  m_btnQueue->setToolTip(tr("Add application to upload queue, it is uploaded on background even after restart."));
 
   m_ui->m_txtApplicationName->lineEdit()->setPlaceholderText(tr("Name of your application"));
   m_ui->m_txtAuthorEmail->lineEdit()->setPlaceholderText(tr("Your e-mail"));
@@ -77,8 +84,26 @@ FormUploadBundle::FormUploadBundle(QWidget *parent)
   connect(m_ui->m_txtAuthorName->lineEdit(), SIGNAL(textChanged(QString)), this, SLOT(checkAuthorName(QString)));
   connect(this, SIGNAL(metadataChanged()), this, SLOT(checkMetadata()));
   connect(m_btnUpload, SIGNAL(clicked()), this, SLOT(startUpload()));
+  connect(m_btnQueue, SIGNAL(clicked()), this, SLOT(queueUpload()));
   connect(m_ui->m_btnSelectIcon, SIGNAL(clicked()), this, SLOT(selectApplicationIcon()));
 
+  // Setup upload queue view.
+  m_ui->m_treeQueue->setColumnCount(2);
+  m_ui->m_treeQueue->setHeaderHidden(false);
+  m_ui->m_treeQueue->setHeaderLabels(QStringList()
+                                     << /*: Application column of upload queue. */ tr("Application")
+                                     << /*: State column of upload queue. */ tr("State"));
+
+  connect(m_ui->m_treeQueue, SIGNAL(itemSelectionChanged()), this, SLOT(queueSelectionChanged()));
+  connect(m_ui->m_btnRemoveQueued, SIGNAL(clicked()), this, SLOT(removeQueuedItem()));
+  connect(UploadQueue::instance(), SIGNAL(itemStateChanged(QString,UploadQueue::ItemState,StoreFactory::UploadStatus)),
+          this, SLOT(queueItemStateChanged(QString,UploadQueue::ItemState,StoreFactory::UploadStatus)));
+  connect(UploadQueue::instance(), SIGNAL(itemProgress(QString,qint64,qint64)),
+          this, SLOT(queueItemProgress(QString,qint64,qint64)));
+  connect(UploadQueue::instance(), SIGNAL(itemRemoved(QString)), this, SLOT(queueItemRemoved(QString)));
+
+  loadQueueItems();
+
   setTabOrder(m_ui->m_txtApplicationName->lineEdit(), m_ui->m_txtApplicationDescription);
   setTabOrder(m_ui->m_txtApplicationDescription, m_ui->m_txtAuthorName->lineEdit());
   setTabOrder(m_ui->m_txtAuthorName->lineEdit(), m_ui->m_txtAuthorEmail->lineEdit());
@@ -137,6 +162,7 @@ void FormUploadBundle::checkMetadata() {
                           m_ui->m_txtAuthorEmail->status() == WidgetWithStatus::Ok &&
                           m_ui->m_txtAuthorName->status() == WidgetWithStatus::Ok &&
                           m_ui->m_lblIcon->status() == WidgetWithStatus::Ok);
+  m_btnQueue->setEnabled(m_btnUpload->isEnabled());
 
   if (m_btnUpload->isEnabled()) {
     m_ui->m_lblProgress->setStatus(WidgetWithStatus::Ok,
@@ -187,9 +213,11 @@ void FormUploadBundle::startUpload() {
   }
 
   if (m_uploader == NULL) {
-    m_uploader = new Downloader(this);
+    m_uploader = new BundleUploader(this);
 
     connect(m_uploader, SIGNAL(progress(qint64,qint64)), this, SLOT(uploadProgress(qint64,qint64)));
+    connect(m_uploader, SIGNAL(statusChanged(StoreFactory::UploadStatus,qint64,qint64)),
+            this, SLOT(uploadStatusChanged(StoreFactory::UploadStatus,qint64,qint64)));
     connect(m_uploader, SIGNAL(completed(QNetworkReply::NetworkError,QByteArray)), this,
             SLOT(uploadCompleted(QNetworkReply::NetworkError,QByteArray)));
   }
@@ -197,37 +225,172 @@ void FormUploadBundle::startUpload() {
   // Finally, start file upload.
   m_btnClose->setEnabled(false);
   m_btnUpload->setEnabled(false);
+  m_btnQueue->setEnabled(false);
+
+  // Obtain real endpoint, upload continues once it is known.
+  m_bundleData = xml_bundle_data;
+
+  Downloader *endpoint_downloader = NetworkFactory::downloadFileAsync(StoreFactory::endpointDiscoveryUrl());
+
+  // Endpoint changes rarely, do not ask for it before each upload.
+  endpoint_downloader->setCacheTimeToLive(qApp->settings()->value(APP_CFG_GEN, "endpoint_cache_ttl",
+                                                                  ENDPOINT_CACHE_TTL).toInt());
+
+  // Pending download is aborted if this dialog gets destroyed.
+  endpoint_downloader->setParent(this);
+
+  connect(endpoint_downloader, SIGNAL(completed(QNetworkReply::NetworkError,QByteArray)),
+          this, SLOT(endpointObtained(QNetworkReply::NetworkError,QByteArray)));
+
+  m_ui->m_lblProgress->setStatus(WidgetWithStatus::Information,
+                                 tr("Obtaining store endpoint..."),
+                                 tr("Obtaining store endpoint..."));
+}
+
+void FormUploadBundle::queueUpload() {
+  QString xml_bundle_data = qApp->templateManager()->activeCore()->editor()->generateBundleData();
+
+  if (xml_bundle_data.isEmpty()) {
+    m_ui->m_lblProgress->setStatus(WidgetWithStatus::Error,
+                                   tr("Cannot upload application."),
+                                   tr("Application cannot be uploaded because template return error.\nContact application developers to fix this issue."));
+    return;
+  }
 
-  // Obtain real endpoint.
+  QString id = UploadQueue::instance()->enqueue(xml_bundle_data,
+                                                m_ui->m_txtAuthorName->lineEdit()->text(),
+                                                m_ui->m_txtAuthorEmail->lineEdit()->text(),
+                                                m_ui->m_txtApplicationName->lineEdit()->text(),
+                                                m_ui->m_lblIcon->label()->toolTip());
 
-  QByteArray endpoint;
-  QNetworkReply::NetworkError endpoint_status = NetworkFactory::downloadFile(STORE_ENDPOINT, 5000,
-                                                                             endpoint);
+  if (id.isEmpty()) {
+    m_ui->m_lblProgress->setStatus(WidgetWithStatus::Error,
+                                   tr("Cannot add application to upload queue."),
+                                   tr("Application cannot be stored into upload queue."));
+  }
+  else {
+    // Item itself is added to the view when the queue announces it.
+    m_ui->m_lblProgress->setStatus(WidgetWithStatus::Ok,
+                                   tr("Application added to upload queue."),
+                                   tr("Application is uploaded on background."));
+  }
+}
+
+void FormUploadBundle::loadQueueItems() {
+  m_ui->m_treeQueue->clear();
 
-  if (endpoint_status != QNetworkReply::NoError) {
+  foreach (const UploadQueue::Item &item, UploadQueue::instance()->items()) {
+    queueItemStateChanged(item.m_id, item.m_state, item.m_status);
+  }
+
+  queueSelectionChanged();
+}
+
+void FormUploadBundle::queueItemStateChanged(const QString &id, UploadQueue::ItemState state,
+                                             StoreFactory::UploadStatus status) {
+  QTreeWidgetItem *view_item = queueViewItem(id);
+
+  if (view_item == NULL) {
+    foreach (const UploadQueue::Item &item, UploadQueue::instance()->items()) {
+      if (item.m_id == id) {
+        view_item = new QTreeWidgetItem(m_ui->m_treeQueue);
+        view_item->setText(0, item.m_applicationName);
+        view_item->setData(0, Qt::UserRole, id);
+        break;
+      }
+    }
+
+    if (view_item == NULL) {
+      return;
+    }
+  }
+
+  view_item->setText(1, UploadQueue::itemStateToString(state));
+  view_item->setToolTip(1, state == UploadQueue::Failed || state == UploadQueue::Waiting ?
+                             StoreFactory::uploadStatusToString(status) :
+                             QString());
+}
+
+void FormUploadBundle::queueItemProgress(const QString &id, qint64 bytes_sent, qint64 bytes_total) {
+  QTreeWidgetItem *view_item = queueViewItem(id);
+
+  if (view_item != NULL && bytes_total > 0) {
+    view_item->setText(1, QString("%1 (%2 %)").arg(UploadQueue::itemStateToString(UploadQueue::Uploading),
+                                                   QString::number(bytes_sent * 100 / bytes_total)));
+  }
+}
+
+void FormUploadBundle::queueItemRemoved(const QString &id) {
+  delete queueViewItem(id);
+}
+
+void FormUploadBundle::queueSelectionChanged() {
+  m_ui->m_btnRemoveQueued->setEnabled(m_ui->m_treeQueue->currentItem() != NULL);
+}
+
+void FormUploadBundle::removeQueuedItem() {
+  QTreeWidgetItem *view_item = m_ui->m_treeQueue->currentItem();
+
+  if (view_item != NULL) {
+    // View item is deleted when the queue announces the removal.
+    UploadQueue::instance()->removeItem(view_item->data(0, Qt::UserRole).toString());
+  }
+}
+
+QTreeWidgetItem *FormUploadBundle::queueViewItem(const QString &id) const {
+  for (int i = 0; i < m_ui->m_treeQueue->topLevelItemCount(); i++) {
+    QTreeWidgetItem *view_item = m_ui->m_treeQueue->topLevelItem(i);
+
+    if (view_item->data(0, Qt::UserRole).toString() == id) {
+      return view_item;
+    }
+  }
+
+  return NULL;
+}
+
+void FormUploadBundle::endpointObtained(QNetworkReply::NetworkError error, const QByteArray &endpoint) {
+  if (error != QNetworkReply::NoError) {
     // Endpoint was not obtained.
     m_btnClose->setEnabled(true);
     m_btnUpload->setEnabled(true);
+    m_btnQueue->setEnabled(true);
     m_ui->m_lblProgress->setStatus(WidgetWithStatus::Error,
                                    tr("Endpoint was not obtained."),
-                                   tr("Endpoint was not obtained."));
+                                   tr("Endpoint was not obtained: %1.").arg(NetworkFactory::networkErrorText(error)));
 
     return;
   }
 
-  m_uploader->uploadBundleFile(QString(endpoint), xml_bundle_data, STORE_API_KEY,
-                               m_ui->m_txtAuthorName->lineEdit()->text(),
-                               m_ui->m_txtAuthorEmail->lineEdit()->text(),
-                               m_ui->m_txtApplicationName->lineEdit()->text(),
-                               m_ui->m_lblIcon->label()->toolTip());
+  // Bundle is streamed from the buffer, only single encoded copy of it is kept.
+  QBuffer *bundle_data = new QBuffer();
+
+  bundle_data->setData(m_bundleData.toUtf8());
+  bundle_data->open(QIODevice::ReadOnly);
+  m_bundleData.clear();
+
+  m_uploader->upload(QString(endpoint), bundle_data, STORE_API_KEY,
+                     m_ui->m_txtAuthorName->lineEdit()->text(),
+                     m_ui->m_txtAuthorEmail->lineEdit()->text(),
+                     m_ui->m_txtApplicationName->lineEdit()->text(),
+                     m_ui->m_lblIcon->label()->toolTip());
   m_ui->m_lblProgress->setStatus(WidgetWithStatus::Information,
                                  tr("Uploading application..."),
                                  tr("Uploading application..."));
 }
 
 void FormUploadBundle::uploadProgress(qint64 bytes_sent, qint64 bytes_total) {
-  m_ui->m_progressUpload->setValue(bytes_sent * 100.0 / bytes_total);
-  qApp->processEvents();
+  if (bytes_total > 0) {
+    m_ui->m_progressUpload->setValue(bytes_sent * 100.0 / bytes_total);
+  }
+}
+
+void FormUploadBundle::uploadStatusChanged(StoreFactory::UploadStatus status, qint64 bytes_confirmed, qint64 bytes_total) {
+  m_uploadStatus = status;
+  m_ui->m_lblProgress->setStatus(WidgetWithStatus::Information,
+                                 tr("Uploading application..."),
+                                 tr("Store confirmed %1 of %2 kB.").arg(QString::number(bytes_confirmed / 1024),
+                                                                        QString::number(bytes_total / 1024)));
 }
 
 void FormUploadBundle::uploadCompleted(QNetworkReply::NetworkError error, QByteArray output) {
@@ -247,6 +410,7 @@ void FormUploadBundle::uploadCompleted(QNetworkReply::NetworkError error, QByteA
 
   m_btnClose->setEnabled(true);
   m_btnUpload->setEnabled(true);
+  m_btnQueue->setEnabled(true);
 }
 
 StoreFactory::UploadStatus FormUploadBundle::uploadStatus() const {
@@ -35,6 +35,7 @@
 
 #include "ui_formuploadbundle.h"
 #include "miscellaneous/storefactory.h"
+#include "network-web/uploadqueue.h"
 
 #include <QNetworkReply>
 
@@ -43,10 +44,10 @@ namespace Ui {
   class FormUploadBundle;
 }
 
-class Downloader;
+class BundleUploader;
 
 /// \brief Form for uploading applications to BuildmLearn Store.
-/// \see Downloader, StoreFactory
+/// \see BundleUploader, StoreFactory
 class FormUploadBundle : public QDialog {
     Q_OBJECT
 
@@ -66,18 +67,34 @@ class FormUploadBundle : public QDialog {
     void checkApplicationIcon(const QString &icon_path);
 
     void startUpload();
+    void queueUpload();
+    void endpointObtained(QNetworkReply::NetworkError error, const QByteArray &endpoint);
 
     void uploadProgress(qint64 bytes_sent, qint64 bytes_total);
+    void uploadStatusChanged(StoreFactory::UploadStatus status, qint64 bytes_confirmed, qint64 bytes_total);
     void uploadCompleted(QNetworkReply::NetworkError error, QByteArray output);
 
+    // Upload queue view.
+    void loadQueueItems();
+    void queueItemStateChanged(const QString &id, UploadQueue::ItemState state, StoreFactory::UploadStatus status);
+    void queueItemProgress(const QString &id, qint64 bytes_sent, qint64 bytes_total);
+    void queueItemRemoved(const QString &id);
+    void queueSelectionChanged();
+    void removeQueuedItem();
+
   signals:
     void metadataChanged();
 
   private:
+    // Returns view item of queued item with given identifier.
+    QTreeWidgetItem *queueViewItem(const QString &id) const;
+
     Ui::FormUploadBundle *m_ui;
     QPushButton *m_btnUpload;
+    QPushButton *m_btnQueue;
     QPushButton *m_btnClose;
-    Downloader *m_uploader;
+    BundleUploader *m_uploader;
+    QString m_bundleData;
 
     StoreFactory::UploadStatus m_uploadStatus;
 };
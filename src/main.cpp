@@ -37,13 +37,23 @@
 #include "miscellaneous/iconfactory.h"
 #include "miscellaneous/skinfactory.h"
 #include "miscellaneous/localization.h"
+#include "miscellaneous/startupprofiler.h"
+#include "miscellaneous/resourcepack.h"
+#include "miscellaneous/singleinstance.h"
+#include "miscellaneous/logger.h"
+#include "miscellaneous/performancemonitor.h"
 #include "dynamic-shortcuts/dynamicshortcuts.h"
+#include "core/simulationrunner.h"
+#include "network-web/uploadqueue.h"
+#include "network-web/storebenchmark.h"
 
 
 #include <QThread>
 #include <QTranslator>
 #include <QDebug>
 #include <QTimer>
+#include <QFileInfo>
+#include <QDir>
 
 
 /// \mainpage Welcome to documentation!
@@ -155,6 +165,9 @@
 /// \return Function returns EXIT_SUCCESS when it succeedes
 /// or another integer value when it fails.
 int main(int argc, char *argv[]) {
+  // Measure startup phases up to the first paint of main window.
+  StartupProfiler::start();
+
   //: Name of language, e.g. English.
   QObject::tr("LANG_NAME");
   //: Abbreviation of language.
@@ -178,18 +191,72 @@ int main(int argc, char *argv[]) {
   qInstallMsgHandler(Debugging::debugHandler);
 #endif
 
+  // Scripted simulations run headless, no main form is created then.
+  bool headless_simulation = false;
+  bool startup_benchmark = StartupProfiler::exitsAfterStartup(argc, argv);
+
+  for (int i = 1; i < argc; i++) {
+    if (qstrcmp(argv[i], APP_ARG_SIMULATE) == 0 || qstrcmp(argv[i], APP_ARG_STARTUP_BENCHMARK) == 0 ||
+        qstrcmp(argv[i], APP_ARG_STORE_BENCHMARK) == 0) {
+      headless_simulation = true;
+    }
+  }
+
+#if QT_VERSION >= 0x050000
+  if ((headless_simulation || startup_benchmark) && qgetenv("QT_QPA_PLATFORM").isEmpty()) {
+    qputenv("QT_QPA_PLATFORM", "offscreen");
+  }
+#endif
+
   Application application(argc, argv);
+  StartupProfiler::mark("application");
+
+  // From now on, messages are written by background thread.
+  Logger::start();
+  Logger::setLevel(static_cast<Logger::Level>(application.settings()->value(APP_CFG_GEN, "log_level",
+                                                                            Logger::Debug).toInt()));
+
+  PerformanceMonitor::setEnabled(application.settings()->value(APP_CFG_GEN, "performance_monitoring", false).toBool());
+
+  if (application.settings()->value(APP_CFG_GEN, "log_to_file", false).toBool()) {
+    Logger::setLogFile(QFileInfo(application.settings()->fileName()).absolutePath() + QDir::separator() + LOG_FILE_PATH);
+  }
+
+  // Hand arguments over to already running instance if there is one.
+  SingleInstance single_instance;
+  QStringList arguments = Application::arguments().mid(1);
+  bool single_instance_mode = !headless_simulation && !startup_benchmark && !arguments.contains(APP_ARG_NEW_INSTANCE);
+
+  if (single_instance_mode) {
+    if (arguments.contains(APP_ARG_QUIT)) {
+      return single_instance.sendMessage(APP_QUIT_INSTANCE, arguments) ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+    else if (single_instance.sendMessage(arguments.contains(APP_ARG_GENERATE) ? APP_GENERATE_BUNDLE : APP_IS_RUNNING,
+                                         arguments)) {
+      return EXIT_SUCCESS;
+    }
+
+    single_instance.listen();
+    StartupProfiler::mark("single instance");
+  }
+
+  // Register optional pack of icons, skins and thumbnails before they are used.
+  ResourcePack::load();
+  StartupProfiler::mark("resource pack");
 
   // Add an extra path for non-system icon themes and set current icon theme
   // and skin.
   IconFactory::instance()->setupSearchPaths();
   IconFactory::instance()->loadCurrentIconTheme();
+  StartupProfiler::mark("icon theme");
 
   // Load current skin.
   application.skinFactory()->loadCurrentSkin();
+  StartupProfiler::mark("skin");
 
   // Load localization and setup locale before any widget is constructed.
   Localization::instance()->load();
+  StartupProfiler::mark("localization");
 
   // These settings needs to be set before any QSettings object.
   Application::setApplicationName(APP_NAME);
@@ -198,19 +265,53 @@ int main(int argc, char *argv[]) {
   Application::setOrganizationDomain(APP_URL);
   Application::setWindowIcon(QIcon(APP_ICON_PATH));
 
+  if (headless_simulation) {
+    if (Application::arguments().contains(APP_ARG_STARTUP_BENCHMARK)) {
+      return StartupProfiler::runBenchmark(Application::arguments());
+    }
+    else if (Application::arguments().contains(APP_ARG_STORE_BENCHMARK)) {
+      return StoreBenchmark::execute(Application::arguments());
+    }
+    else {
+      return SimulationRunner::execute(Application::arguments());
+    }
+  }
+
   qDebug().nospace() << "Creating main application form in thread: \'" <<
                         QThread::currentThreadId() << "\'.";
 
   FormMain main_form;
 
   application.setMainForm(&main_form);
+  StartupProfiler::mark("main form");
+
+  QObject::connect(&single_instance, SIGNAL(messageReceived(QString,QStringList)),
+                   &main_form, SLOT(processInstanceMessage(QString,QStringList)));
 
   // Load keyboard shortcuts.
   DynamicShortcuts::load(application.availableActions());
+  StartupProfiler::mark("shortcuts");
 
+  StartupProfiler::finishOnFirstPaint(&main_form);
   main_form.show();
+  StartupProfiler::mark("show");
 
-  if (SystemTrayIcon::isSystemTrayAvailable()) {
+  // Open project given on command line, possibly generate application from it.
+  if (arguments.contains(APP_ARG_GENERATE)) {
+    // Generation is started from event loop, so that it does not block
+    // the rest of startup with its dialogs.
+    QMetaObject::invokeMethod(&main_form, "processInstanceMessage", Qt::QueuedConnection,
+                              Q_ARG(QString, APP_GENERATE_BUNDLE), Q_ARG(QStringList, arguments));
+  }
+  else {
+    main_form.openProjectFromArguments(arguments);
+  }
+
+  if (startup_benchmark) {
+    // Measured launch does not need tray icon and should not touch network.
+    qDebug("Measuring startup only.");
+  }
+  else if (SystemTrayIcon::isSystemTrayAvailable()) {
     QObject::connect(application.trayIcon(), SIGNAL(leftMouseClicked()),
                      &main_form, SLOT(switchVisibility()));
     application.trayIcon()->setContextMenu(main_form.trayMenu());
@@ -224,8 +325,23 @@ int main(int argc, char *argv[]) {
     return EXIT_FAILURE;
   }
 
+  StartupProfiler::mark("tray icon");
+
   // Check for availability of external generators.
-  application.recheckExternalApplications(true);
+  application.recheckExternalApplications();
+  StartupProfiler::mark("external applications check");
+
+  // Continue with uploads queued in previous sessions.
+  QObject::connect(UploadQueue::instance(),
+                   SIGNAL(itemStateChanged(QString,UploadQueue::ItemState,StoreFactory::UploadStatus)),
+                   &application,
+                   SLOT(handleQueuedUploadState(QString,UploadQueue::ItemState,StoreFactory::UploadStatus)));
+
+  if (!startup_benchmark) {
+    UploadQueue::instance()->start();
+  }
+
+  StartupProfiler::mark("upload queue");
 
   return Application::exec();
 }
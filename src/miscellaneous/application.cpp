@@ -33,42 +33,70 @@
 #include "miscellaneous/systemfactory.h"
 #include "miscellaneous/skinfactory.h"
 #include "network-web/networkfactory.h"
+#include "network-web/downloader.h"
+#include "network-web/networkmetrics.h"
+#include "network-web/basenetworkaccessmanager.h"
 #include "gui/systemtrayicon.h"
 #include "gui/formmain.h"
 #include "core/templatefactory.h"
 
 #include <QMutex>
-#include <QFuture>
-#include <QFutureWatcher>
-
-#if QT_VERSION >= 0x050000
-#include <QtConcurrent/QtConcurrentRun>
-#else
-#include <QtConcurrentRun>
-#endif
 
 
 Application::Application(int &argc, char **argv)
   : QApplication(argc, argv),
     m_externalApplicationChecked(false),
+    m_externalApplicationsResults(QHash<int, int>()),
+    m_externalApplicationsGeneration(0),
+    m_externalApplicationsReady(false),
+    m_externalApplicationsStatus(QString()),
     m_closeLock(new QMutex()),
     m_availableActions(QList<QAction*>()),
     m_settings(NULL),
     m_skinFactory(NULL),
+    m_toolProber(NULL),
     m_trayIcon(NULL),
     m_templateManager(NULL),
+    m_updatesDownloader(NULL),
     m_closing(false) {
   connect(this, SIGNAL(aboutToQuit()), this, SLOT(onAboutToQuit()));
   connect(this, SIGNAL(commitDataRequest(QSessionManager&)), this, SLOT(onCommitData(QSessionManager&)));
   connect(this, SIGNAL(saveStateRequest(QSessionManager&)), this, SLOT(onSaveState(QSessionManager&)));
+
+  // Requests can be created in worker threads, so metrics must
+  // be created right away in the main thread.
+  NetworkMetrics::instance();
 }
 
 Application::~Application() {
   delete m_closeLock;
 }
 
-UpdateCheck Application::checkForUpdates() {
-  return SystemFactory::checkForUpdates();
+void Application::checkForUpdates() {
+  if (m_updatesDownloader != NULL) {
+    qDebug("Check for updates is already running.");
+    return;
+  }
+
+  m_updatesDownloader = SystemFactory::checkForUpdates();
+
+  connect(m_updatesDownloader, SIGNAL(completed(QNetworkReply::NetworkError,QByteArray)),
+          this, SLOT(onUpdatesDownloaded(QNetworkReply::NetworkError,QByteArray)));
+}
+
+void Application::onUpdatesDownloaded(QNetworkReply::NetworkError status, const QByteArray &contents) {
+  UpdateCheck updates;
+
+  // Downloader deletes itself.
+  m_updatesDownloader = NULL;
+
+  updates.second = status;
+
+  if (status == QNetworkReply::NoError) {
+    updates.first = SystemFactory::parseUpdatesFile(contents);
+  }
+
+  emit updatesChecked(updates);
 }
 
 SkinFactory *Application::skinFactory() {
@@ -87,63 +115,46 @@ void Application::setSignApkUtilityPath(const QString& signapk_path) {
   settings()->value(APP_CFG_GEN, "signapk_path", signapk_path);
 }
 
-int Application::checkJava(const QString &new_path) {
-  QString java_path = new_path.isEmpty() ? javaInterpreterPath() : new_path;
+ToolProber *Application::toolProber() {
+  if (m_toolProber == NULL) {
+    m_toolProber = new ToolProber(this);
 
-  if (java_path.isEmpty()) {
-    return EXIT_STATUS_NOT_STARTED;
+    connect(m_toolProber, SIGNAL(probed(ToolProber::Tool,QString,int,int)), this, SLOT(onToolProbed(ToolProber::Tool,QString,int,int)));
   }
-  else {
-    QProcess process;
 
-    process.setReadChannelMode(QProcess::MergedChannels);
-    process.start(QDir::toNativeSeparators(java_path), QStringList() << "-version");
-    process.waitForFinished(-1);
-
-    return process.exitCode();
-  }
+  return m_toolProber;
 }
 
-int Application::checkSignApk(const QString &new_path, const QString &java_path) {
-  QString real_java_path = java_path.isEmpty() ? javaInterpreterPath() : java_path;
-  QString signapk_path = new_path.isEmpty() ? signApkUtlityPath() : new_path;
+void Application::recheckExternalApplications() {
+  m_externalApplicationsResults.clear();
+  m_externalApplicationsGeneration++;
 
-  if (signapk_path.isEmpty()) {
-    return EXIT_STATUS_NOT_STARTED;
-  }
-  else {
-    QProcess process;
-
-    process.setReadChannelMode(QProcess::MergedChannels);
-    process.start(QDir::toNativeSeparators(real_java_path),
-                  QStringList() << "-jar" << QDir::toNativeSeparators(signapk_path));
-    process.waitForFinished(-1);
-
-    return process.exitCode();
-  }
+  // All tools are probed concurrently.
+  toolProber()->probe(ToolProber::Java, javaInterpreterPath(), QString(), m_externalApplicationsGeneration);
+  toolProber()->probe(ToolProber::Zip, zipUtilityPath(), QString(), m_externalApplicationsGeneration);
+  toolProber()->probe(ToolProber::SignApk, signApkUtlityPath(), javaInterpreterPath(), m_externalApplicationsGeneration);
 }
 
-int Application::checkZip(const QString &new_path) {
-  QString zip_path = new_path.isEmpty() ? zipUtilityPath() : new_path;
+void Application::onToolProbed(ToolProber::Tool tool, const QString &path, int exit_code, int generation) {
+  Q_UNUSED(path)
 
-  if (zip_path.isEmpty()) {
-    return EXIT_STATUS_NOT_STARTED;
+  if (generation != m_externalApplicationsGeneration) {
+    // Result belongs to some path tried in settings or to previous
+    // round of probes, paths may have changed since then.
+    return;
   }
-  else {
-    QProcess process;
 
-    process.setReadChannelMode(QProcess::MergedChannels);
-    process.start(QDir::toNativeSeparators(zip_path), QStringList() << "--version");
-    process.waitForFinished(-1);
+  m_externalApplicationsResults.insert(tool, exit_code);
 
-    return process.exitCode();
+  if (m_externalApplicationsResults.size() < 3) {
+    return;
   }
-}
 
-void Application::recheckExternalApplications(bool emit_signals) {
-  int java_ready = checkJava();
-  int zip_ready = checkZip();
-  int signapk_ready = checkSignApk();
+  int java_ready = m_externalApplicationsResults.value(ToolProber::Java);
+  int zip_ready = m_externalApplicationsResults.value(ToolProber::Zip);
+  int signapk_ready = m_externalApplicationsResults.value(ToolProber::SignApk);
+
+  m_externalApplicationsResults.clear();
 
   if (signapk_ready != EXIT_STATUS_SIGNAPK_NORMAL ||
       java_ready != EXIT_STATUS_JAVA_NORMAL ||
@@ -171,8 +182,16 @@ void Application::recheckExternalApplications(bool emit_signals) {
 
   m_externalApplicationChecked = true;
 
-  if (emit_signals) {
-    emit externalApplicationsRechecked();
+  emit externalApplicationsRechecked();
+}
+
+void Application::onSettingsValueChanged(const QString &section, const QString &key, const QVariant &value) {
+  Q_UNUSED(key)
+  Q_UNUSED(value)
+
+  if (section == APP_CFG_PROXY) {
+    // Network access managers pick up new proxy on their next request.
+    BaseNetworkAccessManager::reloadProxySettings();
   }
 }
 
@@ -260,9 +279,9 @@ TemplateFactory *Application::templateManager() {
   return m_templateManager;
 }
 
-void Application::handleBackgroundUpdatesCheck() {
-  QFutureWatcher<UpdateCheck> *future_watcher = static_cast<QFutureWatcher<UpdateCheck>*>(sender());
-  UpdateCheck updates = future_watcher->result();
+void Application::handleBackgroundUpdatesCheck(const UpdateCheck &updates) {
+  // Only single result is announced.
+  disconnect(this, SIGNAL(updatesChecked(UpdateCheck)), this, SLOT(handleBackgroundUpdatesCheck(UpdateCheck)));
 
   switch (updates.second) {
     case QNetworkReply::NoError:
@@ -297,6 +316,34 @@ void Application::handleBackgroundUpdatesCheck() {
   }
 }
 
+void Application::handleQueuedUploadState(const QString &id, UploadQueue::ItemState state,
+                                          StoreFactory::UploadStatus status) {
+  if (!SystemTrayIcon::isSystemTrayAvailable() || (state != UploadQueue::Finished && state != UploadQueue::Failed)) {
+    return;
+  }
+
+  QString application_name;
+
+  foreach (const UploadQueue::Item &item, UploadQueue::instance()->items()) {
+    if (item.m_id == id) {
+      application_name = item.m_applicationName;
+      break;
+    }
+  }
+
+  if (state == UploadQueue::Finished) {
+    trayIcon()->showMessage(tr("Application uploaded"),
+                            tr("Application '%1' was uploaded to the store.").arg(application_name),
+                            QSystemTrayIcon::Information);
+  }
+  else {
+    trayIcon()->showMessage(tr("Application not uploaded"),
+                            tr("Application '%1' was not uploaded: %2").arg(application_name,
+                                                                            StoreFactory::uploadStatusToString(status)),
+                            QSystemTrayIcon::Warning);
+  }
+}
+
 bool Application::isClosing() const {
   return m_closing;
 }
@@ -322,10 +369,9 @@ void Application::checkForUpdatesOnBackground() {
   else {
     qDebug("Checking for updates after application has started.");
 
-    QFutureWatcher<UpdateCheck> *watcher_for_future = new QFutureWatcher<UpdateCheck>(this);
-
-    connect(watcher_for_future, SIGNAL(finished()), this, SLOT(handleBackgroundUpdatesCheck()));
-    watcher_for_future->setFuture(QtConcurrent::run(this, &Application::checkForUpdates));
+    connect(this, SIGNAL(updatesChecked(UpdateCheck)), this, SLOT(handleBackgroundUpdatesCheck(UpdateCheck)),
+            Qt::UniqueConnection);
+    checkForUpdates();
   }
 }
 
@@ -37,6 +37,8 @@
 #include "miscellaneous/settings.h"
 #include "miscellaneous/systemfactory.h"
 #include "gui/systemtrayicon.h"
+#include "miscellaneous/toolprober.h"
+#include "network-web/uploadqueue.h"
 
 #include <QNetworkReply>
 #include <QSessionManager>
@@ -52,6 +54,7 @@
 typedef QPair<UpdateInfo, QNetworkReply::NetworkError> UpdateCheck;
 
 class TemplateFactory;
+class Downloader;
 class FormMain;
 class SkinFactory;
 class QAction;
@@ -70,16 +73,14 @@ class Application : public QApplication {
     explicit Application(int &argc, char **argv);
     virtual ~Application();
 
-    /// \brief Tries to download list with new updates.
-    /// \return Returns pair of information: metadata of update and
-    /// network status of update.
-    UpdateCheck checkForUpdates();
-
     /// \brief Access to application-wide settings.
     /// \return
     inline Settings *settings() {
       if (m_settings == NULL) {
         m_settings = Settings::setupSettings(this);
+
+        connect(m_settings, SIGNAL(valueChanged(QString,QString,QVariant)),
+                this, SLOT(onSettingsValueChanged(QString,QString,QVariant)));
       }
 
       return m_settings;
@@ -133,23 +134,14 @@ class Application : public QApplication {
       settings()->setValue(APP_CFG_GEN, "java_path", java_path);
     }
 
-    /// \brief Tests if binary in new_path is correct JAVA executable.
-    /// \param new_path Path to JAVA executable.
-    /// \return Returns specific return code of JAVA executable.
-    int checkJava(const QString &new_path = QString());
-
-    /// \brief Tests if binary in new_path is correct SIGNAPK executable.
-    /// \param new_path Path to SIGNAPK executable.
-    /// \param java_path Path to JAVA executable.
-    /// \return Returns specific return code of SIGNAPK executable.
-    int checkSignApk(const QString &new_path = QString(), const QString &java_path = QString());
-
-    /// \brief Tests if binary in new_path is correct ZIP executable.
-    /// \param new_path Path to ZIP executable.
-    /// \return Returns specific return code of ZIP executable.
-    int checkZip(const QString &new_path = QString());
+    /// \brief Access to asynchronous checker of external tools.
+    /// \return Returns pointer to tool prober.
+    ToolProber *toolProber();
 
-    void recheckExternalApplications(bool emit_signals);
+    /// \brief Starts asynchronous check of all external applications.
+    /// \remarks Result is announced via externalApplicationsRechecked() signal,
+    /// unchanged executables are not run again.
+    void recheckExternalApplications();
 
     QString interpretJava(int return_code);
     QString interpretZip(int return_code);
@@ -196,9 +188,14 @@ class Application : public QApplication {
     bool isClosing() const;
 
   public slots:
+    /// \brief Starts asynchronous download of list with new updates.
+    /// \remarks Result is announced via updatesChecked() signal. Nothing
+    /// happens if check for updates is already running.
+    void checkForUpdates();
+
     /// \brief Schedules check for updates.
     ///
-    /// Check for updates is executed in separate thread. Result is announced
+    /// Check for updates runs asynchronously. Result is announced
     /// via tray icon balloon tip. If tray icon is not available, then
     /// result is not announced and is suppressed.
     void checkForUpdatesOnBackground();
@@ -207,24 +204,38 @@ class Application : public QApplication {
     void onAboutToQuit();
     void onCommitData(QSessionManager &manager);
     void onSaveState(QSessionManager &manager);
-    void handleBackgroundUpdatesCheck();
+    void onUpdatesDownloaded(QNetworkReply::NetworkError status, const QByteArray &contents);
+    void handleBackgroundUpdatesCheck(const UpdateCheck &updates);
+    void handleQueuedUploadState(const QString &id, UploadQueue::ItemState state, StoreFactory::UploadStatus status);
+    void onToolProbed(ToolProber::Tool tool, const QString &path, int exit_code, int generation);
+    void onSettingsValueChanged(const QString &section, const QString &key, const QVariant &value);
 
   signals:
+    /// \brief Emitted when check for updates finishes.
+    /// \param updates Metadata of update and network status of update.
+    void updatesChecked(const UpdateCheck &updates);
+
     /// \brief Emitted if external applications are rechecked which happens
     /// usually if path to some of external application changes.
     void externalApplicationsRechecked();
 
   private:
     bool m_externalApplicationChecked;
+    QHash<int, int> m_externalApplicationsResults;
+
+    // Round of probes whose results are collected, results of older rounds are ignored.
+    int m_externalApplicationsGeneration;
     bool m_externalApplicationsReady;
     QString m_externalApplicationsStatus;
     QMutex *m_closeLock;
     QList<QAction*> m_availableActions;
     Settings *m_settings;
     SkinFactory *m_skinFactory;
+    ToolProber *m_toolProber;
     SystemTrayIcon *m_trayIcon;
     FormMain *m_mainForm;
     TemplateFactory *m_templateManager;
+    Downloader *m_updatesDownloader;
     bool m_closing;
 };
 
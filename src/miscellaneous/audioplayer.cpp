@@ -0,0 +1,251 @@
+/*
+  Copyright (c) 2012, BuildmLearn Contributors listed at http://buildmlearn.org/people/
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+
+  * Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+
+  * Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+
+  * Neither the name of the BuildmLearn nor the names of its
+    contributors may be used to endorse or promote products derived from
+    this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "miscellaneous/audioplayer.h"
+
+#include "definitions/definitions.h"
+#include "miscellaneous/application.h"
+#include "miscellaneous/settings.h"
+#include "network-web/ttsservice.h"
+
+#include <QFile>
+#include <QBuffer>
+
+#if !defined(Q_OS_OS2)
+#if QT_VERSION >= 0x050000
+#include <QSound>
+#include <QAudioOutput>
+#include <QAudioDeviceInfo>
+#include <QtEndian>
+#else
+#include <MediaObject>
+#include <AudioOutput>
+#endif
+#endif
+
+
+QPointer<AudioPlayer> AudioPlayer::s_instance;
+
+AudioPlayer::AudioPlayer(QObject *parent)
+  : QObject(parent), m_clips(QHash<QString, AudioClip>()), m_recentClips(QStringList()),
+    m_cacheSize(0), m_buffer(new QBuffer(this)) {
+#if QT_VERSION >= 0x050000
+  m_output = NULL;
+#elif !defined(Q_OS_OS2)
+  // Output path is created only once and reused for all clips.
+  m_mediaObject = new Phonon::MediaObject(this);
+  m_audioOutput = new Phonon::AudioOutput(Phonon::MusicCategory, this);
+  m_audioOutput->setVolume(100.0f);
+  m_audioOutput->setMuted(false);
+
+  Phonon::createPath(m_mediaObject, m_audioOutput);
+#endif
+
+  // Synthesized audio files are rewritten when synthesized again.
+  connect(TtsService::instance(), SIGNAL(audioFileReplaced(QString)), this, SLOT(invalidateClip(QString)));
+}
+
+AudioPlayer::~AudioPlayer() {
+  qDebug("Destroying AudioPlayer instance.");
+}
+
+qint64 AudioPlayer::cacheSizeLimit() const {
+  // Size is stored in megabytes.
+  return qApp->settings()->value(APP_CFG_GEN, "audio_cache_size", AUDIO_CACHE_SIZE).toLongLong() * 1024 * 1024;
+}
+
+AudioPlayer *AudioPlayer::instance() {
+  if (s_instance.isNull()) {
+    s_instance = new AudioPlayer(qApp);
+  }
+
+  return s_instance;
+}
+
+void AudioPlayer::play(const QString &file_path) {
+#if QT_VERSION >= 0x050000
+  if (!loadClip(file_path)) {
+    // Clip cannot be decoded or played by the output, let
+    // the system decode it.
+    QSound::play(file_path);
+    return;
+  }
+
+  const AudioClip &clip = m_clips[file_path];
+
+  if (m_output == NULL || m_output->format() != clip.m_format) {
+    delete m_output;
+    m_output = new QAudioOutput(clip.m_format, this);
+  }
+
+  m_output->stop();
+  m_buffer->close();
+  m_buffer->setData(clip.m_data);
+  m_buffer->open(QIODevice::ReadOnly);
+  m_output->start(m_buffer);
+#elif !defined(Q_OS_OS2)
+  if (!loadClip(file_path)) {
+    return;
+  }
+
+  m_mediaObject->stop();
+  m_buffer->close();
+  m_buffer->setData(m_clips[file_path].m_data);
+  m_buffer->open(QIODevice::ReadOnly);
+  m_mediaObject->setCurrentSource(Phonon::MediaSource(m_buffer));
+  m_mediaObject->play();
+#else
+  Q_UNUSED(file_path)
+#endif
+}
+
+void AudioPlayer::stop() {
+#if QT_VERSION >= 0x050000
+  if (m_output != NULL) {
+    m_output->stop();
+  }
+#elif !defined(Q_OS_OS2)
+  m_mediaObject->stop();
+#endif
+
+  m_buffer->close();
+}
+
+void AudioPlayer::clearCache() {
+  m_clips.clear();
+  m_recentClips.clear();
+  m_cacheSize = 0;
+}
+
+void AudioPlayer::invalidateClip(const QString &file_path) {
+  if (m_clips.contains(file_path)) {
+    m_cacheSize -= m_clips.take(file_path).m_data.size();
+    m_recentClips.removeOne(file_path);
+  }
+}
+
+bool AudioPlayer::loadClip(const QString &file_path) {
+  if (m_clips.contains(file_path)) {
+    m_recentClips.removeOne(file_path);
+    m_recentClips.prepend(file_path);
+    return m_clips[file_path].m_valid;
+  }
+
+  QFile file(file_path);
+
+  if (!file.open(QIODevice::ReadOnly)) {
+    qWarning("Audio file '%s' cannot be opened for reading.", qPrintable(file_path));
+    return false;
+  }
+
+  AudioClip clip;
+
+  clip.m_valid = true;
+
+#if QT_VERSION >= 0x050000
+  if (!decodeWave(file.readAll(), clip)) {
+    qWarning("Audio file '%s' is not supported PCM WAVE file.", qPrintable(file_path));
+
+    clip.m_valid = false;
+    clip.m_data.clear();
+  }
+#else
+  // Phonon decodes the clip itself, raw data are kept in memory.
+  clip.m_data = file.readAll();
+#endif
+
+  file.close();
+
+  m_clips.insert(file_path, clip);
+  m_recentClips.prepend(file_path);
+  m_cacheSize += clip.m_data.size();
+
+  pruneCache();
+  return clip.m_valid;
+}
+
+#if QT_VERSION >= 0x050000
+bool AudioPlayer::decodeWave(const QByteArray &raw_data, AudioClip &clip) {
+  if (raw_data.size() < 12 || !raw_data.startsWith("RIFF") || raw_data.mid(8, 4) != "WAVE") {
+    return false;
+  }
+
+  const uchar *data = reinterpret_cast<const uchar*>(raw_data.constData());
+  qint64 position = 12;
+  bool has_format = false;
+
+  while (position + 8 <= raw_data.size()) {
+    QByteArray chunk_id = raw_data.mid(position, 4);
+    quint32 chunk_size = qFromLittleEndian<quint32>(data + position + 4);
+
+    position += 8;
+
+    if (chunk_id == "fmt " && chunk_size >= 16 && position + 16 <= raw_data.size()) {
+      if (qFromLittleEndian<quint16>(data + position) != 1) {
+        // Only uncompressed PCM is supported.
+        return false;
+      }
+
+      int sample_size = qFromLittleEndian<quint16>(data + position + 14);
+
+      clip.m_format.setChannelCount(qFromLittleEndian<quint16>(data + position + 2));
+      clip.m_format.setSampleRate(qFromLittleEndian<quint32>(data + position + 4));
+      clip.m_format.setSampleSize(sample_size);
+      clip.m_format.setSampleType(sample_size == 8 ? QAudioFormat::UnSignedInt : QAudioFormat::SignedInt);
+      clip.m_format.setByteOrder(QAudioFormat::LittleEndian);
+      clip.m_format.setCodec("audio/pcm");
+      has_format = true;
+    }
+    else if (chunk_id == "data" && has_format) {
+      // Streaming synthesizers do not always fill in size of data,
+      // take the rest of the file then.
+      bool unknown_size = chunk_size == 0 || position + (qint64) chunk_size > raw_data.size();
+
+      clip.m_data = raw_data.mid(position, unknown_size ? -1 : (int) chunk_size);
+
+      return !clip.m_data.isEmpty() && QAudioDeviceInfo::defaultOutputDevice().isFormatSupported(clip.m_format);
+    }
+
+    // Chunks are aligned to even size.
+    position += chunk_size + (chunk_size & 1);
+  }
+
+  return false;
+}
+#endif
+
+void AudioPlayer::pruneCache() {
+  qint64 limit = cacheSizeLimit();
+
+  // Most recently used clip is kept even if it exceeds the limit.
+  while (m_cacheSize > limit && m_recentClips.size() > 1) {
+    m_cacheSize -= m_clips.take(m_recentClips.takeLast()).m_data.size();
+  }
+}
@@ -0,0 +1,132 @@
+/*
+  Copyright (c) 2012, BuildmLearn Contributors listed at http://buildmlearn.org/people/
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+
+  * Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+
+  * Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+
+  * Neither the name of the BuildmLearn nor the names of its
+    contributors may be used to endorse or promote products derived from
+    this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef AUDIOPLAYER_H
+#define AUDIOPLAYER_H
+
+#include <QObject>
+
+#include <QPointer>
+#include <QHash>
+#include <QStringList>
+
+#if QT_VERSION >= 0x050000
+#include <QAudioFormat>
+#endif
+
+
+class QBuffer;
+class QAudioOutput;
+
+namespace Phonon {
+  class MediaObject;
+  class AudioOutput;
+}
+
+/// \brief Low-latency playback of short audio clips.
+///
+/// Clips are read from disk and decoded only once, decoded PCM data are kept
+/// in memory cache with least-recently-used eviction. Clips are played
+/// through single persistent audio output, so that replaying of
+/// cached clip does not touch the disk at all.
+/// \see IOFactory::playWaveFile()
+class AudioPlayer : public QObject {
+    Q_OBJECT
+
+  public:
+    // Destructor.
+    virtual ~AudioPlayer();
+
+    /// \brief Access to maximal size of clip cache in bytes.
+    qint64 cacheSizeLimit() const;
+
+    // Singleton getter.
+    static AudioPlayer *instance();
+
+  public slots:
+    /// \brief Plays given WAVE file, currently playing clip is stopped.
+    /// \param file_path Path to WAVE file.
+    void play(const QString &file_path);
+
+    /// \brief Stops playback.
+    void stop();
+
+    /// \brief Removes all clips from memory cache.
+    void clearCache();
+
+    /// \brief Removes single clip from memory cache.
+    /// \param file_path Path to WAVE file which was replaced.
+    /// \remarks Cached clips are not checked against their files when
+    /// replayed, so this must be called when the file is rewritten.
+    void invalidateClip(const QString &file_path);
+
+  private:
+    /// \brief Single decoded audio clip.
+    struct AudioClip {
+      // False if the file cannot be decoded, such clips
+      // are cached too so that they are not decoded again.
+      bool m_valid;
+      QByteArray m_data;
+#if QT_VERSION >= 0x050000
+      QAudioFormat m_format;
+#endif
+    };
+
+    // Constructor.
+    explicit AudioPlayer(QObject *parent = 0);
+
+    // Loads clip into cache, returns true if clip is available.
+    bool loadClip(const QString &file_path);
+
+#if QT_VERSION >= 0x050000
+    // Decodes PCM WAVE data, returns false if data are not supported.
+    static bool decodeWave(const QByteArray &raw_data, AudioClip &clip);
+#endif
+
+    // Evicts least recently used clips until cache fits its limit.
+    void pruneCache();
+
+    QHash<QString, AudioClip> m_clips;
+    QStringList m_recentClips;
+    qint64 m_cacheSize;
+    QBuffer *m_buffer;
+
+#if QT_VERSION >= 0x050000
+    QAudioOutput *m_output;
+#elif !defined(Q_OS_OS2)
+    Phonon::MediaObject *m_mediaObject;
+    Phonon::AudioOutput *m_audioOutput;
+#endif
+
+    // Singleton.
+    static QPointer<AudioPlayer> s_instance;
+};
+
+#endif // AUDIOPLAYER_H
@@ -32,54 +32,35 @@
 
 #include "definitions/definitions.h"
 #include "miscellaneous/application.h"
+#include "miscellaneous/logger.h"
 
-#include <QDir>
-
-#include <cstdio>
 #include <cstdlib>
 
-#ifndef QT_NO_DEBUG_OUTPUT
-#if QT_VERSION >= 0x050000
-#define DEBUG_OUTPUT_WORKER(type_string, file, line, message) \
-  fprintf(stderr, "[%s] %s (%s:%d): %s\n", \
-  APP_LOW_NAME, \
-  type_string, \
-  file, \
-  line, \
-  qPrintable(message));
-#else
-#define DEBUG_OUTPUT_WORKER(type_string, message) \
-  fprintf(stderr, "[%s] %s: %s\n", \
-  APP_LOW_NAME, \
-  type_string, \
-  message);
-#endif
-#endif
 
+static Logger::Level logLevel(QtMsgType type) {
+  switch (type) {
+    case QtWarningMsg:
+      return Logger::Warning;
+    case QtCriticalMsg:
+      return Logger::Critical;
+    case QtFatalMsg:
+      return Logger::Fatal;
+    default:
+      return Logger::Debug;
+  }
+}
 
 #if QT_VERSION >= 0x050000
 void Debugging::debugHandler(QtMsgType type,
                              const QMessageLogContext &placement,
                              const QString &message) {
 #ifndef QT_NO_DEBUG_OUTPUT
-  const char *file = qPrintable(QString(placement.file).section(QDir::separator(),
-                                                                -1));
+  // Filtering by level is done by logger.
+  Logger::log(logLevel(type), message, Logger::Fields(), placement.file, placement.line);
 
-  switch (type) {
-    case QtDebugMsg:
-      DEBUG_OUTPUT_WORKER("INFO", file, placement.line, message);
-      break;
-    case QtWarningMsg:
-      DEBUG_OUTPUT_WORKER("WARNING", file, placement.line, message);
-      break;
-    case QtCriticalMsg:
-      DEBUG_OUTPUT_WORKER("CRITICAL", file, placement.line, message);
-      break;
-    case QtFatalMsg:
-      DEBUG_OUTPUT_WORKER("FATAL", file, placement.line, message);
-      qApp->exit(EXIT_FAILURE);
-    default:
-      break;
+  if (type == QtFatalMsg) {
+    Logger::flush();
+    qApp->exit(EXIT_FAILURE);
   }
 #else
   Q_UNUSED(type)
@@ -89,22 +70,12 @@ void Debugging::debugHandler(QtMsgType type,
 }
 #else
 void Debugging::debugHandler(QtMsgType type, const char *message) {
-  #ifndef QT_NO_DEBUG_OUTPUT
-  switch (type) {
-    case QtDebugMsg:
-      DEBUG_OUTPUT_WORKER("INFO", message);
-      break;
-    case QtWarningMsg:
-      DEBUG_OUTPUT_WORKER("WARNING", message);
-      break;
-    case QtCriticalMsg:
-      DEBUG_OUTPUT_WORKER("CRITICAL", message);
-      break;
-    case QtFatalMsg:
-      DEBUG_OUTPUT_WORKER("FATAL", message);
-      qApp->exit(EXIT_FAILURE);
-    default:
-      break;
+#ifndef QT_NO_DEBUG_OUTPUT
+  Logger::log(logLevel(type), QString::fromLocal8Bit(message));
+
+  if (type == QtFatalMsg) {
+    Logger::flush();
+    qApp->exit(EXIT_FAILURE);
   }
 #else
   Q_UNUSED(type)
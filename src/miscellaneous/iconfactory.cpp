@@ -32,6 +32,7 @@
 
 #include "miscellaneous/application.h"
 #include "miscellaneous/settings.h"
+#include "miscellaneous/performancemonitor.h"
 
 #include <QBuffer>
 
@@ -54,7 +55,14 @@ IconFactory *IconFactory::instance() {
 }
 
 void IconFactory::setupSearchPaths() {
-  QIcon::setThemeSearchPaths(QStringList() << APP_THEME_PATH);
+  QStringList search_paths = QStringList() << APP_THEME_PATH;
+
+  if (ResourcePack::isLoaded()) {
+    // Icon themes from resource pack.
+    search_paths << ResourcePack::packRoot(ResourcePack::Icons);
+  }
+
+  QIcon::setThemeSearchPaths(search_paths);
   qDebug("Available icon theme paths: %s.",
          qPrintable(QIcon::themeSearchPaths().replaceInStrings(QRegExp("^|$"),
                                                                "\'").join(", ")));
@@ -67,6 +75,8 @@ void IconFactory::setCurrentIconTheme(const QString &theme_name) {
 }
 
 void IconFactory::loadCurrentIconTheme() {
+  PERF_SCOPE("icons.loadTheme");
+
   QStringList installed_themes = installedIconThemes();
   QString theme_name_from_settings = qApp->settings()->value(APP_CFG_GUI,
                                                              "icon_theme",
@@ -102,6 +112,9 @@ QStringList IconFactory::installedIconThemes() const {
   QStringList icon_theme_names;
   icon_theme_names << APP_NO_THEME;
 
+  // Loose icon files may have been added or removed since the last scan.
+  ResourcePack::invalidate();
+
   // Iterate all directories with icon themes.
   QStringList icon_themes_paths = QIcon::themeSearchPaths();
   icon_themes_paths.removeDuplicates();
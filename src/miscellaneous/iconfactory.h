@@ -35,6 +35,8 @@
 
 #include "definitions/definitions.h"
 #include "application.h"
+#include "miscellaneous/resourcepack.h"
+#include "miscellaneous/performancemonitor.h"
 
 #include <QString>
 #include <QIcon>
@@ -62,9 +64,10 @@ class IconFactory : public QObject {
 
       if (!m_cachedIcons.contains(name)) {
         // Icon is not cached yet.
-        m_cachedIcons.insert(name, QIcon(APP_THEME_PATH + QDir::separator() +
-                                         m_currentIconTheme + QDir::separator() +
-                                         name + APP_THEME_SUFFIX));
+        PERF_COUNT("icons.created", 1);
+        m_cachedIcons.insert(name, QIcon(ResourcePack::filePath(ResourcePack::Icons,
+                                                                m_currentIconTheme + '/' +
+                                                                name + APP_THEME_SUFFIX)));
       }
 
       return m_cachedIcons.value(name);
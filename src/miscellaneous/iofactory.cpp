@@ -31,42 +31,25 @@
 #include "miscellaneous/iofactory.h"
 
 #include "miscellaneous/application.h"
+#include "miscellaneous/audioplayer.h"
+#include "miscellaneous/logger.h"
+#include "miscellaneous/performancemonitor.h"
 
 #include <QDir>
 #include <QFile>
 #include <QTextStream>
 
-#if !defined(Q_OS_OS2)
-#if QT_VERSION >= 0x050000
-#include <QSound>
-#else
-#include <MediaObject>
-#include <AudioOutput>
-#endif
-#endif
-
 
 IOFactory::IOFactory() {
 }
 
 void IOFactory::playWaveFile(const QString &file_path) {
-#if QT_VERSION >= 0x050000
-  QSound::play(file_path);
-#elif !defined(Q_OS_OS2)
-  Phonon::AudioOutput *out = new Phonon::AudioOutput(Phonon::MusicCategory, qApp);
-  out->setVolume(100.0f);
-  out->setMuted(false);
-
-  Phonon::MediaObject *music = Phonon::createPlayer(Phonon::MusicCategory, Phonon::MediaSource(file_path));
-
-  Phonon::createPath(music, out);
-  music->play();
-  QObject::connect(music, SIGNAL(finished()), music, SLOT(deleteLater()));
-  QObject::connect(music, SIGNAL(finished()), out, SLOT(deleteLater()));
-#endif
+  AudioPlayer::instance()->play(file_path);
 }
 
 bool IOFactory::copyFile(const QString &source, const QString &destination) {
+  PERF_SCOPE("io.copyFile");
+
   if (!QFile::exists(source)) {
     qDebug("Source file \'%s\' does not exist.", qPrintable(QDir::toNativeSeparators(source)));
     return false;
@@ -135,6 +118,8 @@ bool IOFactory::base64ToFile(const QString &source_data, const QString &target_f
 }
 
 bool IOFactory::copyDirectory(QString source, QString destination) {
+  PERF_SCOPE("io.copyDirectory");
+
   QDir dir(source);
 
   if (! dir.exists()) {
@@ -152,12 +137,15 @@ bool IOFactory::copyDirectory(QString source, QString destination) {
     QString destination_file = destination + QDir::separator() + f;
 
     if (!QFile::exists(destination_file) || QFile::remove(destination_file)) {
+      PERF_COUNT("io.filesCopied", 1);
+
       if (!QFile::copy(original_file, destination_file)) {
-        qDebug("Failed to copy file \'%s\'.", qPrintable(QDir::toNativeSeparators(original_file)));
+        LOG_WARNING("Failed to copy file.", Logger::Fields() << Logger::field("source", QDir::toNativeSeparators(original_file)) <<
+                    Logger::field("destination", QDir::toNativeSeparators(destination_file)));
       }
     }
     else {
-      qDebug("Failed to remove file \'%s\'.", qPrintable(QDir::toNativeSeparators(original_file)));
+      LOG_WARNING("Failed to remove file.", Logger::Fields() << Logger::field("file", QDir::toNativeSeparators(destination_file)));
     }
   }
 
@@ -39,12 +39,16 @@
 #include <QDir>
 #include <QFileInfoList>
 #include <QLocale>
+#include <QFile>
+#include <QDateTime>
+#include <QDataStream>
 
 
 QPointer<Localization> Localization::s_instance;
 
 Localization::Localization(QObject *parent)
-  : QObject(parent) {
+  : QObject(parent), m_loadedLanguage(QString()), m_manifest(QHash<QString, ManifestEntry>()),
+    m_manifestLoaded(false) {
 }
 
 Localization::~Localization() {
@@ -70,9 +74,7 @@ void Localization::load() {
   QTranslator *app_translator = new QTranslator(qApp);
   QString desired_localization = desiredLanguage();
 
-  if (app_translator->load(QString("buildmlearn-toolkit-%1.qm").arg(desired_localization),
-                           APP_LANG_PATH,
-                           "-")) {
+  if (loadTranslation(app_translator, QString("buildmlearn-toolkit-%1").arg(desired_localization))) {
     Application::installTranslator(app_translator);
     qDebug("Application localization '%s' loaded successfully.",
            qPrintable(desired_localization));
@@ -84,9 +86,7 @@ void Localization::load() {
     desired_localization = DEFAULT_LOCALE;
   }
 
-  if (qt_translator->load(QString("qt-%1.qm").arg(desired_localization),
-                          APP_LANG_PATH,
-                          "-")) {
+  if (loadTranslation(qt_translator, QString("qt-%1").arg(desired_localization))) {
     Application::installTranslator(qt_translator);
     qDebug("Qt localization '%s' loaded successfully.",
            qPrintable(desired_localization));
@@ -103,22 +103,150 @@ void Localization::load() {
 QList<Language> Localization::installedLanguages() {
   QList<Language> languages;
   QDir file_dir(APP_LANG_PATH);
-  QTranslator translator;
+  QHash<QString, ManifestEntry> manifest;
+  bool manifest_changed = false;
+
+  if (!m_manifestLoaded) {
+    loadManifest();
+  }
 
   // Iterate all found language files.
   foreach (const QFileInfo &file, file_dir.entryInfoList(QStringList() << "buildmlearn-toolkit-*.qm",
                                                          QDir::Files,
                                                          QDir::Name)) {
-    if (translator.load(file.absoluteFilePath())) {
-      Language new_language;
-      new_language.m_name = translator.translate("QObject", "LANG_NAME");
-      new_language.m_code = translator.translate("QObject", "LANG_ABBREV");
-      new_language.m_author = translator.translate("QObject", "LANG_AUTHOR");
-      new_language.m_email = translator.translate("QObject", "LANG_EMAIL");
-
-      languages << new_language;
+    ManifestEntry entry = m_manifest.value(file.fileName());
+
+    if (!m_manifest.contains(file.fileName()) ||
+        entry.m_modified != file.lastModified().toMSecsSinceEpoch() ||
+        entry.m_size != file.size()) {
+      // Translation file is not in manifest or it changed, read its metadata.
+      QTranslator translator;
+
+      entry.m_modified = file.lastModified().toMSecsSinceEpoch();
+      entry.m_size = file.size();
+      entry.m_valid = translator.load(file.absoluteFilePath());
+
+      if (entry.m_valid) {
+        entry.m_language.m_name = translator.translate("QObject", "LANG_NAME");
+        entry.m_language.m_code = translator.translate("QObject", "LANG_ABBREV");
+        entry.m_language.m_author = translator.translate("QObject", "LANG_AUTHOR");
+        entry.m_language.m_email = translator.translate("QObject", "LANG_EMAIL");
+      }
+
+      manifest_changed = true;
+    }
+
+    if (entry.m_valid) {
+      languages << entry.m_language;
     }
+
+    manifest.insert(file.fileName(), entry);
+  }
+
+  if (manifest_changed || manifest.size() != m_manifest.size()) {
+    // Some translation files were added, changed or removed.
+    m_manifest = manifest;
+    saveManifest();
   }
+
   return languages;
 }
 
+bool Localization::loadTranslation(QTranslator *translator, const QString &base_name) {
+  QString file_name = base_name;
+
+  // Search like QTranslator::load() with "-" delimiter does, so that
+  // for example "pt-BR" falls back to "pt" if there is no translation for the region.
+  while (!QFile::exists(APP_LANG_PATH + QDir::separator() + file_name + ".qm")) {
+    int delimiter_index = file_name.lastIndexOf('-');
+
+    if (delimiter_index < 0) {
+      return false;
+    }
+
+    file_name = file_name.left(delimiter_index);
+  }
+
+  // File is owned by translator, so mapped data live as long as translator does.
+  QFile *file = new QFile(APP_LANG_PATH + QDir::separator() + file_name + ".qm", translator);
+
+  if (!file->open(QIODevice::ReadOnly)) {
+    delete file;
+    return false;
+  }
+
+  uchar *data = file->map(0, file->size());
+
+  if (data == NULL) {
+    // Mapping is not supported, let translator read the file.
+    delete file;
+    return translator->load(file_name + ".qm", APP_LANG_PATH);
+  }
+
+  return translator->load(data, (int) file->size());
+}
+
+void Localization::loadManifest() {
+  QFile file(manifestFile());
+
+  m_manifestLoaded = true;
+  m_manifest.clear();
+
+  if (!file.open(QIODevice::ReadOnly)) {
+    return;
+  }
+
+  QDataStream stream(&file);
+  quint32 version;
+  QString lang_path;
+  qint32 count;
+
+  stream >> version >> lang_path >> count;
+
+  if (version != LANGUAGE_MANIFEST_VERSION || lang_path != APP_LANG_PATH) {
+    // Manifest is obsolete or it belongs to translations in other location.
+    qDebug("Language manifest is obsolete, languages will be indexed again.");
+    return;
+  }
+
+  for (int i = 0; i < count && stream.status() == QDataStream::Ok; i++) {
+    QString file_name;
+    ManifestEntry entry;
+
+    stream >> file_name >> entry.m_modified >> entry.m_size >> entry.m_valid >>
+              entry.m_language.m_name >> entry.m_language.m_code >>
+              entry.m_language.m_author >> entry.m_language.m_email;
+
+    if (stream.status() == QDataStream::Ok) {
+      m_manifest.insert(file_name, entry);
+    }
+  }
+}
+
+void Localization::saveManifest() {
+  QDir().mkpath(QFileInfo(manifestFile()).absolutePath());
+
+  QFile file(manifestFile());
+
+  if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+    qWarning("Language manifest '%s' cannot be saved.", qPrintable(file.fileName()));
+    return;
+  }
+
+  QDataStream stream(&file);
+
+  stream << (quint32) LANGUAGE_MANIFEST_VERSION << QString(APP_LANG_PATH) << (qint32) m_manifest.size();
+
+  for (QHash<QString, ManifestEntry>::const_iterator it = m_manifest.constBegin(); it != m_manifest.constEnd(); ++it) {
+    const ManifestEntry &entry = it.value();
+
+    stream << it.key() << entry.m_modified << entry.m_size << entry.m_valid <<
+              entry.m_language.m_name << entry.m_language.m_code <<
+              entry.m_language.m_author << entry.m_language.m_email;
+  }
+}
+
+QString Localization::manifestFile() const {
+  return QFileInfo(qApp->settings()->fileName()).absolutePath() + QDir::separator() + LANGUAGE_MANIFEST_FILE;
+}
+
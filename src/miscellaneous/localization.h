@@ -34,6 +34,7 @@
 #include <QString>
 #include <QObject>
 #include <QPointer>
+#include <QHash>
 
 
 /// \brief Representation of single localization.
@@ -44,7 +45,13 @@ struct Language {
     QString m_email;
 };
 
+class QTranslator;
+
 /// \brief Localization facilities.
+///
+/// Metadata of installed languages are kept in persistent manifest
+/// keyed by modification time and size of translation files, so
+/// translation files are not loaded just to list languages.
 class Localization : public QObject {
     Q_OBJECT
 
@@ -82,9 +89,28 @@ class Localization : public QObject {
     }
 
   private:
+    // Loads translation file into translator, file is memory-mapped. Base name
+    // is given without suffix and it is shortened at "-" until some file is found.
+    bool loadTranslation(QTranslator *translator, const QString &base_name);
+
+    // Loads and saves manifest of installed languages.
+    void loadManifest();
+    void saveManifest();
+    QString manifestFile() const;
+
+    struct ManifestEntry {
+        qint64 m_modified;
+        qint64 m_size;
+        bool m_valid;
+        Language m_language;
+    };
+
     // Code of loaded language.
     QString m_loadedLanguage;
 
+    QHash<QString, ManifestEntry> m_manifest;
+    bool m_manifestLoaded;
+
     // Singleton.
     static QPointer<Localization> s_instance;
 };
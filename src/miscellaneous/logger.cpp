@@ -0,0 +1,395 @@
+/*
+  Copyright (c) 2012, BuildmLearn Contributors listed at http://buildmlearn.org/people/
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+
+  * Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+
+  * Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+
+  * Neither the name of the BuildmLearn nor the names of its
+    contributors may be used to endorse or promote products derived from
+    this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "miscellaneous/logger.h"
+
+#include "definitions/definitions.h"
+
+#include <QCoreApplication>
+#include <QThread>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QDateTime>
+#include <QFile>
+#include <QFileInfo>
+#include <QDir>
+
+#include <cstdio>
+
+
+// Single slot of the ring buffer. Sequence number tells whether
+// slot is free for producer with given position or ready for the writer.
+struct LogEntry {
+    QAtomicInt m_sequence;
+    int m_level;
+    qint64 m_time;
+    Qt::HANDLE m_thread;
+    const char *m_file;
+    int m_line;
+    QString m_message;
+    Logger::Fields m_fields;
+};
+
+// Background thread which writes buffered messages.
+class LogWriter : public QThread {
+  protected:
+    void run();
+};
+
+static LogEntry s_entries[LOG_BUFFER_SIZE];
+static QAtomicInt s_enqueuePosition;
+static QAtomicInt s_dequeuePosition;
+static QAtomicInt s_dropped;
+static QAtomicInt s_droppedTotal;
+static QAtomicInt s_running;
+
+// Number of threads which are inside Logger::log().
+static QAtomicInt s_producers;
+
+static LogWriter *s_writer = NULL;
+static QMutex s_writerMutex;
+static QWaitCondition s_wakeUp;
+static QWaitCondition s_written;
+
+static QMutex s_fileMutex;
+static QFile *s_file = NULL;
+
+QAtomicInt Logger::s_level(Logger::Debug);
+
+static inline int loadValue(QAtomicInt &value) {
+#if QT_VERSION >= 0x050000
+  return value.loadAcquire();
+#else
+  return value.fetchAndAddAcquire(0);
+#endif
+}
+
+// Positions wrap around, so they are compared as distances.
+static inline int positionDistance(int from, int to) {
+  return (int) ((uint) to - (uint) from);
+}
+
+static inline int nextPosition(int position, int step) {
+  return (int) ((uint) position + (uint) step);
+}
+
+// Counts thread as producer for the lifetime of the guard.
+class ProducerGuard {
+  public:
+    inline ProducerGuard() {
+      s_producers.fetchAndAddOrdered(1);
+    }
+
+    inline ~ProducerGuard() {
+      s_producers.fetchAndAddOrdered(-1);
+    }
+};
+
+static const char *levelName(int level) {
+  switch (level) {
+    case Logger::Debug:
+      return "DEBUG";
+    case Logger::Warning:
+      return "WARNING";
+    case Logger::Critical:
+      return "CRITICAL";
+    case Logger::Fatal:
+    default:
+      return "FATAL";
+  }
+}
+
+static void rotateLogFile() {
+  QString file_path = s_file->fileName();
+
+  s_file->close();
+
+  // Shift older files, the oldest one is removed.
+  QFile::remove(QString("%1.%2").arg(file_path, QString::number(LOG_FILE_COUNT)));
+
+  for (int i = LOG_FILE_COUNT - 1; i > 0; i--) {
+    QFile::rename(QString("%1.%2").arg(file_path, QString::number(i)),
+                  QString("%1.%2").arg(file_path, QString::number(i + 1)));
+  }
+
+  QFile::rename(file_path, file_path + ".1");
+  s_file->open(QIODevice::WriteOnly | QIODevice::Append | QIODevice::Text);
+}
+
+static void writeEntry(int level, qint64 time, Qt::HANDLE thread, const char *file, int line,
+                       const QString &message, const Logger::Fields &fields) {
+  QString text = message;
+
+  for (Logger::Fields::const_iterator it = fields.constBegin(); it != fields.constEnd(); ++it) {
+    text += QString(" %1=%2").arg(it->first, it->second);
+  }
+
+  QByteArray local_text = text.toLocal8Bit();
+  QByteArray file_name = QString(file).section('/', -1).section('\\', -1).toLocal8Bit();
+
+  if (file != NULL) {
+    fprintf(stderr, "[%s] %s (%s:%d): %s\n", APP_LOW_NAME, levelName(level), file_name.constData(), line, local_text.constData());
+  }
+  else {
+    fprintf(stderr, "[%s] %s: %s\n", APP_LOW_NAME, levelName(level), local_text.constData());
+  }
+
+  QMutexLocker locker(&s_fileMutex);
+
+  if (s_file != NULL && s_file->isOpen()) {
+    s_file->write(QString("%1 [%2] %3 (%4:%5): %6\n").arg(QDateTime::fromMSecsSinceEpoch(time).toString(Qt::ISODate),
+                                                          QString::number((quintptr) thread, 16),
+                                                          levelName(level),
+                                                          QString(file_name),
+                                                          QString::number(line),
+                                                          text).toUtf8());
+
+    if (s_file->size() > LOG_FILE_MAX_SIZE) {
+      rotateLogFile();
+    }
+  }
+}
+
+// Writes all messages available in the buffer, only writer thread
+// (or stopped logger) consumes messages.
+static int drainEntries() {
+  int written = 0;
+  int position = loadValue(s_dequeuePosition);
+
+  forever {
+    LogEntry &entry = s_entries[position & (LOG_BUFFER_SIZE - 1)];
+
+    if (loadValue(entry.m_sequence) != nextPosition(position, 1)) {
+      // Slot is not filled yet.
+      break;
+    }
+
+    writeEntry(entry.m_level, entry.m_time, entry.m_thread, entry.m_file, entry.m_line,
+               entry.m_message, entry.m_fields);
+
+    entry.m_message.clear();
+    entry.m_fields.clear();
+
+    // Slot becomes available for producer one lap later.
+    entry.m_sequence.fetchAndStoreRelease(nextPosition(position, LOG_BUFFER_SIZE));
+    position = nextPosition(position, 1);
+    s_dequeuePosition.fetchAndStoreRelease(position);
+    written++;
+  }
+
+  int dropped = s_dropped.fetchAndStoreOrdered(0);
+
+  if (dropped > 0) {
+    writeEntry(Logger::Warning, QDateTime::currentMSecsSinceEpoch(), QThread::currentThreadId(), __FILE__, __LINE__,
+               QString("Log buffer was full, %1 messages were dropped.").arg(dropped), Logger::Fields());
+  }
+
+  fflush(stderr);
+
+  QMutexLocker locker(&s_fileMutex);
+
+  if (s_file != NULL) {
+    s_file->flush();
+  }
+
+  return written;
+}
+
+void LogWriter::run() {
+  while (loadValue(s_running) != 0) {
+    int written = drainEntries();
+
+    s_writerMutex.lock();
+    s_written.wakeAll();
+
+    if (written == 0 && loadValue(s_running) != 0) {
+      // Producers never block, so writer just checks the buffer periodically.
+      s_wakeUp.wait(&s_writerMutex, LOG_WRITE_INTERVAL);
+    }
+
+    s_writerMutex.unlock();
+  }
+}
+
+void Logger::start() {
+  if (s_writer != NULL) {
+    return;
+  }
+
+  for (int i = 0; i < LOG_BUFFER_SIZE; i++) {
+    s_entries[i].m_sequence.fetchAndStoreRelease(i);
+  }
+
+  s_enqueuePosition.fetchAndStoreRelease(0);
+  s_dequeuePosition.fetchAndStoreRelease(0);
+  s_running.fetchAndStoreRelease(1);
+
+  s_writer = new LogWriter();
+  s_writer->start(QThread::LowPriority);
+
+  qAddPostRoutine(Logger::stop);
+}
+
+void Logger::stop() {
+  if (s_writer == NULL) {
+    return;
+  }
+
+  s_writerMutex.lock();
+  s_running.fetchAndStoreOrdered(0);
+  s_wakeUp.wakeAll();
+  s_writerMutex.unlock();
+
+  s_writer->wait();
+  delete s_writer;
+  s_writer = NULL;
+
+  // Producers which saw running writer may still be filling their slots,
+  // new producers write synchronously now.
+  while (loadValue(s_producers) != 0) {
+    drainEntries();
+    QThread::yieldCurrentThread();
+  }
+
+  // Write messages which came after writer finished.
+  drainEntries();
+  setLogFile(QString());
+}
+
+void Logger::flush() {
+  if (s_writer == NULL || QThread::currentThread() == s_writer) {
+    return;
+  }
+
+  int target = loadValue(s_enqueuePosition);
+  QMutexLocker locker(&s_writerMutex);
+
+  while (positionDistance(target, loadValue(s_dequeuePosition)) < 0 && loadValue(s_running) != 0) {
+    s_wakeUp.wakeAll();
+    s_written.wait(&s_writerMutex, LOG_WRITE_INTERVAL);
+  }
+}
+
+void Logger::setLevel(Level level) {
+  s_level.fetchAndStoreRelease(level);
+}
+
+void Logger::setLogFile(const QString &file_path) {
+  QMutexLocker locker(&s_fileMutex);
+
+  if (s_file != NULL) {
+    s_file->close();
+    delete s_file;
+    s_file = NULL;
+  }
+
+  if (file_path.isEmpty()) {
+    return;
+  }
+
+  QDir().mkpath(QFileInfo(file_path).absolutePath());
+  s_file = new QFile(file_path);
+
+  if (!s_file->open(QIODevice::WriteOnly | QIODevice::Append | QIODevice::Text)) {
+    delete s_file;
+    s_file = NULL;
+  }
+}
+
+void Logger::log(Level level, const QString &message, const Fields &fields, const char *file, int line) {
+  if (!isEnabled(level)) {
+    return;
+  }
+
+  ProducerGuard guard;
+  qint64 time = QDateTime::currentMSecsSinceEpoch();
+
+  // Full barrier pairs with stop(), either stop() waits for this producer
+  // or this producer sees stopped writer.
+  if (s_running.fetchAndAddOrdered(0) == 0) {
+    // Writer is not running, write the message right away.
+    writeEntry(level, time, QThread::currentThreadId(), file, line, message, fields);
+    fflush(stderr);
+    return;
+  }
+
+  int position = loadValue(s_enqueuePosition);
+  LogEntry *entry;
+
+  forever {
+    entry = &s_entries[position & (LOG_BUFFER_SIZE - 1)];
+
+    int difference = positionDistance(position, loadValue(entry->m_sequence));
+
+    if (difference == 0) {
+      // Slot is free, try to claim it.
+      if (s_enqueuePosition.testAndSetOrdered(position, nextPosition(position, 1))) {
+        break;
+      }
+
+      position = loadValue(s_enqueuePosition);
+    }
+    else if (difference < 0) {
+      // Buffer is full, writer is behind. Important messages must not be
+      // lost, so they are written right away, possibly out of order.
+      if (level >= Warning) {
+        writeEntry(level, time, QThread::currentThreadId(), file, line, message, fields);
+        fflush(stderr);
+        return;
+      }
+
+      s_dropped.fetchAndAddRelaxed(1);
+      s_droppedTotal.fetchAndAddRelaxed(1);
+      return;
+    }
+    else {
+      // Other producer claimed the slot.
+      position = loadValue(s_enqueuePosition);
+    }
+  }
+
+  entry->m_level = level;
+  entry->m_time = time;
+  entry->m_thread = QThread::currentThreadId();
+  entry->m_file = file;
+  entry->m_line = line;
+  entry->m_message = message;
+  entry->m_fields = fields;
+
+  // Publish the slot to the writer.
+  entry->m_sequence.fetchAndStoreRelease(nextPosition(position, 1));
+}
+
+int Logger::droppedMessages() {
+  return loadValue(s_droppedTotal);
+}
+
+Logger::Logger() {
+}
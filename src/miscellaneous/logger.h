@@ -0,0 +1,128 @@
+/*
+  Copyright (c) 2012, BuildmLearn Contributors listed at http://buildmlearn.org/people/
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+
+  * Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+
+  * Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+
+  * Neither the name of the BuildmLearn nor the names of its
+    contributors may be used to endorse or promote products derived from
+    this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef LOGGER_H
+#define LOGGER_H
+
+#include <QString>
+#include <QList>
+#include <QPair>
+#include <QVariant>
+#include <QAtomicInt>
+
+
+/// \brief Logs message with fields if given level is enabled.
+/// Arguments are not evaluated when level is disabled.
+#define LOG_MESSAGE(level, message, fields) \
+  do { \
+    if (Logger::isEnabled(level)) { \
+      Logger::log(level, message, fields, __FILE__, __LINE__); \
+    } \
+  } while (0)
+
+#define LOG_DEBUG(message, fields)    LOG_MESSAGE(Logger::Debug, message, fields)
+#define LOG_WARNING(message, fields)  LOG_MESSAGE(Logger::Warning, message, fields)
+
+/// \brief Asynchronous application log.
+///
+/// Messages are put into lock-free ring buffer of LOG_BUFFER_SIZE entries
+/// by any number of threads and written to stderr and optional
+/// rotating log file by background writer thread. Debug messages
+/// which do not fit into full buffer are dropped and counted, warnings
+/// and more severe messages are written synchronously then.
+///
+/// Until start() is called (and after stop() is called), messages
+/// are written synchronously.
+class Logger {
+  public:
+    /// \brief Severity of messages, matches QtMsgType.
+    enum Level {
+      Debug     = 0,
+      Warning   = 1,
+      Critical  = 2,
+      Fatal     = 3
+    };
+
+    /// \brief Key/value fields attached to message.
+    typedef QList<QPair<QString, QString> > Fields;
+
+    /// \brief Starts background writer thread.
+    /// \remarks Writer is stopped automatically when application quits.
+    static void start();
+
+    /// \brief Writes all buffered messages and stops writer thread.
+    static void stop();
+
+    /// \brief Waits until all messages logged so far are written.
+    static void flush();
+
+    /// \brief Sets minimal level of logged messages.
+    static void setLevel(Level level);
+
+    /// \brief Checks if messages of given level are logged.
+    static inline bool isEnabled(Level level) {
+#if QT_VERSION >= 0x050000
+      return level >= s_level.load();
+#else
+      return level >= (int) s_level;
+#endif
+    }
+
+    /// \brief Sets file messages are written into.
+    /// \param file_path Path to log file, empty path disables logging to file.
+    /// \remarks File is rotated when it exceeds LOG_FILE_MAX_SIZE, LOG_FILE_COUNT
+    /// older files are kept.
+    static void setLogFile(const QString &file_path);
+
+    /// \brief Logs message.
+    /// \param level Severity of message.
+    /// \param message Text of message.
+    /// \param fields Additional key/value data.
+    /// \param file Source file name, must be string literal.
+    /// \param line Source line.
+    static void log(Level level, const QString &message, const Fields &fields = Fields(),
+                    const char *file = NULL, int line = 0);
+
+    /// \brief Creates message field.
+    static inline QPair<QString, QString> field(const QString &key, const QVariant &value) {
+      return qMakePair(key, value.toString());
+    }
+
+    /// \brief Number of messages dropped because buffer was full.
+    static int droppedMessages();
+
+  private:
+    // Constructor.
+    explicit Logger();
+
+    static QAtomicInt s_level;
+};
+
+#endif // LOGGER_H
@@ -0,0 +1,245 @@
+/*
+  Copyright (c) 2012, BuildmLearn Contributors listed at http://buildmlearn.org/people/
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+
+  * Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+
+  * Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+
+  * Neither the name of the BuildmLearn nor the names of its
+    contributors may be used to endorse or promote products derived from
+    this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "miscellaneous/performancemonitor.h"
+
+#include "definitions/definitions.h"
+
+#include <QMutex>
+#include <QFile>
+#include <QTextStream>
+#include <QStringList>
+
+
+static QMutex s_mutex;
+static QHash<QString, PerformanceMonitor::Statistics> s_statistics;
+static QHash<QString, qint64> s_counters;
+static QList<PerformanceMonitor::Sample> s_slowestSamples;
+
+QAtomicInt PerformanceMonitor::s_enabled(0);
+
+void PerformanceMonitor::setEnabled(bool enabled) {
+  s_enabled.fetchAndStoreRelease(enabled ? 1 : 0);
+}
+
+void PerformanceMonitor::record(const char *name, qint64 duration) {
+  QList<qint64> bounds = histogramBounds();
+  int bucket = 0;
+
+  while (bucket < bounds.size() && duration > bounds.at(bucket)) {
+    bucket++;
+  }
+
+  QMutexLocker locker(&s_mutex);
+  QString key = QString::fromLatin1(name);
+  QHash<QString, Statistics>::iterator statistics = s_statistics.find(key);
+
+  if (statistics == s_statistics.end()) {
+    Statistics new_statistics;
+
+    new_statistics.m_name = key;
+    new_statistics.m_count = 0;
+    new_statistics.m_totalTime = 0;
+    new_statistics.m_minimumTime = duration;
+    new_statistics.m_maximumTime = duration;
+    new_statistics.m_histogram = QVector<qint64>(bounds.size() + 1, 0);
+
+    statistics = s_statistics.insert(key, new_statistics);
+  }
+
+  statistics->m_count++;
+  statistics->m_totalTime += duration;
+  statistics->m_minimumTime = qMin(statistics->m_minimumTime, duration);
+  statistics->m_maximumTime = qMax(statistics->m_maximumTime, duration);
+  statistics->m_histogram[bucket]++;
+
+  // Keep only the slowest samples, sorted from the slowest one.
+  if (s_slowestSamples.size() < PERF_SLOWEST_COUNT || duration > s_slowestSamples.last().m_duration) {
+    Sample sample;
+    int position = 0;
+
+    sample.m_name = key;
+    sample.m_duration = duration;
+    sample.m_finished = QDateTime::currentDateTime();
+
+    while (position < s_slowestSamples.size() && s_slowestSamples.at(position).m_duration >= duration) {
+      position++;
+    }
+
+    s_slowestSamples.insert(position, sample);
+
+    if (s_slowestSamples.size() > PERF_SLOWEST_COUNT) {
+      s_slowestSamples.removeLast();
+    }
+  }
+}
+
+void PerformanceMonitor::count(const char *name, qint64 value) {
+  QMutexLocker locker(&s_mutex);
+  s_counters[QString::fromLatin1(name)] += value;
+}
+
+QList<qint64> PerformanceMonitor::histogramBounds() {
+  return QList<qint64>() << 100 << 1000 << 10000 << 50000 << 100000 << 500000 << 1000000 << 5000000;
+}
+
+QList<PerformanceMonitor::Statistics> PerformanceMonitor::statistics() {
+  QMutexLocker locker(&s_mutex);
+  return s_statistics.values();
+}
+
+QList<PerformanceMonitor::Sample> PerformanceMonitor::slowestSamples() {
+  QMutexLocker locker(&s_mutex);
+  return s_slowestSamples;
+}
+
+QHash<QString, qint64> PerformanceMonitor::counters() {
+  QMutexLocker locker(&s_mutex);
+  return s_counters;
+}
+
+void PerformanceMonitor::clear() {
+  QMutexLocker locker(&s_mutex);
+
+  s_statistics.clear();
+  s_counters.clear();
+  s_slowestSamples.clear();
+}
+
+QString PerformanceMonitor::escapeJson(const QString &text) {
+  QString escaped;
+
+  escaped.reserve(text.size());
+
+  foreach (const QChar &character, text) {
+    switch (character.unicode()) {
+      case '\\':
+        escaped += "\\\\";
+        break;
+
+      case '"':
+        escaped += "\\\"";
+        break;
+
+      case '\n':
+        escaped += "\\n";
+        break;
+
+      case '\r':
+        escaped += "\\r";
+        break;
+
+      case '\t':
+        escaped += "\\t";
+        break;
+
+      default:
+        if (character.unicode() < 0x20) {
+          // Other control characters are not allowed in JSON strings.
+          escaped += QString("\\u%1").arg(character.unicode(), 4, 16, QChar('0'));
+        }
+        else {
+          escaped += character;
+        }
+
+        break;
+    }
+  }
+
+  return escaped;
+}
+
+bool PerformanceMonitor::exportJson(const QString &file_name) {
+  QFile report_file(file_name);
+
+  if (!report_file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text)) {
+    qWarning("Performance report file '%s' cannot be opened for writing.", qPrintable(file_name));
+    return false;
+  }
+
+  QList<Statistics> all_statistics = statistics();
+  QList<Sample> samples = slowestSamples();
+  QHash<QString, qint64> all_counters = counters();
+  QList<qint64> bounds = histogramBounds();
+  QStringList bound_names;
+  QTextStream report(&report_file);
+
+  foreach (qint64 bound, bounds) {
+    bound_names << QString::number(bound);
+  }
+
+  report.setCodec("UTF-8");
+  report << "{\n  \"version\": \"" << APP_VERSION << "\",\n";
+  report << "  \"date\": \"" << QDateTime::currentDateTime().toString(Qt::ISODate) << "\",\n";
+  report << "  \"histogram_bounds_us\": [" << bound_names.join(", ") << "],\n";
+  report << "  \"operations\": [\n";
+
+  for (int i = 0; i < all_statistics.size(); i++) {
+    const Statistics &statistics = all_statistics.at(i);
+    QStringList histogram;
+
+    foreach (qint64 bucket, statistics.m_histogram) {
+      histogram << QString::number(bucket);
+    }
+
+    report << "    {\"name\": \"" << escapeJson(statistics.m_name) << "\", \"count\": " << statistics.m_count <<
+              ", \"total_us\": " << statistics.m_totalTime << ", \"min_us\": " << statistics.m_minimumTime <<
+              ", \"max_us\": " << statistics.m_maximumTime << ", \"histogram\": [" << histogram.join(", ") << "]}" <<
+              (i < all_statistics.size() - 1 ? ",\n" : "\n");
+  }
+
+  report << "  ],\n  \"slowest\": [\n";
+
+  for (int i = 0; i < samples.size(); i++) {
+    const Sample &sample = samples.at(i);
+
+    report << "    {\"name\": \"" << escapeJson(sample.m_name) << "\", \"duration_us\": " << sample.m_duration <<
+              ", \"finished\": \"" << sample.m_finished.toString(Qt::ISODate) << "\"}" <<
+              (i < samples.size() - 1 ? ",\n" : "\n");
+  }
+
+  report << "  ],\n  \"counters\": {\n";
+
+  QStringList counter_names = all_counters.keys();
+  counter_names.sort();
+
+  for (int i = 0; i < counter_names.size(); i++) {
+    report << "    \"" << escapeJson(counter_names.at(i)) << "\": " << all_counters.value(counter_names.at(i)) <<
+              (i < counter_names.size() - 1 ? ",\n" : "\n");
+  }
+
+  report << "  }\n}\n";
+  report.flush();
+
+  return report_file.error() == QFile::NoError;
+}
+
+PerformanceMonitor::PerformanceMonitor() {
+}
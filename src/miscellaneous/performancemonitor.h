@@ -0,0 +1,160 @@
+/*
+  Copyright (c) 2012, BuildmLearn Contributors listed at http://buildmlearn.org/people/
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+
+  * Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+
+  * Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+
+  * Neither the name of the BuildmLearn nor the names of its
+    contributors may be used to endorse or promote products derived from
+    this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef PERFORMANCEMONITOR_H
+#define PERFORMANCEMONITOR_H
+
+#include <QString>
+#include <QList>
+#include <QHash>
+#include <QVector>
+#include <QDateTime>
+#include <QAtomicInt>
+#include <QElapsedTimer>
+
+
+#define PERF_CONCAT_WORKER(first, second) first##second
+#define PERF_CONCAT(first, second) PERF_CONCAT_WORKER(first, second)
+
+/// \brief Measures duration of enclosing scope under given name.
+/// \param name Name of operation, must be string literal.
+#define PERF_SCOPE(name) PerformanceTimer PERF_CONCAT(perf_timer_, __LINE__)(name)
+
+/// \brief Increments counter with given name.
+/// \param name Name of counter, must be string literal.
+/// \param value Value added to counter.
+#define PERF_COUNT(name, value) \
+  do { \
+    if (PerformanceMonitor::isEnabled()) { \
+      PerformanceMonitor::count(name, value); \
+    } \
+  } while (0)
+
+/// \brief Collects durations of key operations and values of counters.
+///
+/// Collecting is disabled by default, then timers and counters cost
+/// just single check of a flag. Collected data are shown in FormDiagnostics
+/// and can be exported to JSON.
+class PerformanceMonitor {
+  public:
+    /// \brief Aggregated durations of single operation.
+    struct Statistics {
+        QString m_name;
+        qint64 m_count;
+
+        // Durations in microseconds.
+        qint64 m_totalTime;
+        qint64 m_minimumTime;
+        qint64 m_maximumTime;
+
+        // Number of samples in each bucket of histogramBounds().
+        QVector<qint64> m_histogram;
+    };
+
+    /// \brief Single measured operation.
+    struct Sample {
+        QString m_name;
+        qint64 m_duration;
+        QDateTime m_finished;
+    };
+
+    /// \brief Indication of collecting.
+    static inline bool isEnabled() {
+#if QT_VERSION >= 0x050000
+      return s_enabled.load() != 0;
+#else
+      return (int) s_enabled != 0;
+#endif
+    }
+
+    /// \brief Enables or disables collecting.
+    static void setEnabled(bool enabled);
+
+    /// \brief Records duration of operation.
+    /// \param name Name of operation.
+    /// \param duration Duration in microseconds.
+    static void record(const char *name, qint64 duration);
+
+    /// \brief Adds value to counter.
+    static void count(const char *name, qint64 value);
+
+    /// \brief Upper bounds of histogram buckets in microseconds,
+    /// last bucket is unbounded.
+    static QList<qint64> histogramBounds();
+
+    /// \brief Access to collected data.
+    static QList<Statistics> statistics();
+    static QList<Sample> slowestSamples();
+    static QHash<QString, qint64> counters();
+
+    /// \brief Removes all collected data.
+    static void clear();
+
+    /// \brief Exports all collected data.
+    /// \param file_name Target JSON file.
+    /// \return Returns true if file was written.
+    static bool exportJson(const QString &file_name);
+
+    /// \brief Escapes text so that it can be placed into JSON string.
+    /// \param text Raw text.
+    /// \return Returns escaped text without enclosing quotes.
+    static QString escapeJson(const QString &text);
+
+  private:
+    // Constructor.
+    explicit PerformanceMonitor();
+
+    static QAtomicInt s_enabled;
+};
+
+/// \brief Scoped timer, use it via PERF_SCOPE.
+class PerformanceTimer {
+  public:
+    inline explicit PerformanceTimer(const char *name)
+      : m_name(PerformanceMonitor::isEnabled() ? name : NULL) {
+      if (m_name != NULL) {
+        m_timer.start();
+      }
+    }
+
+    inline ~PerformanceTimer() {
+      if (m_name != NULL) {
+        PerformanceMonitor::record(m_name, m_timer.nsecsElapsed() / 1000);
+      }
+    }
+
+  private:
+    Q_DISABLE_COPY(PerformanceTimer)
+
+    const char *m_name;
+    QElapsedTimer m_timer;
+};
+
+#endif // PERFORMANCEMONITOR_H
@@ -0,0 +1,156 @@
+/*
+  Copyright (c) 2012, BuildmLearn Contributors listed at http://buildmlearn.org/people/
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+
+  * Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+
+  * Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+
+  * Neither the name of the BuildmLearn nor the names of its
+    contributors may be used to endorse or promote products derived from
+    this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "miscellaneous/resourcepack.h"
+
+#include "definitions/definitions.h"
+
+#include <QApplication>
+#include <QResource>
+#include <QFile>
+#include <QFileInfo>
+#include <QDateTime>
+
+
+QString ResourcePack::s_filePath;
+QString ResourcePack::s_signature;
+QHash<QString, QStringList> ResourcePack::s_looseEntries;
+
+bool ResourcePack::load(const QString &file_path) {
+  if (isLoaded()) {
+    return true;
+  }
+
+  QFileInfo pack_info(file_path);
+
+  if (!pack_info.exists()) {
+    qDebug("Resource pack '%s' is not installed, loose resource files are used.",
+           qPrintable(QDir::toNativeSeparators(file_path)));
+    return false;
+  }
+
+  // Pack is memory-mapped by Qt where it is possible.
+  if (!QResource::registerResource(pack_info.absoluteFilePath(), RESOURCE_PACK_ROOT)) {
+    qWarning("Resource pack '%s' cannot be registered.",
+             qPrintable(QDir::toNativeSeparators(file_path)));
+    return false;
+  }
+
+  s_filePath = pack_info.absoluteFilePath();
+  s_signature = QString("%1:%2:%3").arg(s_filePath,
+                                        QString::number(pack_info.size()),
+                                        QString::number(pack_info.lastModified().toMSecsSinceEpoch()));
+
+  qDebug("Resource pack '%s' loaded.", qPrintable(QDir::toNativeSeparators(s_filePath)));
+  return true;
+}
+
+bool ResourcePack::isLoaded() {
+  return !s_filePath.isEmpty();
+}
+
+QString ResourcePack::signature() {
+  return s_signature;
+}
+
+QString ResourcePack::filePath(Location location, const QString &relative_path) {
+  QString loose_path = looseRoot(location) + '/' + relative_path;
+
+  if (!isLoaded() || looseFileExists(loose_path)) {
+    return loose_path;
+  }
+
+  QString packed_path = packRoot(location) + '/' + relative_path;
+
+  // Lookups in registered pack do not touch the disk.
+  return QFile::exists(packed_path) ? packed_path : loose_path;
+}
+
+QString ResourcePack::directoryPath(Location location, const QString &relative_path) {
+  return QFileInfo(filePath(location, relative_path)).path();
+}
+
+QStringList ResourcePack::entryList(Location location, const QString &relative_path,
+                                    const QStringList &name_filters, QDir::Filters filters) {
+  QString suffix = relative_path.isEmpty() ? QString() : QString('/' + relative_path);
+  QStringList entries = QDir(looseRoot(location) + suffix).entryList(name_filters, filters);
+
+  if (isLoaded()) {
+    entries << QDir(packRoot(location) + suffix).entryList(name_filters, filters);
+    entries.removeDuplicates();
+    entries.sort();
+  }
+
+  return entries;
+}
+
+QString ResourcePack::looseRoot(Location location) {
+  switch (location) {
+    case Icons:
+      return APP_THEME_PATH;
+
+    case Skins:
+      return APP_SKIN_PATH;
+
+    case Templates:
+    default:
+      return APP_TEMPLATES_PATH;
+  }
+}
+
+QString ResourcePack::packRoot(Location location) {
+  switch (location) {
+    case Icons:
+      return QString(":" RESOURCE_PACK_ROOT "/icons");
+
+    case Skins:
+      return QString(":" RESOURCE_PACK_ROOT "/skins");
+
+    case Templates:
+    default:
+      return QString(":" RESOURCE_PACK_ROOT "/templates");
+  }
+}
+
+void ResourcePack::invalidate() {
+  s_looseEntries.clear();
+}
+
+bool ResourcePack::looseFileExists(const QString &file_path) {
+  QFileInfo file_info(file_path);
+  QString directory = file_info.path();
+
+  if (!s_looseEntries.contains(directory)) {
+    // Each directory is listed only once instead of probing every file.
+    s_looseEntries.insert(directory, QDir(directory).entryList(QDir::Files | QDir::Readable));
+  }
+
+  return s_looseEntries.value(directory).contains(file_info.fileName());
+}
@@ -0,0 +1,111 @@
+/*
+  Copyright (c) 2012, BuildmLearn Contributors listed at http://buildmlearn.org/people/
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+
+  * Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+
+  * Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+
+  * Neither the name of the BuildmLearn nor the names of its
+    contributors may be used to endorse or promote products derived from
+    this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef RESOURCEPACK_H
+#define RESOURCEPACK_H
+
+#include "definitions/definitions.h"
+
+#include <QString>
+#include <QStringList>
+#include <QHash>
+#include <QDir>
+
+
+/// \brief Optional compiled pack of icon themes, skins and template thumbnails.
+///
+/// Pack is binary rcc file which is registered (memory-mapped) once
+/// under RESOURCE_PACK_ROOT. Loose files installed in usual directories
+/// override files from the pack, so users can still customize single icons
+/// or skins without rebuilding the pack.
+class ResourcePack {
+  public:
+    /// \brief Kinds of packed resources.
+    enum Location {
+      Icons,
+      Skins,
+      Templates
+    };
+
+    /// \brief Registers resource pack if it is installed.
+    /// \param file_path Path to pack file.
+    /// \return Returns true if pack is available.
+    static bool load(const QString &file_path = APP_RESOURCE_PACK_PATH);
+
+    /// \brief Indication of loaded pack.
+    /// \return Returns true if resource pack is loaded.
+    static bool isLoaded();
+
+    /// \brief Identification of loaded pack, useful for invalidating caches.
+    /// \return Returns string which changes whenever pack file changes.
+    static QString signature();
+
+    /// \brief Resolves path to resource file.
+    /// \param location Kind of resource.
+    /// \param relative_path Path relative to root directory of location,
+    /// separated by '/'.
+    /// \return Returns path to loose file if it exists, otherwise
+    /// path to packed file if it exists, otherwise path to (missing)
+    /// loose file.
+    static QString filePath(Location location, const QString &relative_path);
+
+    /// \brief Resolves directory which contains resource file.
+    /// \see filePath()
+    static QString directoryPath(Location location, const QString &relative_path);
+
+    /// \brief Lists entries of resource directory, packed and loose ones.
+    /// \param location Kind of resource.
+    /// \param relative_path Directory relative to root directory of location.
+    /// \param name_filters Name filters, see QDir::entryList().
+    /// \param filters Filters, see QDir::entryList().
+    /// \return Returns sorted list of unique entry names.
+    static QStringList entryList(Location location, const QString &relative_path,
+                                 const QStringList &name_filters, QDir::Filters filters);
+
+    /// \brief Root directory of loose files for given location.
+    static QString looseRoot(Location location);
+
+    /// \brief Root directory of packed files for given location.
+    static QString packRoot(Location location);
+
+    /// \brief Forgets cached listings of loose files, call it before
+    /// installed resources are scanned again.
+    static void invalidate();
+
+  private:
+    // Returns true if loose file exists, directory listings are cached.
+    static bool looseFileExists(const QString &file_path);
+
+    static QString s_filePath;
+    static QString s_signature;
+    static QHash<QString, QStringList> s_looseEntries;
+};
+
+#endif // RESOURCEPACK_H
@@ -35,11 +35,21 @@
 
 #include <QDebug>
 #include <QDir>
+#include <QTimer>
+#include <QStringList>
 
 
 Settings::Settings(const QString &file_name, Format format,
                    const Type &status, QObject *parent)
-  : QSettings(file_name, format, parent), m_initializationStatus(status) {
+  : QSettings(file_name, format, parent), m_initializationStatus(status),
+    m_values(QHash<QString, QHash<QString, QVariant> >()),
+    m_pendingValues(QHash<QString, QHash<QString, QVariant> >()), m_writeTimer(new QTimer(this)) {
+  m_writeTimer->setSingleShot(true);
+  m_writeTimer->setInterval(SETTINGS_WRITE_DELAY);
+
+  connect(m_writeTimer, SIGNAL(timeout()), this, SLOT(writePendingValues()));
+
+  loadValues();
 }
 
 Settings::~Settings() {
@@ -47,13 +57,86 @@ Settings::~Settings() {
   qDebug("Deleting Settings instance.");
 }
 
+QVariant Settings::value(const QString &section, const QString &key, const QVariant &default_value) const {
+  QReadLocker locker(&m_lock);
+  QHash<QString, QHash<QString, QVariant> >::const_iterator section_values = m_values.constFind(section);
+
+  if (section_values != m_values.constEnd()) {
+    QHash<QString, QVariant>::const_iterator found_value = section_values.value().constFind(key);
+
+    if (found_value != section_values.value().constEnd()) {
+      return found_value.value();
+    }
+  }
+
+  return default_value;
+}
+
+void Settings::setValue(const QString &section, const QString &key, const QVariant &value) {
+  QWriteLocker locker(&m_lock);
+  QHash<QString, QVariant> &section_values = m_values[section];
+
+  if (section_values.contains(key) && section_values.value(key) == value) {
+    // Value did not change, nothing to write.
+    return;
+  }
+
+  section_values.insert(key, value);
+  m_pendingValues[section].insert(key, value);
+  locker.unlock();
+
+  // Timer lives in thread of settings, so restart it from there.
+  QMetaObject::invokeMethod(m_writeTimer, "start");
+
+  emit valueChanged(section, key, value);
+}
+
+void Settings::writePendingValues() {
+  QWriteLocker locker(&m_lock);
+
+  if (m_pendingValues.isEmpty()) {
+    return;
+  }
+
+  QHash<QString, QHash<QString, QVariant> > pending_values = m_pendingValues;
+  m_pendingValues.clear();
+  locker.unlock();
+
+  for (QHash<QString, QHash<QString, QVariant> >::const_iterator section = pending_values.constBegin();
+       section != pending_values.constEnd(); ++section) {
+    for (QHash<QString, QVariant>::const_iterator key = section.value().constBegin();
+         key != section.value().constEnd(); ++key) {
+      QSettings::setValue(QString("%1/%2").arg(section.key(), key.key()), key.value());
+    }
+  }
+
+  sync();
+}
+
 QSettings::Status Settings::checkSettings() {
   qDebug("Syncing settings.");
 
+  m_writeTimer->stop();
+  writePendingValues();
   sync();
   return status();
 }
 
+void Settings::loadValues() {
+  QWriteLocker locker(&m_lock);
+
+  m_values.clear();
+
+  foreach (const QString &full_key, allKeys()) {
+    int separator = full_key.indexOf('/');
+
+    // Keys of settings are always stored in "section/key" form.
+    if (separator > 0) {
+      m_values[full_key.left(separator)].insert(full_key.mid(separator + 1), QSettings::value(full_key));
+    }
+  }
+}
+
 Settings* Settings::setupSettings(QObject *parent) {
   Settings *new_settings;
 
@@ -34,9 +34,17 @@
 #include <QSettings>
 
 #include <QPointer>
+#include <QHash>
+#include <QReadWriteLock>
 
 
+class QTimer;
+
 /// \brief Application-wide settings mechanism.
+///
+/// All values are read from settings file once and kept in memory, reading
+/// them is cheap and thread-safe. New values are written to the file
+/// in batches, after SETTINGS_WRITE_DELAY milliseconds without further change.
 class Settings : public QSettings {
     Q_OBJECT
 
@@ -61,21 +69,19 @@ class Settings : public QSettings {
     /// \param key Key of setting.
     /// \param default_value Default value to be used if no value exists for given key.
     /// \return Returns found value, default value or empty variant value.
-    inline QVariant value(const QString &section,
-                          const QString &key,
-                          const QVariant &default_value = QVariant()) {
-      return QSettings::value(QString("%1/%2").arg(section, key), default_value);
-    }
+    QVariant value(const QString &section,
+                   const QString &key,
+                   const QVariant &default_value = QVariant()) const;
 
     /// \brief Sets new value into settings.
     /// \param section Section in the settings.
     /// \param key Key.
     /// \param value New value.
-    inline void setValue(const QString &section,
-                         const QString &key,
-                         const QVariant &value) {
-      QSettings::setValue(QString("%1/%2").arg(section, key), value);
-    }
+    /// \note Value is written to settings file later, valueChanged() is emitted
+    /// right away if value really changes.
+    void setValue(const QString &section,
+                  const QString &key,
+                  const QVariant &value);
 
     /// \brief Synchronizes settings.
     /// \return Returns state of settings.
@@ -86,12 +92,32 @@ class Settings : public QSettings {
     /// \return Returns pointer to new settings.
     static Settings *setupSettings(QObject *parent);
 
+  public slots:
+    /// \brief Writes all pending changes into settings file.
+    void writePendingValues();
+
+  signals:
+    /// \brief Emitted when value of some setting changes.
+    /// \param section Section in the settings.
+    /// \param key Key.
+    /// \param value New value.
+    void valueChanged(const QString &section, const QString &key, const QVariant &value);
+
   private:
     // Constructor.
     Settings(const QString & file_name, Format format,
              const Type &type, QObject * parent = 0);
 
+    // Loads all values from settings file into the cache.
+    void loadValues();
+
     Type m_initializationStatus;
+
+    // Values indexed by section and key.
+    QHash<QString, QHash<QString, QVariant> > m_values;
+    QHash<QString, QHash<QString, QVariant> > m_pendingValues;
+    mutable QReadWriteLock m_lock;
+    QTimer *m_writeTimer;
 };
 
 #endif // SETTINGS_H
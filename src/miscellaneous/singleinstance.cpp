@@ -0,0 +1,174 @@
+/*
+  Copyright (c) 2012, BuildmLearn Contributors listed at http://buildmlearn.org/people/
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+
+  * Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+
+  * Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+
+  * Neither the name of the BuildmLearn nor the names of its
+    contributors may be used to endorse or promote products derived from
+    this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "miscellaneous/singleinstance.h"
+
+#include "definitions/definitions.h"
+
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QDataStream>
+#include <QFileInfo>
+#include <QDir>
+
+
+SingleInstance::SingleInstance(QObject *parent)
+  : QObject(parent), m_server(NULL) {
+}
+
+SingleInstance::~SingleInstance() {
+  qDebug("Destroying SingleInstance instance.");
+}
+
+bool SingleInstance::sendMessage(const QString &command, const QStringList &arguments) {
+  QLocalSocket socket;
+
+  socket.connectToServer(serverName());
+
+  if (!socket.waitForConnected(SINGLE_INSTANCE_TIMEOUT)) {
+    // No instance is running.
+    return false;
+  }
+
+  // Running instance has other working directory.
+  QStringList absolute_arguments;
+
+  foreach (const QString &argument, arguments) {
+    QFileInfo file_info(argument);
+    absolute_arguments << (!argument.startsWith('-') && file_info.exists() ? file_info.absoluteFilePath() : argument);
+  }
+
+  QByteArray message;
+  QDataStream stream(&message, QIODevice::WriteOnly);
+
+  stream << (quint32) 0 << command << absolute_arguments;
+  stream.device()->seek(0);
+  stream << (quint32) (message.size() - sizeof(quint32));
+
+  socket.write(message);
+
+  bool delivered = socket.waitForBytesWritten(SINGLE_INSTANCE_TIMEOUT);
+
+  socket.disconnectFromServer();
+
+  if (delivered) {
+    qDebug("Message '%s' was delivered to running instance.", qPrintable(command));
+  }
+
+  return delivered;
+}
+
+bool SingleInstance::listen() {
+  if (m_server != NULL) {
+    return m_server->isListening();
+  }
+
+  m_server = new QLocalServer(this);
+  connect(m_server, SIGNAL(newConnection()), this, SLOT(onNewConnection()));
+
+  if (!m_server->listen(serverName())) {
+    if (isServerRunning()) {
+      // Other instance was started right after this one checked for it.
+      qWarning("Other instance is already listening on '%s'.", qPrintable(serverName()));
+      return false;
+    }
+
+    // Socket is left behind by crashed instance, nobody answered on it,
+    // so it can be removed.
+    QLocalServer::removeServer(serverName());
+
+    if (!m_server->listen(serverName())) {
+      qWarning("Cannot listen for other instances: '%s'.", qPrintable(m_server->errorString()));
+      return false;
+    }
+  }
+
+  qDebug("Listening for other instances on '%s'.", qPrintable(m_server->fullServerName()));
+  return true;
+}
+
+bool SingleInstance::isServerRunning() {
+  QLocalSocket socket;
+
+  socket.connectToServer(serverName());
+
+  if (!socket.waitForConnected(SINGLE_INSTANCE_TIMEOUT)) {
+    return false;
+  }
+
+  socket.disconnectFromServer();
+  return true;
+}
+
+QString SingleInstance::serverName() {
+  return QString("%1-%2").arg(APP_LOW_NAME, QString::number(qHash(QDir::homePath())));
+}
+
+void SingleInstance::onNewConnection() {
+  while (m_server->hasPendingConnections()) {
+    QLocalSocket *socket = m_server->nextPendingConnection();
+
+    connect(socket, SIGNAL(readyRead()), this, SLOT(onReadyRead()));
+    connect(socket, SIGNAL(disconnected()), socket, SLOT(deleteLater()));
+
+    // Message may have arrived already.
+    if (socket->bytesAvailable() > 0) {
+      QMetaObject::invokeMethod(this, "onReadyRead", Qt::QueuedConnection);
+    }
+  }
+}
+
+void SingleInstance::onReadyRead() {
+  foreach (QLocalSocket *socket, m_server->findChildren<QLocalSocket*>()) {
+    if (socket->bytesAvailable() < (qint64) sizeof(quint32)) {
+      continue;
+    }
+
+    QByteArray header = socket->peek(sizeof(quint32));
+    QDataStream header_stream(header);
+    quint32 size;
+
+    header_stream >> size;
+
+    if (socket->bytesAvailable() < (qint64) (sizeof(quint32) + size)) {
+      // Rest of message comes later.
+      continue;
+    }
+
+    QDataStream stream(socket);
+    QString command;
+    QStringList arguments;
+
+    stream >> size >> command >> arguments;
+    qDebug("Received message '%s' from other instance.", qPrintable(command));
+
+    emit messageReceived(command, arguments);
+  }
+}
@@ -0,0 +1,88 @@
+/*
+  Copyright (c) 2012, BuildmLearn Contributors listed at http://buildmlearn.org/people/
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+
+  * Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+
+  * Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+
+  * Neither the name of the BuildmLearn nor the names of its
+    contributors may be used to endorse or promote products derived from
+    this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef SINGLEINSTANCE_H
+#define SINGLEINSTANCE_H
+
+#include <QObject>
+
+#include <QStringList>
+
+
+class QLocalServer;
+
+/// \brief Detects running instance of the application and talks to it.
+///
+/// First instance listens on local socket. Other launches send
+/// their command and arguments to it and quit immediately.
+///
+/// Message is QDataStream with command (APP_IS_RUNNING, APP_QUIT_INSTANCE
+/// or APP_GENERATE_BUNDLE) and list of arguments, prefixed by its size.
+class SingleInstance : public QObject {
+    Q_OBJECT
+
+  public:
+    // Constructors and destructors.
+    explicit SingleInstance(QObject *parent = 0);
+    virtual ~SingleInstance();
+
+    /// \brief Sends command to running instance.
+    /// \param command Command, APP_IS_RUNNING, APP_QUIT_INSTANCE or APP_GENERATE_BUNDLE.
+    /// \param arguments Arguments of this launch, paths to existing files
+    /// are made absolute.
+    /// \return Returns true if running instance received the message.
+    bool sendMessage(const QString &command, const QStringList &arguments);
+
+    /// \brief Starts listening for messages from other launches.
+    /// \return Returns true if listening was started, returns false
+    /// if other instance started listening in the meantime.
+    bool listen();
+
+    /// \brief Name of local socket, unique for each user.
+    static QString serverName();
+
+  signals:
+    /// \brief Emitted when other launch sends a message.
+    /// \param command Command.
+    /// \param arguments Arguments of other launch.
+    void messageReceived(const QString &command, const QStringList &arguments);
+
+  private slots:
+    void onNewConnection();
+    void onReadyRead();
+
+  private:
+    // Returns true if some instance accepts connections on local socket.
+    static bool isServerRunning();
+
+    QLocalServer *m_server;
+};
+
+#endif // SINGLEINSTANCE_H
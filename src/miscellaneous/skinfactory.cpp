@@ -33,14 +33,22 @@
 #include "definitions/definitions.h"
 #include "miscellaneous/settings.h"
 #include "miscellaneous/application.h"
+#include "miscellaneous/resourcepack.h"
+#include "miscellaneous/performancemonitor.h"
 
 #include <QDir>
 #include <QStyleFactory>
 #include <QDomDocument>
 #include <QDomElement>
+#include <QFile>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QDataStream>
 
 
-SkinFactory::SkinFactory(QObject *parent) : QObject(parent) {
+SkinFactory::SkinFactory(QObject *parent)
+  : QObject(parent), m_currentSkin(Skin()), m_index(QHash<QString, IndexEntry>()), m_indexLoaded(false),
+    m_indexDirty(false) {
 }
 
 SkinFactory::~SkinFactory() {
@@ -48,6 +56,8 @@ SkinFactory::~SkinFactory() {
 }
 
 void SkinFactory::loadCurrentSkin() {
+  PERF_SCOPE("skin.load");
+
   QString skin_name_from_settings = selectedSkinName();
   bool skin_parsed;
   Skin skin_data = skinInfo(skin_name_from_settings, &skin_parsed);
@@ -74,21 +84,9 @@ void SkinFactory::loadCurrentSkin() {
 bool SkinFactory::loadSkinFromData(const Skin &skin) {
   qDebug("Loading skin '%s'.", qPrintable(skin.m_baseName));
 
-  // Here we use "/" instead of QDir::separator() because CSS2.1 url field
-  // accepts '/' as path elements separator.
-  //
-  // "##" is placeholder for the actual path to skin file. This is needed for using
-  // images within the QSS file.
-  // So if one uses "##/images/border.png" in QSS then it is
-  // replaced by fully absolute path and target file can
-  // be safely loaded.
-  QString raw_data = skin.m_rawData;
-
-  if (!raw_data.isEmpty()) {
-    QString parsed_data = raw_data.replace("##",
-                                           APP_SKIN_PATH + '/' +
-                                           skin.m_baseFolder);
-    qApp->setStyleSheet(parsed_data);
+  // Style sheet is expanded when skin file is parsed.
+  if (!skin.m_styleSheet.isEmpty()) {
+    qApp->setStyleSheet(skin.m_styleSheet);
   }
 
   // Iterate supported styles and load one.
@@ -114,9 +112,62 @@ QString SkinFactory::selectedSkinName() {
 }
 
 Skin SkinFactory::skinInfo(const QString &skin_name, bool *ok) {
+  Skin skin = indexedSkinInfo(skin_name, ok);
+
+  saveIndex();
+  return skin;
+}
+
+Skin SkinFactory::indexedSkinInfo(const QString &skin_name, bool *ok) {
+  QString key = QString(skin_name).replace(QDir::separator(), '/');
+  QFileInfo skin_file_info(ResourcePack::filePath(ResourcePack::Skins, key));
+
+  if (!m_indexLoaded) {
+    loadIndex();
+  }
+
+  if (m_index.contains(key)) {
+    const IndexEntry &entry = m_index[key];
+
+    if (entry.m_modified == skin_file_info.lastModified().toMSecsSinceEpoch() &&
+        entry.m_size == skin_file_info.size()) {
+      // Skin file did not change since it was indexed.
+      if (ok) {
+        *ok = entry.m_valid;
+      }
+
+      return entry.m_skin;
+    }
+  }
+
+  if (!skin_file_info.exists()) {
+    if (ok) {
+      *ok = false;
+    }
+
+    return Skin();
+  }
+
+  IndexEntry entry;
+
+  entry.m_modified = skin_file_info.lastModified().toMSecsSinceEpoch();
+  entry.m_size = skin_file_info.size();
+  entry.m_skin = parseSkin(skin_file_info.filePath(), &entry.m_valid);
+
+  m_index.insert(key, entry);
+  m_indexDirty = true;
+
+  if (ok) {
+    *ok = entry.m_valid;
+  }
+
+  return entry.m_skin;
+}
+
+Skin SkinFactory::parseSkin(const QString &skin_path, bool *ok) {
   Skin skin;
   QString styles;
-  QFile skin_file(APP_SKIN_PATH + QDir::separator() + skin_name);
+  QFile skin_file(skin_path);
   QDomDocument dokument;
 
   if (!skin_file.open(QIODevice::Text | QIODevice::ReadOnly) || !dokument.setContent(&skin_file, true)) {
@@ -150,19 +201,33 @@ Skin SkinFactory::skinInfo(const QString &skin_name, bool *ok) {
   skin.m_version = skin_node.attributes().namedItem("version").toAttr().value();
 
   // Obtain other information.
-  skin.m_baseName = QString(skin_name).replace(QDir::separator(), '/');
-  skin.m_baseFolder = skin.m_baseName.split('/', QString::SkipEmptyParts).at(0);
+  QFileInfo skin_file_info(skin_path);
+  QString skin_directory = skin_file_info.path();
+
+  skin.m_baseFolder = skin_file_info.dir().dirName();
+  skin.m_baseName = skin.m_baseFolder + '/' + skin_file_info.fileName();
 
   // Obtain simulator image.
   QString simulator_image = skin_node.namedItem("simulator").
                             namedItem("main").toElement().text();
 
-  skin.m_simulatorBackgroundMain = APP_SKIN_PATH + '/' + skin.m_baseFolder + '/' + simulator_image;
+  skin.m_simulatorBackgroundMain = skin_directory + '/' + simulator_image;
   skin.m_simulatorBackgroundMain = skin.m_simulatorBackgroundMain.replace('\\', '/');
 
   skin.m_simulatorStyle = skin_node.namedItem("simulator").namedItem("style").toElement().text();
   skin.m_simulatorStyle = QByteArray::fromBase64(skin.m_simulatorStyle.toLocal8Bit());
 
+  // Here we use "/" instead of QDir::separator() because CSS2.1 url field
+  // accepts '/' as path elements separator.
+  //
+  // "##" is placeholder for the actual path to skin file. This is needed for using
+  // images within the QSS file.
+  // So if one uses "##/images/border.png" in QSS then it is
+  // replaced by fully absolute path and target file can
+  // be safely loaded.
+  // Skins from resource pack use ":/" paths which are understood by style sheets too.
+  skin.m_styleSheet = QString(skin.m_rawData).replace("##", QString(skin_directory).replace('\\', '/'));
+
   // Free resources.
   skin_file.close();
   skin_file.deleteLater();
@@ -178,20 +243,22 @@ Skin SkinFactory::skinInfo(const QString &skin_name, bool *ok) {
 QList<Skin> SkinFactory::installedSkins() {
   QList<Skin> skins;
   bool skin_load_ok;
-  QStringList skin_directories = QDir(APP_SKIN_PATH).entryList(QDir::Dirs |
-                                                               QDir::NoDotAndDotDot |
-                                                               QDir::NoSymLinks |
-                                                               QDir::Readable);
+
+  // Loose skin files may have been added or removed since the last scan.
+  ResourcePack::invalidate();
+  QStringList skin_directories = ResourcePack::entryList(ResourcePack::Skins, QString(), QStringList(),
+                                                        QDir::Dirs | QDir::NoDotAndDotDot |
+                                                        QDir::NoSymLinks | QDir::Readable);
 
   foreach (const QString &base_directory, skin_directories) {
     // Check skins installed in this base directory.
-    QStringList skin_files = QDir(APP_SKIN_PATH + QDir::separator() + base_directory).entryList(QStringList() << "*.xml",
-                                                                                                QDir::Files | QDir::Readable | QDir::NoDotAndDotDot | QDir::NoSymLinks);
+    QStringList skin_files = ResourcePack::entryList(ResourcePack::Skins, base_directory, QStringList() << "*.xml",
+                                                     QDir::Files | QDir::Readable | QDir::NoDotAndDotDot | QDir::NoSymLinks);
 
     foreach (const QString &skin_file, skin_files) {
       // Check if skin file is valid and add it if it is valid.
-      Skin skin_info = skinInfo(base_directory + QDir::separator() + skin_file,
-                                &skin_load_ok);
+      Skin skin_info = indexedSkinInfo(base_directory + '/' + skin_file,
+                                       &skin_load_ok);
 
       if (skin_load_ok) {
         skins.append(skin_info);
@@ -199,5 +266,82 @@ QList<Skin> SkinFactory::installedSkins() {
     }
   }
 
+  // Newly indexed skins are saved at once.
+  saveIndex();
   return skins;
 }
+
+void SkinFactory::loadIndex() {
+  QFile file(indexFile());
+
+  m_indexLoaded = true;
+  m_indexDirty = false;
+  m_index.clear();
+
+  if (!file.open(QIODevice::ReadOnly)) {
+    return;
+  }
+
+  QDataStream stream(&file);
+  quint32 version;
+  QString skin_path;
+  QString pack_signature;
+  qint32 count;
+
+  stream >> version >> skin_path >> pack_signature >> count;
+
+  if (version != SKIN_INDEX_VERSION || skin_path != APP_SKIN_PATH || pack_signature != ResourcePack::signature()) {
+    // Index is obsolete or it belongs to skins in other location.
+    qDebug("Skin index is obsolete, skins will be indexed again.");
+    return;
+  }
+
+  for (int i = 0; i < count && stream.status() == QDataStream::Ok; i++) {
+    QString key;
+    IndexEntry entry;
+    Skin &skin = entry.m_skin;
+
+    stream >> key >> entry.m_modified >> entry.m_size >> entry.m_valid >>
+              skin.m_baseName >> skin.m_baseFolder >> skin.m_visibleName >> skin.m_stylesNames >>
+              skin.m_author >> skin.m_email >> skin.m_version >> skin.m_rawData >> skin.m_styleSheet >>
+              skin.m_simulatorBackgroundMain >> skin.m_simulatorStyle;
+
+    if (stream.status() == QDataStream::Ok) {
+      m_index.insert(key, entry);
+    }
+  }
+}
+
+void SkinFactory::saveIndex() {
+  if (!m_indexDirty) {
+    return;
+  }
+
+  m_indexDirty = false;
+  QDir().mkpath(QFileInfo(indexFile()).absolutePath());
+
+  QFile file(indexFile());
+
+  if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+    qWarning("Skin index '%s' cannot be saved.", qPrintable(file.fileName()));
+    return;
+  }
+
+  QDataStream stream(&file);
+
+  stream << (quint32) SKIN_INDEX_VERSION << QString(APP_SKIN_PATH) << ResourcePack::signature() <<
+            (qint32) m_index.size();
+
+  for (QHash<QString, IndexEntry>::const_iterator it = m_index.constBegin(); it != m_index.constEnd(); ++it) {
+    const Skin &skin = it.value().m_skin;
+
+    stream << it.key() << it.value().m_modified << it.value().m_size << it.value().m_valid <<
+              skin.m_baseName << skin.m_baseFolder << skin.m_visibleName << skin.m_stylesNames <<
+              skin.m_author << skin.m_email << skin.m_version << skin.m_rawData << skin.m_styleSheet <<
+              skin.m_simulatorBackgroundMain << skin.m_simulatorStyle;
+  }
+}
+
+QString SkinFactory::indexFile() const {
+  return QFileInfo(qApp->settings()->fileName()).absolutePath() + QDir::separator() + SKIN_INDEX_FILE;
+}
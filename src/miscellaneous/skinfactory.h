@@ -35,6 +35,7 @@
 
 #include <QStringList>
 #include <QMetaType>
+#include <QHash>
 
 
 /// \brief Skin representation.
@@ -48,6 +49,9 @@ struct Skin {
     QString m_version;
     QString m_rawData;
 
+    // Style sheet with "##" placeholders replaced by path of the skin.
+    QString m_styleSheet;
+
     QString m_simulatorBackgroundMain;
     QString m_simulatorStyle;
 };
@@ -56,6 +60,9 @@ Q_DECLARE_METATYPE(Skin)
 
 ///
 /// \brief Main features for skinning.
+///
+/// Information about skins is kept in persistent index keyed by modification
+/// time and size of skin files, so skin files are parsed only when they change.
 class SkinFactory : public QObject {
     Q_OBJECT
 
@@ -94,9 +101,31 @@ class SkinFactory : public QObject {
     // Loads the skin from give skin_data.
     bool loadSkinFromData(const Skin &skin);
 
+    // Parses skin file.
+    Skin parseSkin(const QString &skin_path, bool *ok);
+
+    // Gets skin from index, skin file is parsed and indexed if it changed.
+    Skin indexedSkinInfo(const QString &skin_name, bool *ok);
+
+    // Loads and saves index of skins, index is saved only if it changed.
+    void loadIndex();
+    void saveIndex();
+    QString indexFile() const;
+
+    struct IndexEntry {
+        qint64 m_modified;
+        qint64 m_size;
+        bool m_valid;
+        Skin m_skin;
+    };
+
   private:
     // Holds name of the current skin.
     Skin m_currentSkin;
+
+    QHash<QString, IndexEntry> m_index;
+    bool m_indexLoaded;
+    bool m_indexDirty;
 };
 
 #endif // SKINFACTORY_H
@@ -0,0 +1,234 @@
+/*
+  Copyright (c) 2012, BuildmLearn Contributors listed at http://buildmlearn.org/people/
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+
+  * Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+
+  * Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+
+  * Neither the name of the BuildmLearn nor the names of its
+    contributors may be used to endorse or promote products derived from
+    this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "miscellaneous/startupprofiler.h"
+
+#include "definitions/definitions.h"
+#include "miscellaneous/application.h"
+#include "miscellaneous/performancemonitor.h"
+
+#include <QWidget>
+#include <QEvent>
+#include <QProcess>
+#include <QFile>
+#include <QTextStream>
+#include <QDateTime>
+
+
+QElapsedTimer StartupProfiler::s_timer;
+QList<StartupProfiler::Phase> StartupProfiler::s_phases;
+bool StartupProfiler::s_finished = false;
+
+StartupProfiler::StartupProfiler(QObject *parent) : QObject(parent) {
+}
+
+StartupProfiler::~StartupProfiler() {
+}
+
+void StartupProfiler::start() {
+  s_timer.start();
+  s_phases.clear();
+  s_finished = false;
+}
+
+void StartupProfiler::mark(const QString &phase) {
+  if (!s_timer.isValid() || s_finished) {
+    return;
+  }
+
+  Phase new_phase;
+
+  // Times are stored in microseconds.
+  new_phase.m_name = phase;
+  new_phase.m_elapsed = s_timer.nsecsElapsed() / 1000;
+  new_phase.m_duration = new_phase.m_elapsed - (s_phases.isEmpty() ? 0 : s_phases.last().m_elapsed);
+
+  s_phases.append(new_phase);
+}
+
+void StartupProfiler::finishOnFirstPaint(QWidget *widget) {
+  widget->installEventFilter(new StartupProfiler(widget));
+}
+
+bool StartupProfiler::exitsAfterStartup(int argc, char *argv[]) {
+  for (int i = 1; i < argc; i++) {
+    if (qstrcmp(argv[i], APP_ARG_STARTUP_EXIT) == 0) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+int StartupProfiler::runBenchmark(const QStringList &arguments) {
+  int benchmark_index = arguments.indexOf(APP_ARG_STARTUP_BENCHMARK);
+  int budget_index = arguments.indexOf(APP_ARG_STARTUP_BUDGET);
+  int launches = qMax(arguments.value(benchmark_index + 1).toInt(), 0);
+  qint64 budget = budget_index >= 0 ? arguments.value(budget_index + 1).toLongLong() : 0;
+  QList<qint64> times;
+  QTextStream report(stdout);
+
+  if (launches == 0) {
+    launches = STARTUP_BENCHMARK_LAUNCHES;
+  }
+
+  for (int i = 0; i < launches; i++) {
+    QProcess process;
+
+    // Standard output of measured launch contains only its result.
+    process.start(Application::applicationFilePath(), QStringList() << APP_ARG_STARTUP_EXIT);
+
+    if (!process.waitForFinished(STARTUP_BENCHMARK_TIMEOUT)) {
+      process.kill();
+      process.waitForFinished();
+
+      qWarning("Launch %d of startup benchmark did not finish in time.", i + 1);
+      return EXIT_FAILURE;
+    }
+
+    QString output = QString::fromLocal8Bit(process.readAllStandardOutput());
+    int result_index = output.indexOf("startup_total_ms=");
+
+    if (result_index < 0) {
+      qWarning("Launch %d of startup benchmark did not report its startup time.", i + 1);
+      return EXIT_FAILURE;
+    }
+
+    times.append(output.mid(result_index + 17).section('\n', 0, 0).trimmed().toLongLong());
+    report << "launch=" << (i + 1) << " startup_ms=" << times.last() << '\n';
+    report.flush();
+  }
+
+  // First launch is reported separately, it is cold only if system caches
+  // were dropped before the benchmark. Other launches are warm.
+  qint64 first_time = times.first();
+  QList<qint64> warm_times = times.mid(1);
+
+  report << "first_ms=" << first_time;
+
+  if (!warm_times.isEmpty()) {
+    qSort(warm_times);
+    report << " warm_min_ms=" << warm_times.first() << " warm_median_ms=" <<
+              warm_times.at(warm_times.size() / 2) << " warm_max_ms=" << warm_times.last();
+  }
+
+  report << '\n';
+  report.flush();
+
+  if (budget > 0 && (warm_times.isEmpty() ? first_time : warm_times.at(warm_times.size() / 2)) > budget) {
+    qWarning("Startup takes longer than budget of %lld ms.", budget);
+    return EXIT_FAILURE;
+  }
+  else {
+    return EXIT_SUCCESS;
+  }
+}
+
+bool StartupProfiler::eventFilter(QObject *watched, QEvent *event) {
+  if (event->type() == QEvent::Paint) {
+    watched->removeEventFilter(this);
+    deleteLater();
+
+    mark("first paint");
+    finish();
+  }
+
+  return false;
+}
+
+void StartupProfiler::finish() {
+  if (s_finished || s_phases.isEmpty()) {
+    return;
+  }
+
+  s_finished = true;
+
+  qint64 total_time = s_phases.last().m_elapsed;
+
+  foreach (const Phase &phase, s_phases) {
+    qDebug("Startup phase '%s' took %.1f ms (%.1f ms since start).",
+           qPrintable(phase.m_name), phase.m_duration / 1000.0, phase.m_elapsed / 1000.0);
+  }
+
+  qDebug("Startup took %.1f ms.", total_time / 1000.0);
+
+  QStringList arguments = Application::arguments();
+  int profile_index = arguments.indexOf(APP_ARG_STARTUP_PROFILE);
+
+  if (profile_index >= 0 && !arguments.value(profile_index + 1).isEmpty()) {
+    writeJsonReport(arguments.value(profile_index + 1), total_time);
+  }
+
+  if (arguments.contains(APP_ARG_STARTUP_EXIT)) {
+    int budget_index = arguments.indexOf(APP_ARG_STARTUP_BUDGET);
+    qint64 budget = budget_index >= 0 ? arguments.value(budget_index + 1).toLongLong() : 0;
+    bool over_budget = budget > 0 && total_time / 1000 > budget;
+
+    QTextStream result(stdout);
+
+    result << "startup_total_ms=" << total_time / 1000 << '\n';
+    result.flush();
+
+    if (over_budget) {
+      qWarning("Startup took longer than budget of %lld ms.", budget);
+    }
+
+    Application::exit(over_budget ? EXIT_FAILURE : EXIT_SUCCESS);
+  }
+}
+
+void StartupProfiler::writeJsonReport(const QString &file_name, qint64 total_time) {
+  QFile report_file(file_name);
+
+  if (!report_file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text)) {
+    qWarning("Startup report file '%s' cannot be opened for writing.", qPrintable(file_name));
+    return;
+  }
+
+  QTextStream report(&report_file);
+
+  report.setCodec("UTF-8");
+  report << "{\n  \"version\": \"" << APP_VERSION << "\",\n";
+  report << "  \"date\": \"" << QDateTime::currentDateTime().toString(Qt::ISODate) << "\",\n";
+  report << "  \"total_ms\": " << QString::number(total_time / 1000.0, 'f', 3) << ",\n";
+  report << "  \"phases\": [\n";
+
+  for (int i = 0; i < s_phases.size(); i++) {
+    const Phase &phase = s_phases.at(i);
+
+    report << "    {\"name\": \"" << PerformanceMonitor::escapeJson(phase.m_name) << "\", \"duration_ms\": " <<
+              QString::number(phase.m_duration / 1000.0, 'f', 3) << ", \"elapsed_ms\": " <<
+              QString::number(phase.m_elapsed / 1000.0, 'f', 3) << '}' <<
+              (i < s_phases.size() - 1 ? ",\n" : "\n");
+  }
+
+  report << "  ]\n}\n";
+  report.flush();
+}
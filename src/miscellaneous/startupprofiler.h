@@ -0,0 +1,107 @@
+/*
+  Copyright (c) 2012, BuildmLearn Contributors listed at http://buildmlearn.org/people/
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+
+  * Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+
+  * Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+
+  * Neither the name of the BuildmLearn nor the names of its
+    contributors may be used to endorse or promote products derived from
+    this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef STARTUPPROFILER_H
+#define STARTUPPROFILER_H
+
+#include <QObject>
+
+#include <QElapsedTimer>
+#include <QStringList>
+#include <QList>
+
+
+class QWidget;
+
+/// \brief Measures phases of application startup.
+///
+/// Phases are timestamped from the start of main() to the first paint
+/// of main window. Results are always written to the log, JSON report
+/// is written if APP_ARG_STARTUP_PROFILE is given.
+///
+/// With APP_ARG_STARTUP_EXIT, application quits right after the first paint
+/// and fails if startup takes longer than APP_ARG_STARTUP_BUDGET milliseconds.
+/// With APP_ARG_STARTUP_BENCHMARK, application repeatedly launches itself
+/// this way and reports time of the first launch and times of the following
+/// warm launches. The first launch is cold only if file system caches are dropped
+/// right before the benchmark, on Linux for example with
+/// "sync; echo 3 > /proc/sys/vm/drop_caches" run as root.
+class StartupProfiler : public QObject {
+    Q_OBJECT
+
+  public:
+    virtual ~StartupProfiler();
+
+    /// \brief Starts measuring, call this as the first thing in main().
+    static void start();
+
+    /// \brief Marks end of startup phase.
+    /// \param phase Name of finished phase.
+    static void mark(const QString &phase);
+
+    /// \brief Finishes measuring when given widget is painted for the first time.
+    /// \param widget Main window.
+    static void finishOnFirstPaint(QWidget *widget);
+
+    /// \brief Indication of benchmark launch.
+    /// \param argc Number of arguments passed to the program.
+    /// \param argv Array of strings passed to the program.
+    /// \return Returns true if application only measures its startup and quits.
+    static bool exitsAfterStartup(int argc, char *argv[]);
+
+    /// \brief Launches application repeatedly and reports its startup times.
+    /// \param arguments Arguments of application, they must contain
+    /// APP_ARG_STARTUP_BENCHMARK optionally followed by number of launches.
+    /// \return Returns EXIT_SUCCESS if all launches fit into startup budget.
+    static int runBenchmark(const QStringList &arguments);
+
+  protected:
+    bool eventFilter(QObject *watched, QEvent *event);
+
+  private:
+    // Constructor.
+    explicit StartupProfiler(QObject *parent = 0);
+
+    // Reports all phases.
+    static void finish();
+    static void writeJsonReport(const QString &file_name, qint64 total_time);
+
+    struct Phase {
+        QString m_name;
+        qint64 m_duration;
+        qint64 m_elapsed;
+    };
+
+    static QElapsedTimer s_timer;
+    static QList<Phase> s_phases;
+    static bool s_finished;
+};
+
+#endif // STARTUPPROFILER_H
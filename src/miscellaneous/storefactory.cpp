@@ -31,9 +31,12 @@
 #include "miscellaneous/storefactory.h"
 
 #include "definitions/definitions.h"
+#include "miscellaneous/application.h"
 
 #include <QDomDocument>
 #include <QDomElement>
+#include <QTextStream>
+#include <QCryptographicHash>
 
 
 StoreFactory::StoreFactory(QObject *parent) : QObject(parent) {
@@ -42,6 +45,10 @@ StoreFactory::StoreFactory(QObject *parent) : QObject(parent) {
 StoreFactory::~StoreFactory() {
 }
 
+QString StoreFactory::endpointDiscoveryUrl() {
+  return qApp->settings()->value(APP_CFG_GEN, "store_endpoint", STORE_ENDPOINT).toString();
+}
+
 QString StoreFactory::uploadStatusToString(StoreFactory::UploadStatus status) {
   switch (status) {
     case Success:
@@ -56,6 +63,12 @@ QString StoreFactory::uploadStatusToString(StoreFactory::UploadStatus status) {
     case FileTooBig:
       return tr("Application file is too big.");
 
+    case PartiallyUploaded:
+      return tr("Application is partially uploaded.");
+
+    case ChecksumMismatch:
+      return tr("Uploaded data were corrupted.");
+
     default:
       return tr("Unknown status.");
   }
@@ -80,6 +93,12 @@ StoreFactory::UploadStatus StoreFactory::parseResponseXml(QNetworkReply::Network
       else if (status == STORE_ANSWER_NO_PARAMETERS) {
         return MissingParameters;
       }
+      else if (status == STORE_ANSWER_PARTIAL) {
+        return PartiallyUploaded;
+      }
+      else if (status == STORE_ANSWER_CHECKSUM_MISMATCH) {
+        return ChecksumMismatch;
+      }
       else {
         return OtherError;
       }
@@ -89,3 +108,76 @@ StoreFactory::UploadStatus StoreFactory::parseResponseXml(QNetworkReply::Network
       return NetworkError;
   }
 }
+
+qint64 StoreFactory::parseUploadOffset(const QByteArray &response) {
+  QDomDocument xml_response;
+  xml_response.setContent(QString(response));
+
+  bool ok;
+  qint64 offset = xml_response.documentElement().namedItem("offset").toElement().text().toLongLong(&ok);
+
+  return ok ? offset : -1;
+}
+
+QSet<QString> StoreFactory::parseMissingItems(const QByteArray &response) {
+  QDomDocument xml_response;
+  xml_response.setContent(QString(response));
+
+  QDomNodeList hashes = xml_response.documentElement().namedItem("missing").toElement().elementsByTagName("hash");
+  QSet<QString> missing_hashes;
+
+  for (int i = 0; i < hashes.size(); i++) {
+    missing_hashes.insert(hashes.at(i).toElement().text());
+  }
+
+  return missing_hashes;
+}
+
+QStringList StoreFactory::bundleItemHashes(const QDomDocument &bundle_document) {
+  QDomNodeList items = bundle_document.documentElement().elementsByTagName("item");
+  QStringList hashes;
+
+  for (int i = 0; i < items.size(); i++) {
+    hashes.append(itemHash(items.at(i).toElement()));
+  }
+
+  return hashes;
+}
+
+QString StoreFactory::createDeltaBundle(QDomDocument &bundle_document, const QStringList &item_hashes,
+                                       const QSet<QString> &missing_hashes) {
+  QDomNodeList items = bundle_document.documentElement().elementsByTagName("item");
+
+  if (items.size() != item_hashes.size()) {
+    qWarning("Hashes do not match items of delta bundle.");
+    return QString();
+  }
+
+  for (int i = 0; i < items.size(); i++) {
+    QDomElement item = items.at(i).toElement();
+    const QString &hash = item_hashes.at(i);
+
+    if (!missing_hashes.contains(hash)) {
+      // Store has this item, only reference to it is sent.
+      while (item.hasChildNodes()) {
+        item.removeChild(item.firstChild());
+      }
+    }
+
+    item.setAttribute("hash", hash);
+  }
+
+  return bundle_document.toString(XML_BUNDLE_INDENTATION);
+}
+
+QString StoreFactory::itemHash(const QDomElement &item) {
+  QString item_data;
+  QTextStream stream(&item_data);
+
+  // Item is serialized without any whitespace, so that hash
+  // does not depend on formatting of the bundle.
+  item.save(stream, -1);
+  stream.flush();
+
+  return QString(QCryptographicHash::hash(item_data.toUtf8(), QCryptographicHash::Sha1).toHex());
+}
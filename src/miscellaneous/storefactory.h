@@ -34,6 +34,10 @@
 #include <QObject>
 
 #include <QNetworkReply>
+#include <QStringList>
+#include <QSet>
+#include <QDomDocument>
+#include <QDomElement>
 
 
 /// \brief Main BuildmLearn Store functionality.
@@ -48,7 +52,11 @@ class StoreFactory : public QObject {
       MissingParameters,
       InvalidKey,
       FileTooBig,
-      OtherError
+      OtherError,
+      // Part of application was accepted, upload continues.
+      PartiallyUploaded,
+      // Uploaded part of application was corrupted.
+      ChecksumMismatch
     };
 
     virtual ~StoreFactory();
@@ -58,6 +66,11 @@ class StoreFactory : public QObject {
     /// \return Returns textual representation of application upload process status.
     static QString uploadStatusToString(UploadStatus status);
 
+    /// \brief Access to URL which tells actual upload endpoint of BuildmLearn Store.
+    /// \return Returns STORE_ENDPOINT unless other (for example local
+    /// stand-in) server is configured in settings.
+    static QString endpointDiscoveryUrl();
+
     /// \brief Parses received XML from BuildmLearn Store server.
     /// \param error_status Network status of connection to BuildmLearn Store server.
     /// \param response XML received from BuildmLearn Store server.
@@ -65,8 +78,40 @@ class StoreFactory : public QObject {
     static UploadStatus parseResponseXml(QNetworkReply::NetworkError error_status,
                                          const QByteArray &response);
 
+    /// \brief Parses number of bytes already stored by BuildmLearn Store server.
+    /// \param response XML received from BuildmLearn Store server.
+    /// \return Returns number of stored bytes of chunked upload or -1
+    /// if response does not contain it.
+    static qint64 parseUploadOffset(const QByteArray &response);
+
+    /// \brief Parses hashes of bundle items which BuildmLearn Store server does not have yet.
+    /// \param response XML received from BuildmLearn Store server.
+    /// \return Returns set of hashes of missing items.
+    static QSet<QString> parseMissingItems(const QByteArray &response);
+
+    /// \brief Computes content hashes of all items of given bundle.
+    /// \param bundle_document Parsed XML bundle.
+    /// \return Returns hex SHA-1 hashes of items in the order of items.
+    static QStringList bundleItemHashes(const QDomDocument &bundle_document);
+
+    /// \brief Creates delta bundle which contains only given items.
+    ///
+    /// All items get "hash" attribute with their content hash. Items which
+    /// are not listed as missing are left empty, they only reference content
+    /// which BuildmLearn Store server already has. Thus, delta bundle also
+    /// serves as manifest of the new bundle.
+    /// \param bundle_document Parsed XML bundle, it is modified in place.
+    /// \param item_hashes Hashes of items as returned by bundleItemHashes().
+    /// \param missing_hashes Hashes of items which are sent with contents.
+    /// \return Returns delta bundle or empty string if hashes do not match items.
+    static QString createDeltaBundle(QDomDocument &bundle_document, const QStringList &item_hashes,
+                                     const QSet<QString> &missing_hashes);
+
   private:
     explicit StoreFactory(QObject *parent = 0);
+
+    // Computes content hash of single bundle item.
+    static QString itemHash(const QDomElement &item);
 };
 
 #endif // STOREFACTORY_H
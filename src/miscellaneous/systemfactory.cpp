@@ -32,6 +32,7 @@
 
 #include "definitions/definitions.h"
 #include "network-web/networkfactory.h"
+#include "network-web/downloader.h"
 #include "application.h"
 
 #if defined(Q_OS_WIN)
@@ -51,19 +52,12 @@ SystemFactory::SystemFactory() {
 SystemFactory::~SystemFactory() {
 }
 
-QPair<UpdateInfo, QNetworkReply::NetworkError> SystemFactory::checkForUpdates() {
-  QPair<UpdateInfo, QNetworkReply::NetworkError> result;
-  QByteArray releases_xml;
+Downloader *SystemFactory::checkForUpdates() {
+  Downloader *downloader = NetworkFactory::downloadFileAsync(RELEASES_LIST, DOWNLOAD_TIMEOUT);
 
-  result.second = NetworkFactory::downloadFile(RELEASES_LIST,
-                                               5000,
-                                               releases_xml);
-
-  if (result.second == QNetworkReply::NoError) {
-    result.first = parseUpdatesFile(releases_xml);
-  }
-
-  return result;
+  downloader->setCacheTimeToLive(qApp->settings()->value(APP_CFG_GEN, "updates_cache_ttl",
+                                                         UPDATES_CACHE_TTL).toInt());
+  return downloader;
 }
 
 UpdateInfo SystemFactory::parseUpdatesFile(const QByteArray &updates_file) {
@@ -87,6 +81,7 @@ UpdateInfo SystemFactory::parseUpdatesFile(const QByteArray &updates_file) {
       url.m_fileUrl = url_elem.text();
       url.m_os = url_elem.attributes().namedItem("os").toAttr().value();
       url.m_platform = url_elem.attributes().namedItem("platform").toAttr().value();
+      url.m_checksum = url_elem.attributes().namedItem("checksum").toAttr().value();
 
       update.m_urls.insert(url.m_os,
                            url);
@@ -37,12 +37,15 @@
 #include <QNetworkReply>
 
 
+class Downloader;
+
 /// \brief Information about update metadata.
 class UpdateUrl {
   public:
     QString m_fileUrl;
     QString m_platform;
     QString m_os;
+    QString m_checksum;
 };
 
 /// \brief Information about available update.
@@ -78,9 +81,11 @@ class SystemFactory {
     /// \return Returns parsed update information.
     static UpdateInfo parseUpdatesFile(const QByteArray &updates_file);
 
-    /// \brief Tries to synchronously download list with new updates.
-    /// \return Returns information about new updates + network download status.
-    static QPair<UpdateInfo, QNetworkReply::NetworkError> checkForUpdates();
+    /// \brief Starts asynchronous download of list with new updates.
+    /// \return Returns running downloader, downloaded list is to be
+    /// parsed with parseUpdatesFile().
+    /// \see NetworkFactory::downloadFileAsync()
+    static Downloader *checkForUpdates();
 
   private:
     explicit SystemFactory();
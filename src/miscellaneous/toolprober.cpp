@@ -0,0 +1,280 @@
+/*
+  Copyright (c) 2012, BuildmLearn Contributors listed at http://buildmlearn.org/people/
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+
+  * Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+
+  * Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+
+  * Neither the name of the BuildmLearn nor the names of its
+    contributors may be used to endorse or promote products derived from
+    this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "miscellaneous/toolprober.h"
+
+#include "definitions/definitions.h"
+#include "miscellaneous/application.h"
+
+#include <QFileInfo>
+#include <QDateTime>
+#include <QStringList>
+#include <QTimer>
+#include <QDir>
+
+#if QT_VERSION >= 0x050000
+#include <QStandardPaths>
+#endif
+
+
+ToolProber::ToolProber(QObject *parent)
+  : QObject(parent), m_cache(QHash<QString, int>()), m_cacheOrder(QStringList()), m_runningProbes(QHash<QString, QProcess*>()),
+    m_cachedResults(QList<Result>()) {
+  loadCache();
+}
+
+ToolProber::~ToolProber() {
+  foreach (QProcess *process, m_runningProbes.values()) {
+    process->disconnect(this);
+    process->kill();
+    process->waitForFinished(1000);
+  }
+
+  qDebug("Destroying ToolProber instance.");
+}
+
+void ToolProber::probe(ToolProber::Tool tool, const QString &path, const QString &java_path, int generation) {
+  bool persistent;
+  QString key = cacheKey(tool, path, java_path, &persistent);
+
+  if (path.isEmpty() || m_cache.contains(key)) {
+    Result result;
+
+    result.m_tool = tool;
+    result.m_path = path;
+    result.m_exitCode = path.isEmpty() ? EXIT_STATUS_NOT_STARTED : m_cache.value(key);
+    result.m_generation = generation;
+
+    if (!path.isEmpty()) {
+      touchCacheEntry(key);
+    }
+
+    m_cachedResults.append(result);
+    QTimer::singleShot(0, this, SLOT(announceCachedResults()));
+    return;
+  }
+
+  if (m_runningProbes.contains(key)) {
+    // Same executable is being probed right now, its result will be announced.
+    QProcess *running_process = m_runningProbes.value(key);
+
+    running_process->setProperty("generation", qMax(running_process->property("generation").toInt(), generation));
+    return;
+  }
+
+  QProcess *process = new QProcess(this);
+  QString program;
+  QStringList arguments;
+
+  switch (tool) {
+    case Java:
+      program = path;
+      arguments << "-version";
+      break;
+
+    case Zip:
+      program = path;
+      arguments << "--version";
+      break;
+
+    case SignApk:
+    default:
+      program = java_path;
+      arguments << "-jar" << QDir::toNativeSeparators(path);
+      break;
+  }
+
+  process->setProperty("tool", (int) tool);
+  process->setProperty("path", path);
+  process->setProperty("key", key);
+  process->setProperty("persistent", persistent);
+  process->setProperty("generation", generation);
+  process->setProperty("timed_out", false);
+  process->setReadChannelMode(QProcess::MergedChannels);
+
+  connect(process, SIGNAL(finished(int,QProcess::ExitStatus)), this, SLOT(processFinished(int,QProcess::ExitStatus)));
+  connect(process, SIGNAL(error(QProcess::ProcessError)), this, SLOT(processError(QProcess::ProcessError)));
+
+  // Hanging tool must not block generation forever.
+  QTimer *timeout_timer = new QTimer(process);
+
+  timeout_timer->setSingleShot(true);
+  connect(timeout_timer, SIGNAL(timeout()), this, SLOT(probeTimedOut()));
+  timeout_timer->start(TOOL_PROBE_TIMEOUT);
+
+  m_runningProbes.insert(key, process);
+  process->start(QDir::toNativeSeparators(program), arguments);
+}
+
+void ToolProber::processFinished(int exit_code, QProcess::ExitStatus exit_status) {
+  QProcess *process = qobject_cast<QProcess*>(sender());
+
+  if (process != NULL) {
+    finishProbe(process, exit_status == QProcess::NormalExit ? exit_code : EXIT_STATUS_CRASH);
+  }
+}
+
+void ToolProber::processError(QProcess::ProcessError error) {
+  QProcess *process = qobject_cast<QProcess*>(sender());
+
+  // Other errors are followed by finished() signal.
+  if (process != NULL && error == QProcess::FailedToStart) {
+    finishProbe(process, EXIT_STATUS_NOT_STARTED);
+  }
+}
+
+void ToolProber::probeTimedOut() {
+  QProcess *process = qobject_cast<QProcess*>(sender()->parent());
+
+  if (process != NULL) {
+    qWarning("Probe of '%s' timed out.", qPrintable(process->property("path").toString()));
+
+    process->setProperty("timed_out", true);
+    process->kill();
+  }
+}
+
+void ToolProber::announceCachedResults() {
+  QList<Result> results = m_cachedResults;
+
+  m_cachedResults.clear();
+
+  foreach (const Result &result, results) {
+    emit probed(result.m_tool, result.m_path, result.m_exitCode, result.m_generation);
+  }
+}
+
+void ToolProber::finishProbe(QProcess *process, int exit_code) {
+  QString key = process->property("key").toString();
+
+  if (m_runningProbes.value(key) != process) {
+    return;
+  }
+
+  Tool tool = static_cast<Tool>(process->property("tool").toInt());
+  QString path = process->property("path").toString();
+
+  m_runningProbes.remove(key);
+
+  qDebug("Probe of '%s' finished with exit code %d.", qPrintable(path), exit_code);
+
+  // Tools which are not found on disk are always probed again, they can
+  // be in PATH or they may be installed later. Timed out probes are
+  // probed again as well, machine may have been just busy.
+  if (process->property("persistent").toBool() && !process->property("timed_out").toBool()) {
+    m_cache.insert(key, exit_code);
+    touchCacheEntry(key);
+    saveCache();
+  }
+
+  process->disconnect(this);
+  process->deleteLater();
+
+  emit probed(tool, path, exit_code, process->property("generation").toInt());
+}
+
+QString ToolProber::cacheKey(Tool tool, const QString &path, const QString &java_path, bool *persistent) const {
+  bool path_exists;
+  QString key = QString("%1|%2").arg(QString::number(tool), fileSignature(path, &path_exists));
+
+  *persistent = path_exists;
+
+  if (tool == SignApk) {
+    bool java_exists;
+
+    key += '|' + fileSignature(java_path, &java_exists);
+    *persistent = *persistent && java_exists;
+  }
+
+  return key;
+}
+
+QString ToolProber::fileSignature(const QString &path, bool *exists) {
+  QString file_path = path;
+
+#if QT_VERSION >= 0x050000
+  if (!file_path.isEmpty() && !QFileInfo(file_path).exists()) {
+    // Tool can be given just by its name and found in PATH.
+    QString found_path = QStandardPaths::findExecutable(file_path);
+
+    if (!found_path.isEmpty()) {
+      file_path = found_path;
+    }
+  }
+#endif
+
+  QFileInfo file_info(file_path);
+
+  *exists = file_info.exists();
+
+  if (*exists) {
+    return QString("%1|%2|%3").arg(QDir::toNativeSeparators(file_info.absoluteFilePath()),
+                                   QString::number(file_info.size()),
+                                   QString::number(file_info.lastModified().toMSecsSinceEpoch()));
+  }
+  else {
+    return QDir::toNativeSeparators(path);
+  }
+}
+
+void ToolProber::touchCacheEntry(const QString &key) {
+  m_cacheOrder.removeAll(key);
+  m_cacheOrder.append(key);
+}
+
+void ToolProber::loadCache() {
+  QStringList entries = qApp->settings()->value(APP_CFG_GEN, "tool_probe_cache").toStringList();
+
+  foreach (const QString &entry, entries) {
+    int separator = entry.lastIndexOf('=');
+
+    if (separator > 0) {
+      // Entries are saved from the oldest one.
+      m_cache.insert(entry.left(separator), entry.mid(separator + 1).toInt());
+      touchCacheEntry(entry.left(separator));
+    }
+  }
+}
+
+void ToolProber::saveCache() {
+  QStringList entries;
+
+  // Keep only reasonable number of entries, the least recently used
+  // ones are dropped and simply probed again if needed.
+  while (m_cacheOrder.size() > TOOL_PROBE_CACHE_SIZE) {
+    m_cache.remove(m_cacheOrder.takeFirst());
+  }
+
+  foreach (const QString &key, m_cacheOrder) {
+    entries.append(key + '=' + QString::number(m_cache.value(key)));
+  }
+
+  qApp->settings()->setValue(APP_CFG_GEN, "tool_probe_cache", entries);
+}
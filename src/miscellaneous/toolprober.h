@@ -0,0 +1,125 @@
+/*
+  Copyright (c) 2012, BuildmLearn Contributors listed at http://buildmlearn.org/people/
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+
+  * Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+
+  * Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+
+  * Neither the name of the BuildmLearn nor the names of its
+    contributors may be used to endorse or promote products derived from
+    this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef TOOLPROBER_H
+#define TOOLPROBER_H
+
+#include <QObject>
+
+#include <QProcess>
+#include <QHash>
+#include <QList>
+#include <QStringList>
+
+
+/// \brief Asynchronous checker of external tools needed for application generation.
+///
+/// Each tool is probed by running it in separate process, all probes run concurrently.
+/// Results are cached and keyed by path, size and modification time of the executables,
+/// so unchanged tools are not probed again, not even after application restart.
+/// Probes which time out are not cached, tool may just be slow to start.
+/// \see Application::recheckExternalApplications()
+class ToolProber : public QObject {
+    Q_OBJECT
+
+  public:
+    /// \brief Probed tools.
+    enum Tool {
+      Java,
+      Zip,
+      SignApk
+    };
+
+    /// \brief Constructor.
+    /// \param parent Parent to this instance.
+    explicit ToolProber(QObject *parent = 0);
+    virtual ~ToolProber();
+
+  public slots:
+    /// \brief Starts probe of given tool.
+    /// \param tool Probed tool.
+    /// \param path Path to executable of the tool.
+    /// \param java_path Path to "java" interpreter, used only for SIGNAPK.
+    /// \param generation Number of the round of probes this probe belongs to,
+    /// it is announced with the result.
+    /// \remarks Result is always announced asynchronously via probed() signal,
+    /// even if it is taken from the cache. If the same executable is already being
+    /// probed, its result is announced just once with the newer generation.
+    void probe(ToolProber::Tool tool, const QString &path, const QString &java_path = QString(), int generation = 0);
+
+  signals:
+    /// \brief Emitted when probe of some tool finishes.
+    /// \param tool Probed tool.
+    /// \param path Path to executable of the tool.
+    /// \param exit_code Exit code of the tool or EXIT_STATUS_NOT_STARTED
+    /// and EXIT_STATUS_CRASH if the tool could not be run.
+    /// \param generation Generation given to probe().
+    void probed(ToolProber::Tool tool, const QString &path, int exit_code, int generation);
+
+  private slots:
+    void processFinished(int exit_code, QProcess::ExitStatus exit_status);
+    void processError(QProcess::ProcessError error);
+
+    // Kills probe which does not finish in time.
+    void probeTimedOut();
+
+    // Announces results which are obtained without running a process.
+    void announceCachedResults();
+
+  private:
+    struct Result {
+      Tool m_tool;
+      QString m_path;
+      int m_exitCode;
+      int m_generation;
+    };
+
+    // Stores result of finished probe and announces it.
+    void finishProbe(QProcess *process, int exit_code);
+
+    // Returns key which identifies given executable in its current state.
+    QString cacheKey(Tool tool, const QString &path, const QString &java_path, bool *persistent) const;
+    static QString fileSignature(const QString &path, bool *exists);
+
+    // Marks cache entry as the most recently used one.
+    void touchCacheEntry(const QString &key);
+
+    void loadCache();
+    void saveCache();
+
+    QHash<QString, int> m_cache;
+
+    // Keys of cached results, the least recently used first.
+    QStringList m_cacheOrder;
+    QHash<QString, QProcess*> m_runningProbes;
+    QList<Result> m_cachedResults;
+};
+
+#endif // TOOLPROBER_H
@@ -34,14 +34,20 @@
 #include "definitions/definitions.h"
 #include "miscellaneous/settings.h"
 #include "miscellaneous/application.h"
+#include "network-web/networkmetrics.h"
 
 #include <QNetworkProxy>
 #include <QNetworkReply>
 #include <QNetworkRequest>
+#include <QThread>
 
 
+QNetworkProxy BaseNetworkAccessManager::s_proxy;
+int BaseNetworkAccessManager::s_proxyGeneration = 0;
+QMutex BaseNetworkAccessManager::s_proxyMutex;
+
 BaseNetworkAccessManager::BaseNetworkAccessManager(QObject *parent)
-  : QNetworkAccessManager(parent) {
+  : QNetworkAccessManager(parent), m_proxyGeneration(-1) {
   connect(this, SIGNAL(sslErrors(QNetworkReply*,QList<QSslError>)),
           this, SLOT(onSslErrors(QNetworkReply*,QList<QSslError>)));
 
@@ -52,36 +58,61 @@ BaseNetworkAccessManager::~BaseNetworkAccessManager() {
 }
 
 void BaseNetworkAccessManager::loadSettings() {
+  if (QThread::currentThread() == qApp->thread()) {
+    reloadProxySettings();
+  }
+
+  applyProxySettings();
+}
+
+void BaseNetworkAccessManager::reloadProxySettings() {
   QNetworkProxy new_proxy;
   QNetworkProxy::ProxyType selected_proxy_type = static_cast<QNetworkProxy::ProxyType>(qApp->settings()->value(APP_CFG_PROXY,
                                                                                                                "proxy_type",
                                                                                                                QNetworkProxy::NoProxy).toInt());
 
   if (selected_proxy_type == QNetworkProxy::NoProxy) {
-    // No extra setting is needed, set new proxy and exit this method.
-    setProxy(QNetworkProxy::NoProxy);
-    return;
+    // No extra setting is needed.
+    new_proxy.setType(QNetworkProxy::NoProxy);
   }
   else if (selected_proxy_type == QNetworkProxy::DefaultProxy) {
-    setProxy(QNetworkProxy::applicationProxy());
+    new_proxy = QNetworkProxy::applicationProxy();
+  }
+  else {
+    Settings *settings = qApp->settings();
+
+    // Custom proxy is selected, set it up.
+    new_proxy.setType(selected_proxy_type);
+    new_proxy.setHostName(settings->value(APP_CFG_PROXY,
+                                          "host").toString());
+    new_proxy.setPort(settings->value(APP_CFG_PROXY,
+                                      "port", 80).toInt());
+    new_proxy.setUser(settings->value(APP_CFG_PROXY,
+                                      "username").toString());
+    new_proxy.setPassword(settings->value(APP_CFG_PROXY,
+                                          "password").toString());
+  }
+
+  QMutexLocker locker(&s_proxyMutex);
+
+  if (s_proxyGeneration > 0 && new_proxy == s_proxy) {
+    // Proxy did not change, managers can keep their connections.
     return;
   }
 
-  Settings *settings = qApp->settings();
-
-  // Custom proxy is selected, set it up.
-  new_proxy.setType(selected_proxy_type);
-  new_proxy.setHostName(settings->value(APP_CFG_PROXY,
-                                        "host").toString());
-  new_proxy.setPort(settings->value(APP_CFG_PROXY,
-                                    "port", 80).toInt());
-  new_proxy.setUser(settings->value(APP_CFG_PROXY,
-                                    "username").toString());
-  new_proxy.setPassword(settings->value(APP_CFG_PROXY,
-                                        "password").toString());
-  setProxy(new_proxy);
-
-  qDebug("Settings of BaseNetworkAccessManager loaded.");
+  s_proxy = new_proxy;
+  s_proxyGeneration++;
+
+  qDebug("Proxy settings of network access managers reloaded.");
+}
+
+void BaseNetworkAccessManager::applyProxySettings() {
+  QMutexLocker locker(&s_proxyMutex);
+
+  if (m_proxyGeneration != s_proxyGeneration) {
+    setProxy(s_proxy);
+    m_proxyGeneration = s_proxyGeneration;
+  }
 }
 
 void BaseNetworkAccessManager::onSslErrors(QNetworkReply *reply,
@@ -99,6 +130,9 @@ QNetworkReply *BaseNetworkAccessManager::createRequest(QNetworkAccessManager::Op
                                                        QIODevice *outgoingData) {
   QNetworkRequest new_request = request;
 
+  // Proxy could be changed since last request.
+  applyProxySettings();
+
   // This rapidly speeds up loading of web sites.
   // NOTE: https://en.wikipedia.org/wiki/HTTP_pipelining
   new_request.setAttribute(QNetworkRequest::HttpPipeliningAllowedAttribute,
@@ -108,5 +142,9 @@ QNetworkReply *BaseNetworkAccessManager::createRequest(QNetworkAccessManager::Op
   new_request.setRawHeader(USER_AGENT_HTTP_HEADER,
                            QString(APP_USERAGENT).toLocal8Bit());
 
-  return QNetworkAccessManager::createRequest(op, new_request, outgoingData);
+  QNetworkReply *reply = QNetworkAccessManager::createRequest(op, new_request, outgoingData);
+
+  // Measure phases of the request for diagnostics.
+  NetworkMetrics::instance()->trackReply(reply, op);
+  return reply;
 }
@@ -34,8 +34,15 @@
 
 #include <QNetworkAccessManager>
 
+#include <QNetworkProxy>
+#include <QMutex>
+
 
 /// \brief Base class for all network access managers.
+///
+/// Proxy configuration is shared by all managers in all threads. It is read
+/// from settings only in main thread and only when settings actually change,
+/// each manager then picks it up before issuing its next request.
 class BaseNetworkAccessManager : public QNetworkAccessManager {
     Q_OBJECT
 
@@ -49,6 +56,12 @@ class BaseNetworkAccessManager : public QNetworkAccessManager {
     /// \remarks This sets up proxy settings.
     virtual void loadSettings();
 
+  public:
+    /// \brief Reloads proxy configuration shared by all network access managers.
+    /// \remarks Nothing happens if proxy settings did not change.
+    /// \warning Call this only from main thread.
+    static void reloadProxySettings();
+
   protected slots:
     /// \brief Catches and processes SSL errors.
     /// \param reply Network reply for which error came up.
@@ -65,6 +78,16 @@ class BaseNetworkAccessManager : public QNetworkAccessManager {
     QNetworkReply *createRequest(Operation op,
                                  const QNetworkRequest &request,
                                  QIODevice *outgoingData);
+
+  private:
+    // Applies shared proxy configuration if it changed since last time.
+    void applyProxySettings();
+
+    int m_proxyGeneration;
+
+    static QNetworkProxy s_proxy;
+    static int s_proxyGeneration;
+    static QMutex s_proxyMutex;
 };
 
 #endif // BASENETWORKACCESSMANAGER_H
@@ -0,0 +1,409 @@
+/*
+  Copyright (c) 2012, BuildmLearn Contributors listed at http://buildmlearn.org/people/
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+
+  * Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+
+  * Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+
+  * Neither the name of the BuildmLearn nor the names of its
+    contributors may be used to endorse or promote products derived from
+    this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "network-web/bundleuploader.h"
+
+#include "definitions/definitions.h"
+#include "miscellaneous/application.h"
+#include "miscellaneous/iofactory.h"
+#include "network-web/downloader.h"
+#include "network-web/networkfactory.h"
+#include "network-web/throttleddevice.h"
+
+#include <QHttpMultiPart>
+#include <QCryptographicHash>
+#include <QUuid>
+#include <QTimer>
+#include <QBuffer>
+
+
+BundleUploader::BundleUploader(QObject *parent)
+  : QObject(parent), m_downloader(new Downloader(this)), m_bundleData(NULL), m_url(QString()),
+    m_uploadId(QString()), m_fields(QHash<QString, QByteArray>()),
+    m_bundleDocument(QDomDocument()), m_itemHashes(QStringList()), m_offset(0), m_chunkLength(0),
+    m_totalSize(0), m_retries(0), m_running(false),
+    m_chunkedUploads(qApp->settings()->value(APP_CFG_GEN, "upload_chunked", false).toBool()),
+    m_deltaUploads(qApp->settings()->value(APP_CFG_GEN, "upload_delta", false).toBool()), m_chunked(false), m_chunkScheduled(false),
+    m_queryingItems(false), m_bandwidthLimit(0), m_uploadTimer(QElapsedTimer()), m_throttledData(NULL) {
+  // Stalled transfer is detected when no progress is made for some time.
+  m_downloader->setTimeout(UPLOAD_STALL_TIMEOUT);
+
+  connect(m_downloader, SIGNAL(progress(qint64,qint64)), this, SLOT(chunkProgress(qint64,qint64)));
+  connect(m_downloader, SIGNAL(completed(QNetworkReply::NetworkError,QByteArray)),
+          this, SLOT(chunkCompleted(QNetworkReply::NetworkError,QByteArray)));
+}
+
+BundleUploader::~BundleUploader() {
+  qDebug("Destroying BundleUploader instance.");
+}
+
+qint64 BundleUploader::chunkSize() const {
+  // Size is stored in kilobytes.
+  return qMax(qApp->settings()->value(APP_CFG_GEN, "upload_chunk_size", UPLOAD_CHUNK_SIZE).toLongLong(), (qint64) 1) * 1024;
+}
+
+int BundleUploader::maxRetries() const {
+  return qApp->settings()->value(APP_CFG_GEN, "upload_max_retries", UPLOAD_MAX_RETRIES).toInt();
+}
+
+qint64 BundleUploader::bandwidthLimit() const {
+  return m_bandwidthLimit;
+}
+
+void BundleUploader::setBandwidthLimit(qint64 bytes_per_second) {
+  m_bandwidthLimit = qMax(bytes_per_second, (qint64) 0);
+
+  if (!m_throttledData.isNull()) {
+    m_throttledData->setRate(m_bandwidthLimit);
+  }
+}
+
+bool BundleUploader::chunkedUploads() const {
+  return m_chunkedUploads;
+}
+
+void BundleUploader::setChunkedUploads(bool enabled) {
+  m_chunkedUploads = enabled;
+}
+
+bool BundleUploader::deltaUploads() const {
+  return m_deltaUploads;
+}
+
+void BundleUploader::setDeltaUploads(bool enabled) {
+  m_deltaUploads = enabled;
+}
+
+bool BundleUploader::isRunning() const {
+  return m_running;
+}
+
+void BundleUploader::upload(const QString &url, QIODevice *bundle_data,
+                            const QString &key, const QString &author_name,
+                            const QString &author_email, const QString &application_name,
+                            const QString &application_icon) {
+  if (isRunning()) {
+    qWarning("Bundle upload is already running.");
+    bundle_data->deleteLater();
+    return;
+  }
+
+  m_running = true;
+  m_url = url;
+  m_bundleData = bundle_data;
+  m_bundleData->setParent(this);
+  m_totalSize = 0;
+  m_uploadTimer.start();
+
+  m_fields.clear();
+  m_fields.insert("key", key.toUtf8());
+  m_fields.insert("author_name", author_name.toUtf8());
+  m_fields.insert("author_email", author_email.toUtf8());
+  m_fields.insert("application_name", application_name.toUtf8());
+  m_fields.insert("application_icon", IOFactory::fileToBase64(application_icon));
+
+  if (deltaUploads()) {
+    queryItems();
+  }
+  else {
+    startTransfer();
+  }
+}
+
+void BundleUploader::cancel() {
+  if (m_downloader->isRunning()) {
+    m_downloader->cancel();
+  }
+  else if (isRunning()) {
+    // Upload is waiting for retry.
+    finish(QNetworkReply::OperationCanceledError, QByteArray());
+  }
+}
+
+void BundleUploader::sendChunk() {
+  if (!m_chunkScheduled) {
+    // Upload was cancelled while waiting for retry.
+    return;
+  }
+
+  m_chunkScheduled = false;
+
+  if (!m_bundleData->seek(m_offset)) {
+    finish(QNetworkReply::UnknownContentError, QByteArray());
+    return;
+  }
+
+  // Bundle which is not chunked is sent as single chunk.
+  QByteArray chunk = m_bundleData->read(m_chunked ? chunkSize() : m_totalSize);
+  QByteArray boundary = "boundary_" + QUuid::createUuid().toString().remove('{').remove('}').toLatin1();
+  QBuffer *form_data = new QBuffer();
+
+  m_chunkLength = chunk.size();
+
+  // Fields are sent as form-data parts without file names, so that
+  // server sees them exactly as original URL-encoded fields.
+  if (m_offset == 0) {
+    // Store keeps fields of the upload from its first chunk.
+    for (QHash<QString, QByteArray>::const_iterator it = m_fields.constBegin(); it != m_fields.constEnd(); ++it) {
+      appendFormPart(form_data->buffer(), boundary, it.key(), it.value());
+    }
+  }
+  else {
+    appendFormPart(form_data->buffer(), boundary, "key", m_fields.value("key"));
+  }
+
+  if (m_chunked) {
+    appendFormPart(form_data->buffer(), boundary, "upload_id", m_uploadId.toUtf8());
+    appendFormPart(form_data->buffer(), boundary, "chunk_offset", QByteArray::number(m_offset));
+    appendFormPart(form_data->buffer(), boundary, "total_size", QByteArray::number(m_totalSize));
+    appendFormPart(form_data->buffer(), boundary, "chunk_checksum", QCryptographicHash::hash(chunk, QCryptographicHash::Sha1).toHex());
+  }
+
+  appendFormPart(form_data->buffer(), boundary, "file_content", chunk);
+  form_data->buffer().append("--" + boundary + "--\r\n");
+  form_data->open(QIODevice::ReadOnly);
+
+  // Request body itself is released at limited rate.
+  m_throttledData = new ThrottledDevice(form_data, m_bandwidthLimit);
+  m_throttledData->open(QIODevice::ReadOnly);
+
+  m_downloader->uploadData(m_url, m_throttledData, "multipart/form-data; boundary=" + boundary);
+}
+
+void BundleUploader::chunkCompleted(QNetworkReply::NetworkError status, const QByteArray &contents) {
+  if (m_queryingItems) {
+    itemsQueried(status, contents);
+    return;
+  }
+
+  if (!m_chunked) {
+    if (status != QNetworkReply::OperationCanceledError &&
+        StoreFactory::parseResponseXml(status, contents) == StoreFactory::NetworkError) {
+      qWarning("Upload to '%s' failed: '%s'.", qPrintable(m_url), qPrintable(NetworkFactory::networkErrorText(status)));
+
+      if (retryChunk()) {
+        return;
+      }
+    }
+
+    finish(status, contents);
+    return;
+  }
+
+  if (status == QNetworkReply::OperationCanceledError) {
+    finish(status, contents);
+    return;
+  }
+
+  StoreFactory::UploadStatus upload_status = StoreFactory::parseResponseXml(status, contents);
+
+  switch (upload_status) {
+    case StoreFactory::PartiallyUploaded: {
+      qint64 confirmed_offset = StoreFactory::parseUploadOffset(contents);
+
+      // Store tells how much it has, upload continues from there.
+      m_offset = confirmed_offset >= 0 ? qMin(confirmed_offset, m_totalSize) : m_offset + m_chunkLength;
+      m_retries = 0;
+
+      emit statusChanged(upload_status, m_offset, m_totalSize);
+
+      if (m_offset >= m_totalSize) {
+        // Store should accept the last chunk with final status.
+        finish(status, contents);
+      }
+      else {
+        m_chunkScheduled = true;
+        sendChunk();
+      }
+
+      break;
+    }
+
+    case StoreFactory::NetworkError:
+    case StoreFactory::ChecksumMismatch:
+      qWarning("Chunk at offset %lld of upload '%s' failed: '%s'.",
+               m_offset, qPrintable(m_uploadId), qPrintable(NetworkFactory::networkErrorText(status)));
+
+      if (!retryChunk()) {
+        finish(status, contents);
+      }
+
+      break;
+
+    default:
+      finish(status, contents);
+      break;
+  }
+}
+
+void BundleUploader::chunkProgress(qint64 bytes_sent, qint64 bytes_total) {
+  if (!m_chunked) {
+    emit progress(bytes_sent, bytes_total);
+  }
+  else if (bytes_total > 0) {
+    // Request contains also other fields, so progress of chunk is only estimated.
+    emit progress(m_offset + m_chunkLength * bytes_sent / bytes_total, m_totalSize);
+  }
+}
+
+void BundleUploader::queryItems() {
+  m_bundleData->seek(0);
+
+  // Bundle is parsed only once, the same document is used for delta bundle.
+  m_bundleDocument.setContent(m_bundleData);
+  m_itemHashes = StoreFactory::bundleItemHashes(m_bundleDocument);
+
+  m_bundleData->seek(0);
+
+  if (m_itemHashes.isEmpty()) {
+    m_bundleDocument.clear();
+    startTransfer();
+    return;
+  }
+
+  QHttpMultiPart *form_data = new QHttpMultiPart(QHttpMultiPart::FormDataType);
+
+  for (QHash<QString, QByteArray>::const_iterator it = m_fields.constBegin(); it != m_fields.constEnd(); ++it) {
+    form_data->append(Downloader::formPart(it.key(), it.value()));
+  }
+
+  form_data->append(Downloader::formPart("action", STORE_ACTION_QUERY_ITEMS));
+  form_data->append(Downloader::formPart("item_hashes", m_itemHashes.join("\n").toUtf8()));
+
+  m_queryingItems = true;
+  m_downloader->uploadFormData(m_url, form_data);
+}
+
+void BundleUploader::itemsQueried(QNetworkReply::NetworkError status, const QByteArray &contents) {
+  m_queryingItems = false;
+
+  if (status == QNetworkReply::OperationCanceledError) {
+    finish(status, contents);
+    return;
+  }
+
+  QString delta_bundle;
+
+  if (StoreFactory::parseResponseXml(status, contents) == StoreFactory::Success) {
+    QSet<QString> missing_hashes = StoreFactory::parseMissingItems(contents);
+
+    delta_bundle = StoreFactory::createDeltaBundle(m_bundleDocument, m_itemHashes, missing_hashes);
+
+    qDebug("Store misses %d of %d items.", missing_hashes.size(), m_itemHashes.size());
+  }
+  else {
+    qDebug("Store does not support delta uploads, whole bundle is uploaded.");
+  }
+
+  m_bundleDocument.clear();
+  m_itemHashes.clear();
+
+  if (!delta_bundle.isEmpty()) {
+    QBuffer *delta_data = new QBuffer(this);
+
+    delta_data->setData(delta_bundle.toUtf8());
+    delta_data->open(QIODevice::ReadOnly);
+
+    qDebug("Delta bundle has %lld of %lld bytes.", delta_data->size(), m_bundleData->size());
+
+    m_bundleData->deleteLater();
+    m_bundleData = delta_data;
+    m_fields.insert("delta", "1");
+  }
+  else {
+    m_bundleData->seek(0);
+  }
+
+  startTransfer();
+}
+
+void BundleUploader::startTransfer() {
+  m_totalSize = m_bundleData->size();
+  m_offset = 0;
+  m_retries = 0;
+  m_chunked = chunkedUploads() && m_totalSize > chunkSize();
+
+  if (m_chunked) {
+    m_uploadId = QUuid::createUuid().toString().remove('{').remove('}');
+
+    qDebug("Starting chunked upload '%s' of %lld bytes.", qPrintable(m_uploadId), m_totalSize);
+  }
+
+  m_chunkScheduled = true;
+  sendChunk();
+}
+
+void BundleUploader::appendFormPart(QByteArray &form_data, const QByteArray &boundary,
+                                    const QString &name, const QByteArray &value) {
+  form_data.append("--" + boundary + "\r\n");
+  form_data.append(QString("Content-Disposition: form-data; name=\"%1\"\r\n\r\n").arg(name).toUtf8());
+  form_data.append(value);
+  form_data.append("\r\n");
+}
+
+bool BundleUploader::retryChunk() {
+  if (m_retries >= maxRetries()) {
+    return false;
+  }
+
+  // Each next retry waits twice as long as the previous one.
+  int delay = UPLOAD_RETRY_DELAY << m_retries;
+
+  m_retries++;
+  qDebug("Retrying upload to '%s' from offset %lld in %d ms (attempt %d).",
+         qPrintable(m_url), m_offset, delay, m_retries);
+
+  m_chunkScheduled = true;
+  QTimer::singleShot(delay, this, SLOT(sendChunk()));
+  return true;
+}
+
+void BundleUploader::finish(QNetworkReply::NetworkError status, const QByteArray &contents) {
+  qint64 elapsed = qMax(m_uploadTimer.elapsed(), (qint64) 1);
+
+  // Throughput includes items query of delta uploads, retries and bandwidth
+  // limiting. Endpoint discovery is not included, it precedes upload().
+  qDebug("Upload of %lld bytes to '%s' finished in %lld ms (%.1f kB/s) with status '%s'.",
+         m_totalSize, qPrintable(m_url), elapsed, (m_totalSize * 1000.0) / (elapsed * 1024.0),
+         qPrintable(NetworkFactory::networkErrorText(status)));
+
+  if (m_bundleData != NULL) {
+    m_bundleData->deleteLater();
+    m_bundleData = NULL;
+  }
+
+  m_running = false;
+  m_chunkScheduled = false;
+  m_throttledData = NULL;
+  m_bundleDocument.clear();
+  m_itemHashes.clear();
+
+  emit completed(status, contents);
+}
@@ -0,0 +1,208 @@
+/*
+  Copyright (c) 2012, BuildmLearn Contributors listed at http://buildmlearn.org/people/
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+
+  * Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+
+  * Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+
+  * Neither the name of the BuildmLearn nor the names of its
+    contributors may be used to endorse or promote products derived from
+    this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef BUNDLEUPLOADER_H
+#define BUNDLEUPLOADER_H
+
+#include <QObject>
+
+#include "miscellaneous/storefactory.h"
+
+#include <QNetworkReply>
+#include <QHash>
+#include <QStringList>
+#include <QDomDocument>
+#include <QElapsedTimer>
+#include <QPointer>
+
+
+class Downloader;
+class ThrottledDevice;
+class QIODevice;
+class QHttpMultiPart;
+
+/// \brief Uploader of application bundles to BuildmLearn Store.
+///
+/// Bundles are uploaded with single request by default. Chunked uploads
+/// must be enabled explicitly for stores which support them, because store
+/// without chunking support would publish first chunk as a whole bundle.
+/// If enabled, bundles larger than single chunk are split into chunks, each
+/// chunk is sent with fields "upload_id", "chunk_offset", "total_size" and
+/// "chunk_checksum" (hex SHA-1 of the chunk). Usual upload fields are sent only
+/// with the first chunk, later chunks contain just "key". Store answers
+/// "partial" status with "offset" of bytes it has stored so far until
+/// the last chunk is accepted.
+///
+/// Stalled or failed chunks are retried with exponential backoff, upload
+/// then resumes from the offset confirmed by the store. Bundle sent with
+/// single request is retried the same way as single chunk, from its start.
+///
+/// If delta uploads are enabled, store is first asked (action "query_items"
+/// with newline-separated "item_hashes") which bundle items it misses. Only
+/// those items are then sent within delta bundle, see StoreFactory::createDeltaBundle().
+/// If store does not answer with success, whole bundle is uploaded.
+/// \see StoreFactory, Downloader
+class BundleUploader : public QObject {
+    Q_OBJECT
+
+  public:
+    /// \brief Constructor.
+    /// \param parent Parent to this instance.
+    explicit BundleUploader(QObject *parent = 0);
+    virtual ~BundleUploader();
+
+    /// \brief Access to size of upload chunks.
+    /// \return Returns size of upload chunks in bytes.
+    qint64 chunkSize() const;
+
+    /// \brief Access to maximal number of retries of single chunk.
+    /// \return Returns maximal number of retries.
+    int maxRetries() const;
+
+    /// \brief Access to bandwidth limit.
+    /// \return Returns maximal average upload rate in bytes per second,
+    /// zero means unlimited rate.
+    qint64 bandwidthLimit() const;
+
+    /// \brief Sets bandwidth limit.
+    /// \param bytes_per_second Maximal average upload rate, zero means unlimited rate.
+    /// \remarks Body of each request is released at limited rate, so that the
+    /// transfer itself is slowed down. New limit applies also to running request.
+    void setBandwidthLimit(qint64 bytes_per_second);
+
+    /// \brief Indication of chunked uploads.
+    /// \return Returns true if bundles larger than single chunk are
+    /// uploaded in chunks.
+    bool chunkedUploads() const;
+
+    /// \brief Enables or disables chunked uploads, default value is taken from settings.
+    /// \param enabled True if chunked uploads are enabled.
+    void setChunkedUploads(bool enabled);
+
+    /// \brief Indication of delta uploads.
+    /// \return Returns true if only items missing in the store are uploaded.
+    bool deltaUploads() const;
+
+    /// \brief Enables or disables delta uploads, default value is taken from settings.
+    /// \param enabled True if delta uploads are enabled.
+    void setDeltaUploads(bool enabled);
+
+    /// \brief Indication of running upload.
+    /// \return Returns true if upload is in progress.
+    bool isRunning() const;
+
+  public slots:
+    /// \brief Starts upload of given bundle.
+    /// \param url URL of store server.
+    /// \param bundle_data Device with bundle data, it must support seeking.
+    /// Uploader takes ownership of it.
+    void upload(const QString &url, QIODevice *bundle_data,
+                const QString &key, const QString &author_name,
+                const QString &author_email, const QString &application_name,
+                const QString &application_icon);
+
+    /// \brief Cancels running upload.
+    void cancel();
+
+  signals:
+    /// \brief Emitted when new progress is known.
+    /// \param bytes_sent Number of bytes of bundle sent.
+    /// \param bytes_total Size of bundle.
+    void progress(qint64 bytes_sent, qint64 bytes_total);
+
+    /// \brief Emitted when store confirms part of the bundle.
+    /// \param status Status of the upload, StoreFactory::PartiallyUploaded for now.
+    /// \param bytes_confirmed Number of bytes stored by the store.
+    /// \param bytes_total Size of bundle.
+    void statusChanged(StoreFactory::UploadStatus status, qint64 bytes_confirmed, qint64 bytes_total);
+
+    /// \brief Emitted if upload completes (un)successfully.
+    /// \param status Network status of the last request.
+    /// \param contents Reply of the store to the last request.
+    void completed(QNetworkReply::NetworkError status, QByteArray contents);
+
+  private slots:
+    // Sends chunk starting at current offset, or the whole bundle
+    // if it is not chunked.
+    void sendChunk();
+
+    // Called when single request finishes.
+    void chunkCompleted(QNetworkReply::NetworkError status, const QByteArray &contents);
+
+    // Called when progress of current request changes.
+    void chunkProgress(qint64 bytes_sent, qint64 bytes_total);
+
+  private:
+    // Asks store which items of the bundle it misses.
+    void queryItems();
+
+    // Processes answer to items query and starts transfer.
+    void itemsQueried(QNetworkReply::NetworkError status, const QByteArray &contents);
+
+    // Starts transfer of the bundle.
+    void startTransfer();
+
+    // Appends form-data part with given field to multipart form.
+    static void appendFormPart(QByteArray &form_data, const QByteArray &boundary,
+                               const QString &name, const QByteArray &value);
+
+    // Schedules retry of current chunk, returns false if no retries are left.
+    bool retryChunk();
+
+    // Finishes the upload and reports the result.
+    void finish(QNetworkReply::NetworkError status, const QByteArray &contents);
+
+    Downloader *m_downloader;
+    QIODevice *m_bundleData;
+    QString m_url;
+    QString m_uploadId;
+    QHash<QString, QByteArray> m_fields;
+
+    // Bundle parsed for delta upload, kept until store answers which items it misses.
+    QDomDocument m_bundleDocument;
+    QStringList m_itemHashes;
+    qint64 m_offset;
+    qint64 m_chunkLength;
+    qint64 m_totalSize;
+    int m_retries;
+    bool m_running;
+    bool m_chunkedUploads;
+    bool m_deltaUploads;
+    bool m_chunked;
+    bool m_chunkScheduled;
+    bool m_queryingItems;
+    qint64 m_bandwidthLimit;
+    QElapsedTimer m_uploadTimer;
+
+    // Body of running request, it is owned by the request.
+    QPointer<ThrottledDevice> m_throttledData;
+};
+
+#endif // BUNDLEUPLOADER_H
@@ -32,90 +32,122 @@
 #include "network-web/downloader.h"
 
 #include "network-web/silentnetworkaccessmanager.h"
+#include "network-web/networkfactory.h"
 #include "miscellaneous/iofactory.h"
 
 #include <QTimer>
+#include <QHttpMultiPart>
+#include <QDateTime>
+#include <QAbstractNetworkCache>
+#include <QNetworkCacheMetaData>
 
 
 Downloader::Downloader(QObject *parent)
   : QObject(parent),
     m_activeReply(NULL),
-    m_downloadManager(new SilentNetworkAccessManager(this)),
+    m_abortStatus(QNetworkReply::NoError),
+    m_redirects(0),
+    m_cacheTimeToLive(0),
     m_timer(new QTimer(this)) {
 
-  m_timer->setInterval(2000);
+  // Timeout is disabled by default.
+  m_timer->setInterval(0);
   m_timer->setSingleShot(true);
 
-  //connect(m_timer, SIGNAL(timeout()), this, SLOT(timeout()));
-  connect(m_downloadManager, SIGNAL(finished(QNetworkReply*)), this, SLOT(finished(QNetworkReply*)));
+  connect(m_timer, SIGNAL(timeout()), this, SLOT(timeout()));
 }
 
 Downloader::~Downloader() {
-  m_downloadManager->deleteLater();
+  if (m_activeReply != NULL) {
+    // Reply belongs to shared manager, make sure it does not outlive us.
+    m_activeReply->disconnect(this);
+    m_activeReply->abort();
+    m_activeReply->deleteLater();
+  }
+}
+
+int Downloader::timeout() const {
+  return m_timer->interval();
+}
+
+void Downloader::setTimeout(int timeout) {
+  m_timer->setInterval(qMax(timeout, 0));
+}
+
+int Downloader::cacheTimeToLive() const {
+  return m_cacheTimeToLive;
+}
+
+void Downloader::setCacheTimeToLive(int seconds) {
+  m_cacheTimeToLive = qMax(seconds, 0);
+}
+
+bool Downloader::isRunning() const {
+  return m_activeReply != NULL;
 }
 
 void Downloader::downloadFile(const QString &url, bool protected_contents,
                               const QString &username, const QString &password) {
   QNetworkRequest request;
-  QObject originatingObject;
 
-  // Set credential information as originating object.
-  originatingObject.setProperty("protected", protected_contents);
-  originatingObject.setProperty("username", username);
-  originatingObject.setProperty("password", password);
-  request.setOriginatingObject(&originatingObject);
+  // Set credential information as originating object, downloader
+  // itself is used because it lives as long as the request does.
+  setProperty("protected", protected_contents);
+  setProperty("username", username);
+  setProperty("password", password);
+  request.setOriginatingObject(this);
 
   // Set url for this reques.
   request.setUrl(url);
+
+  m_redirects = 0;
   runGetRequest(request);
 }
 
-void Downloader::uploadBundleFile(QString url, const QString &bundle_data,
-                                  const QString &key, const QString &author_name,
-                                  const QString &author_email, const QString &application_name,
-                                  const QString &application_icon) {
+void Downloader::uploadFormData(const QString &url, QHttpMultiPart *form_data) {
   QNetworkRequest request;
 
   request.setUrl(url);
-  request.setHeader(QNetworkRequest::ContentTypeHeader, "application/x-www-form-urlencoded");
-
-  QString data;
-
-  data += "key=%1&";
-  data += "author_name=%2&";
-  data += "author_email=%3&";
-  data += "application_name=%4&";
-  data += "file_content=%5&";
-  data += "application_icon=%6";
-
-  // Replace placeholders with actual URL-encoded values.
-  data = data.arg(QUrl::toPercentEncoding(key),
-                  QUrl::toPercentEncoding(author_name),
-                  QUrl::toPercentEncoding(author_email),
-                  QUrl::toPercentEncoding(application_name),
-                  QUrl::toPercentEncoding(bundle_data),
-                  QUrl::toPercentEncoding(IOFactory::fileToBase64(application_icon)));
-/*
-  m_timer->start();
-  m_activeReply = m_downloadManager->post(request, data.toLocal8Bit());
 
-  connect(m_activeReply, SIGNAL(uploadProgress(qint64,qint64)),
-          this, SLOT(progressInternal(qint64,qint64)));
-*/
-  runPostRequest(request, data.toLocal8Bit());
+  m_redirects = 0;
+  runPostRequest(request, form_data);
+}
+
+void Downloader::uploadData(const QString &url, QIODevice *data, const QByteArray &content_type) {
+  QNetworkRequest request;
+
+  request.setUrl(url);
+  request.setHeader(QNetworkRequest::ContentTypeHeader, content_type);
+
+  m_redirects = 0;
+  runPostRequest(request, data);
+}
+
+void Downloader::cancel() {
+  if (m_activeReply != NULL) {
+    m_abortStatus = QNetworkReply::OperationCanceledError;
+    m_activeReply->abort();
+  }
 }
 
-void Downloader::finished(QNetworkReply *reply) {
+void Downloader::finished() {
+  QNetworkReply *reply = qobject_cast<QNetworkReply*>(sender());
+
+  if (reply == NULL || reply != m_activeReply) {
+    return;
+  }
+
   m_timer->stop();
 
   // In this phase, some part of downloading process is completed.
   QUrl redirection_url = reply->attribute(QNetworkRequest::RedirectionTargetAttribute).toUrl();
 
-  if (redirection_url.isValid()) {
+  if (redirection_url.isValid() && reply->error() == QNetworkReply::NoError && m_redirects < DOWNLOAD_MAX_REDIRECTS) {
     // Communication indicates that HTTP redirection is needed.
     // Setup redirection URL and download again.
     QNetworkRequest request = reply->request();
-    request.setUrl(redirection_url);
+    request.setUrl(reply->url().resolved(redirection_url));
+    m_redirects++;
 
     m_activeReply->deleteLater();
     m_activeReply = NULL;
@@ -130,6 +162,22 @@ void Downloader::finished(QNetworkReply *reply) {
     QByteArray output = reply->readAll();
     QNetworkReply::NetworkError reply_error = reply->error();
 
+    if (reply_error == QNetworkReply::OperationCanceledError && m_abortStatus != QNetworkReply::NoError) {
+      // Reply was aborted by us, report real reason.
+      reply_error = m_abortStatus;
+    }
+
+    qDebug("File '%s' fetched with status '%s' (code %d)%s.",
+           qPrintable(reply->url().toString()),
+           qPrintable(NetworkFactory::networkErrorText(reply_error)),
+           reply_error,
+           reply->attribute(QNetworkRequest::SourceIsFromCacheAttribute).toBool() ? " from cache" : "");
+
+    if (reply_error == QNetworkReply::NoError && m_cacheTimeToLive > 0) {
+      extendCacheLifetime(reply);
+    }
+
+    m_abortStatus = QNetworkReply::NoError;
     m_activeReply->deleteLater();
     m_activeReply = NULL;
 
@@ -147,21 +195,82 @@ void Downloader::progressInternal(qint64 bytes_received, qint64 bytes_total) {
 
 void Downloader::timeout() {
   if (m_activeReply != NULL) {
+    qWarning("Network operation with '%s' timed out.", qPrintable(m_activeReply->url().toString()));
+
+    m_abortStatus = QNetworkReply::TimeoutError;
     m_activeReply->abort();
   }
 }
 
+void Downloader::extendCacheLifetime(QNetworkReply *reply) {
+  QAbstractNetworkCache *cache = reply->manager()->cache();
+
+  if (cache == NULL) {
+    return;
+  }
+
+  QNetworkCacheMetaData meta_data = cache->metaData(reply->url());
+
+  if (meta_data.isValid() && meta_data.saveToDisk()) {
+    // Cached file is fresh for given time, after that
+    // it gets revalidated by conditional request.
+    meta_data.setExpirationDate(QDateTime::currentDateTime().addSecs(m_cacheTimeToLive));
+    cache->updateMetaData(meta_data);
+  }
+}
+
+QHttpPart Downloader::formPart(const QString &name, const QByteArray &value) {
+  QHttpPart part;
+
+  part.setHeader(QNetworkRequest::ContentDispositionHeader, QString("form-data; name=\"%1\"").arg(name));
+
+  if (!value.isNull()) {
+    part.setBody(value);
+  }
+
+  return part;
+}
+
 void Downloader::runGetRequest(const QNetworkRequest &request) {
-  m_timer->start();
-  m_activeReply = m_downloadManager->get(request);
+  if (m_timer->interval() > 0) {
+    m_timer->start();
+  }
+
+  m_activeReply = NetworkFactory::sharedNetworkManager()->get(request);
+
+  connect(m_activeReply, SIGNAL(finished()), this, SLOT(finished()));
 
   connect(m_activeReply, SIGNAL(downloadProgress(qint64,qint64)),
           this, SLOT(progressInternal(qint64,qint64)));
 }
 
-void Downloader::runPostRequest(const QNetworkRequest &request, const QByteArray &data) {
-  m_timer->start();
-  m_activeReply = m_downloadManager->post(request, data);
+void Downloader::runPostRequest(const QNetworkRequest &request, QHttpMultiPart *data) {
+  if (m_timer->interval() > 0) {
+    m_timer->start();
+  }
+
+  m_activeReply = NetworkFactory::sharedNetworkManager()->post(request, data);
+
+  // Multipart data must live until reply is finished.
+  data->setParent(m_activeReply);
+
+  connect(m_activeReply, SIGNAL(finished()), this, SLOT(finished()));
+
+  connect(m_activeReply, SIGNAL(uploadProgress(qint64,qint64)),
+          this, SLOT(progressInternal(qint64,qint64)));
+}
+
+void Downloader::runPostRequest(const QNetworkRequest &request, QIODevice *data) {
+  if (m_timer->interval() > 0) {
+    m_timer->start();
+  }
+
+  m_activeReply = NetworkFactory::sharedNetworkManager()->post(request, data);
+
+  // Data must be readable until reply is finished.
+  data->setParent(m_activeReply);
+
+  connect(m_activeReply, SIGNAL(finished()), this, SLOT(finished()));
 
   connect(m_activeReply, SIGNAL(uploadProgress(qint64,qint64)),
           this, SLOT(progressInternal(qint64,qint64)));
@@ -36,14 +36,19 @@
 
 #include <QNetworkReply>
 #include <QSslError>
+#include <QHttpPart>
 
 #include "definitions/definitions.h"
 
 
-class SilentNetworkAccessManager;
 class QTimer;
+class QIODevice;
+class QHttpMultiPart;
 
 /// \brief Simple file downloader with progress reporting.
+///
+/// All operations are asynchronous, result is always reported
+/// via completed() signal, even if operation is cancelled or times out.
 class Downloader : public QObject {
     Q_OBJECT
 
@@ -53,6 +58,37 @@ class Downloader : public QObject {
     explicit Downloader(QObject *parent = 0);
     virtual ~Downloader();
 
+    /// \brief Access to inactivity timeout.
+    /// \return Returns number of milliseconds without any progress after which
+    /// running operation is aborted, zero means that timeout is disabled.
+    int timeout() const;
+
+    /// \brief Sets inactivity timeout.
+    /// \param timeout Timeout in milliseconds, zero disables it.
+    void setTimeout(int timeout);
+
+    /// \brief Access to cache lifetime of downloaded files.
+    /// \return Returns number of seconds for which downloaded file is considered
+    /// to be fresh, zero means that server headers decide.
+    int cacheTimeToLive() const;
+
+    /// \brief Sets cache lifetime of downloaded files.
+    /// \param seconds Number of seconds for which next downloaded file is served
+    /// from cache without contacting the server. Once it expires, file is revalidated
+    /// with conditional request (ETag, If-Modified-Since).
+    /// \remarks This can be set even when download is already running.
+    void setCacheTimeToLive(int seconds);
+
+    /// \brief Indication of running operation.
+    /// \return Returns true if some operation is in progress.
+    bool isRunning() const;
+
+    /// \brief Creates form-data part with given field name.
+    /// \param name Name of the field.
+    /// \param value Value of the field, body can be set later if it is null.
+    /// \return Returns new part.
+    static QHttpPart formPart(const QString &name, const QByteArray &value = QByteArray());
+
   public slots:
     /// \brief Performs asynchronous download of given file. Redirections are handled.
     /// \param url URL of file to be downloaded.
@@ -64,13 +100,20 @@ class Downloader : public QObject {
                       const QString &username = QString(),
                       const QString &password = QString());
 
-    /// \brief Uploads given bundle_data to store server via HTTP POST.
-    /// \param url URL to store server
-    /// \param bundle_data
-    void uploadBundleFile(QString url, const QString &bundle_data,
-                          const QString &key, const QString &author_name,
-                          const QString &author_email, const QString &application_name,
-                          const QString &application_icon);
+    /// \brief Uploads given multipart/form-data to the server via HTTP POST.
+    /// \param url URL of the server.
+    /// \param form_data Form data, downloader takes ownership of them.
+    void uploadFormData(const QString &url, QHttpMultiPart *form_data);
+
+    /// \brief Uploads data of given device to the server via HTTP POST.
+    /// \param url URL of the server.
+    /// \param data Opened device with data, downloader takes ownership of it.
+    /// \param content_type Content type of the data.
+    void uploadData(const QString &url, QIODevice *data, const QByteArray &content_type);
+
+    /// \brief Cancels running operation.
+    /// \remarks completed() is emitted with QNetworkReply::OperationCanceledError.
+    void cancel();
 
   signals:
     /// \brief Emitted when new progress is known.
@@ -85,7 +128,7 @@ class Downloader : public QObject {
 
   private slots:
     // Called when current reply is processed.
-    void finished(QNetworkReply *reply);
+    void finished();
 
     // Called when progress of downloaded file changes.
     void progressInternal(qint64 bytes_received, qint64 bytes_total);
@@ -94,13 +137,19 @@ class Downloader : public QObject {
     void timeout();
 
   private:
+    // Makes cached copy of reply contents fresh for cache lifetime.
+    void extendCacheLifetime(QNetworkReply *reply);
+
     // Issues new network requests.
     void runGetRequest(const QNetworkRequest &request);
-    void runPostRequest(const QNetworkRequest &request, const QByteArray &data);
+    void runPostRequest(const QNetworkRequest &request, QHttpMultiPart *data);
+    void runPostRequest(const QNetworkRequest &request, QIODevice *data);
 
   private:
     QNetworkReply *m_activeReply;
-    SilentNetworkAccessManager *m_downloadManager;
+    QNetworkReply::NetworkError m_abortStatus;
+    int m_redirects;
+    int m_cacheTimeToLive;
     QTimer *m_timer;
 };
 
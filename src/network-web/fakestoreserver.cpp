@@ -0,0 +1,495 @@
+/*
+  Copyright (c) 2012, BuildmLearn Contributors listed at http://buildmlearn.org/people/
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+
+  * Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+
+  * Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+
+  * Neither the name of the BuildmLearn nor the names of its
+    contributors may be used to endorse or promote products derived from
+    this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "network-web/fakestoreserver.h"
+
+#include "definitions/definitions.h"
+
+#include <QTcpSocket>
+#include <QHostAddress>
+#include <QTimer>
+
+
+FakeStoreServer::FakeStoreServer(QObject *parent)
+  : QTcpServer(parent), m_latency(0), m_bandwidthLimit(0), m_failureRate(0), m_randomState(1),
+    m_chunkedUploads(true), m_knownItems(QSet<QString>()), m_uploadOffsets(QHash<QString, qint64>()),
+    m_requestCount(0), m_storedBundles(0), m_receivedBytes(0), m_lastFields(QHash<QString, QByteArray>()),
+    m_lastBundle(QByteArray()) {
+  connect(this, SIGNAL(newConnection()), this, SLOT(onNewConnection()));
+}
+
+FakeStoreServer::~FakeStoreServer() {
+  qDebug("Destroying FakeStoreServer instance.");
+}
+
+bool FakeStoreServer::start() {
+  if (!listen(QHostAddress::LocalHost)) {
+    qWarning("Fake store server cannot listen: '%s'.", qPrintable(errorString()));
+    return false;
+  }
+
+  return true;
+}
+
+QString FakeStoreServer::uploadUrl() const {
+  return QString("http://127.0.0.1:%1/store").arg(serverPort());
+}
+
+QString FakeStoreServer::endpointUrl() const {
+  return QString("http://127.0.0.1:%1/endpoint").arg(serverPort());
+}
+
+void FakeStoreServer::setLatency(int latency) {
+  m_latency = qMax(latency, 0);
+}
+
+void FakeStoreServer::setBandwidthLimit(qint64 bytes_per_second) {
+  m_bandwidthLimit = qMax(bytes_per_second, (qint64) 0);
+}
+
+void FakeStoreServer::setFailureRate(int percent) {
+  m_failureRate = qBound(0, percent, 100);
+}
+
+void FakeStoreServer::setChunkedUploads(bool enabled) {
+  m_chunkedUploads = enabled;
+}
+
+void FakeStoreServer::setKnownItems(const QSet<QString> &hashes) {
+  m_knownItems = hashes;
+}
+
+int FakeStoreServer::requestCount() const {
+  return m_requestCount;
+}
+
+int FakeStoreServer::storedBundles() const {
+  return m_storedBundles;
+}
+
+qint64 FakeStoreServer::receivedBytes() const {
+  return m_receivedBytes;
+}
+
+QHash<QString, QByteArray> FakeStoreServer::lastFields() const {
+  return m_lastFields;
+}
+
+QByteArray FakeStoreServer::lastBundle() const {
+  return m_lastBundle;
+}
+
+void FakeStoreServer::onNewConnection() {
+  while (hasPendingConnections()) {
+    QTcpSocket *socket = nextPendingConnection();
+
+    // Connection is owned by its socket.
+    new FakeStoreConnection(socket, this);
+    connect(socket, SIGNAL(disconnected()), socket, SLOT(deleteLater()));
+  }
+}
+
+QByteArray FakeStoreServer::processRequest(const QHash<QString, QByteArray> &fields, const QByteArray &bundle_hash,
+                                           const QByteArray &bundle_data, qint64 bundle_size) {
+  QString status = STORE_ANSWER_SUCCESS;
+  QString details;
+
+  m_requestCount++;
+  m_lastFields = fields;
+  m_lastBundle = bundle_data;
+
+  if (!fields.contains("key")) {
+    status = STORE_ANSWER_NO_PARAMETERS;
+  }
+  else if (fields.value("key") != STORE_API_KEY) {
+    status = STORE_ANSWER_INVALID_KEY;
+  }
+  else if (fields.value("action") == STORE_ACTION_QUERY_ITEMS) {
+    details = "<missing>";
+
+    foreach (const QString &hash, QString::fromUtf8(fields.value("item_hashes")).split('\n', QString::SkipEmptyParts)) {
+      if (!m_knownItems.contains(hash)) {
+        details += QString("<hash>%1</hash>").arg(hash);
+      }
+    }
+
+    details += "</missing>";
+  }
+  else if (m_chunkedUploads && fields.contains("upload_id")) {
+    QString upload_id = QString::fromUtf8(fields.value("upload_id"));
+    qint64 chunk_offset = fields.value("chunk_offset").toLongLong();
+    qint64 total_size = fields.value("total_size").toLongLong();
+    qint64 stored_size = m_uploadOffsets.value(upload_id, 0);
+
+    m_receivedBytes += bundle_size;
+
+    if (chunk_offset == 0 && !fields.contains("application_name")) {
+      // Fields of the upload are expected with its first chunk.
+      status = STORE_ANSWER_NO_PARAMETERS;
+    }
+    else if (fields.value("chunk_checksum") != bundle_hash) {
+      status = STORE_ANSWER_CHECKSUM_MISMATCH;
+    }
+    else {
+      if (chunk_offset == stored_size) {
+        stored_size += bundle_size;
+      }
+
+      if (stored_size >= total_size) {
+        m_uploadOffsets.remove(upload_id);
+        m_storedBundles++;
+      }
+      else {
+        m_uploadOffsets.insert(upload_id, stored_size);
+
+        status = STORE_ANSWER_PARTIAL;
+        details = QString("<offset>%1</offset>").arg(stored_size);
+      }
+    }
+  }
+  else if (!fields.contains("application_name") || bundle_size == 0) {
+    status = STORE_ANSWER_NO_PARAMETERS;
+  }
+  else {
+    // Legacy store accepts whatever it gets as whole bundle.
+    m_receivedBytes += bundle_size;
+    m_storedBundles++;
+  }
+
+  return QString("<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+                 "<response><status>%1</status>%2</response>\n").arg(status, details).toUtf8();
+}
+
+bool FakeStoreServer::injectFailure() {
+  return m_failureRate > 0 && nextRandom(100) < m_failureRate;
+}
+
+int FakeStoreServer::nextRandom(int bound) {
+  // Simple linear congruential generator, so that failures are reproducible.
+  m_randomState = m_randomState * 1103515245 + 12345;
+  return (int) ((m_randomState >> 16) % (quint32) bound);
+}
+
+FakeStoreConnection::FakeStoreConnection(QTcpSocket *socket, FakeStoreServer *server)
+  : QObject(socket), m_socket(socket), m_server(server), m_readTimer(new QTimer(this)), m_state(ReadingHeaders),
+    m_buffer(QByteArray()), m_method(QByteArray()), m_contentLength(0), m_bodyRead(0), m_failing(false),
+    m_dropping(false), m_pendingData(QByteArray()), m_delimiter(QByteArray()), m_partBuffer(QByteArray()),
+    m_partState(PartData), m_partName(QString()), m_fields(QHash<QString, QByteArray>()),
+    m_bundleHash(QCryptographicHash::Sha1), m_bundleData(QByteArray()), m_bundleSize(0), m_response(QByteArray()) {
+  m_readTimer->setSingleShot(true);
+  m_readTimer->setInterval(FAKE_STORE_READ_INTERVAL);
+
+  if (m_server->m_bandwidthLimit > 0) {
+    // Unread data stay in system buffers, so client is slowed down by TCP itself.
+    m_socket->setReadBufferSize(qMax(m_server->m_bandwidthLimit * FAKE_STORE_READ_INTERVAL / 1000, (qint64) 1));
+  }
+
+  connect(m_socket, SIGNAL(readyRead()), this, SLOT(readData()));
+  connect(m_readTimer, SIGNAL(timeout()), this, SLOT(readData()));
+}
+
+FakeStoreConnection::~FakeStoreConnection() {
+}
+
+void FakeStoreConnection::readData() {
+  if (m_state == Responding || m_readTimer->isActive()) {
+    // Data are read once response is sent or once rate allows it.
+    return;
+  }
+
+  qint64 limit = m_server->m_bandwidthLimit;
+  QByteArray data = limit > 0 ?
+                      m_socket->read(qMax(limit * FAKE_STORE_READ_INTERVAL / 1000, (qint64) 1)) :
+                      m_socket->readAll();
+
+  if (data.isEmpty()) {
+    return;
+  }
+
+  if (limit > 0) {
+    m_readTimer->start();
+  }
+
+  processData(data);
+}
+
+void FakeStoreConnection::sendResponse() {
+  if (m_socket->state() != QAbstractSocket::ConnectedState) {
+    return;
+  }
+
+  m_socket->write(m_response);
+  reset();
+}
+
+void FakeStoreConnection::processData(QByteArray data) {
+  while (!data.isEmpty()) {
+    if (m_state == Responding) {
+      // Next request on the same connection waits for the response.
+      m_pendingData.append(data);
+      return;
+    }
+
+    if (m_state == ReadingHeaders) {
+      m_buffer.append(data);
+      data.clear();
+
+      int headers_end = m_buffer.indexOf("\r\n\r\n");
+
+      if (headers_end < 0) {
+        if (m_buffer.size() > FAKE_STORE_MAX_HEADERS) {
+          m_socket->abort();
+        }
+
+        return;
+      }
+
+      data = m_buffer.mid(headers_end + 4);
+
+      if (!parseHeaders(m_buffer.left(headers_end))) {
+        respond("HTTP/1.1 400 Bad Request\r\nContent-Length: 0\r\n\r\n");
+        return;
+      }
+
+      m_buffer.clear();
+      m_state = ReadingBody;
+
+      if (m_contentLength == 0) {
+        finishRequest();
+        continue;
+      }
+    }
+
+    QByteArray body = data.left((int) qMin((qint64) data.size(), m_contentLength - m_bodyRead));
+
+    data.remove(0, body.size());
+    m_bodyRead += body.size();
+
+    if (m_dropping && m_bodyRead * 2 >= m_contentLength) {
+      // Connection breaks in the middle of the upload.
+      m_socket->abort();
+      return;
+    }
+
+    parseBody(body);
+
+    if (m_bodyRead >= m_contentLength) {
+      finishRequest();
+    }
+  }
+}
+
+bool FakeStoreConnection::parseHeaders(const QByteArray &headers) {
+  QList<QByteArray> lines = headers.split('\n');
+  QList<QByteArray> request_line = lines.value(0).trimmed().split(' ');
+
+  if (request_line.size() < 3) {
+    return false;
+  }
+
+  m_method = request_line.at(0);
+
+  for (int i = 1; i < lines.size(); i++) {
+    QByteArray line = lines.at(i).trimmed();
+    int separator = line.indexOf(':');
+    QByteArray name = line.left(separator).trimmed().toLower();
+    QByteArray value = line.mid(separator + 1).trimmed();
+
+    if (separator < 0) {
+      continue;
+    }
+    else if (name == "content-length") {
+      m_contentLength = value.toLongLong();
+    }
+    else if (name == "content-type" && value.startsWith("multipart/form-data") && value.contains("boundary=")) {
+      QByteArray boundary = value.mid(value.indexOf("boundary=") + 9).trimmed();
+
+      if (boundary.startsWith('"')) {
+        boundary = boundary.mid(1, boundary.indexOf('"', 1) - 1);
+      }
+
+      // Body starts with delimiter without preceding line break.
+      m_delimiter = "\r\n--" + boundary;
+      m_partBuffer = "\r\n";
+    }
+  }
+
+  if (m_method == "POST") {
+    m_failing = m_server->injectFailure();
+
+    // Half of failures break the connection, the other half is answered with error.
+    m_dropping = m_failing && m_server->nextRandom(2) == 0;
+  }
+
+  return m_contentLength >= 0;
+}
+
+void FakeStoreConnection::parseBody(const QByteArray &data) {
+  if (m_delimiter.isEmpty()) {
+    m_partName = "file_content";
+    appendPartData(data);
+    return;
+  }
+
+  m_partBuffer.append(data);
+
+  forever {
+    switch (m_partState) {
+      case PartData: {
+        int delimiter_index = m_partBuffer.indexOf(m_delimiter);
+
+        if (delimiter_index < 0) {
+          // Delimiter may be split between two blocks of data.
+          int complete_size = m_partBuffer.size() - m_delimiter.size() + 1;
+
+          if (complete_size > 0) {
+            appendPartData(m_partBuffer.left(complete_size));
+            m_partBuffer.remove(0, complete_size);
+          }
+
+          return;
+        }
+
+        appendPartData(m_partBuffer.left(delimiter_index));
+        m_partBuffer.remove(0, delimiter_index + m_delimiter.size());
+        m_partState = PartDelimiter;
+        break;
+      }
+
+      case PartDelimiter:
+        if (m_partBuffer.size() < 2) {
+          return;
+        }
+
+        m_partState = m_partBuffer.startsWith("--") ? PartsFinished : PartHeaders;
+        m_partBuffer.remove(0, 2);
+        break;
+
+      case PartHeaders: {
+        int headers_end = m_partBuffer.indexOf("\r\n\r\n");
+
+        if (headers_end < 0) {
+          return;
+        }
+
+        QByteArray headers = m_partBuffer.left(headers_end);
+        int name_start = headers.indexOf("name=\"") + 6;
+
+        m_partName = name_start < 6 ?
+                       QString() :
+                       QString::fromUtf8(headers.mid(name_start, headers.indexOf('"', name_start) - name_start));
+        m_partBuffer.remove(0, headers_end + 4);
+        m_partState = PartData;
+        break;
+      }
+
+      default:
+        m_partBuffer.clear();
+        return;
+    }
+  }
+}
+
+void FakeStoreConnection::appendPartData(const QByteArray &data) {
+  if (m_partName.isEmpty() || data.isEmpty()) {
+    return;
+  }
+  else if (m_partName == "file_content") {
+    m_bundleHash.addData(data);
+    m_bundleSize += data.size();
+
+    // Only small bundles are kept, so that they can be inspected.
+    if (m_bundleSize <= FAKE_STORE_KEEP_SIZE) {
+      m_bundleData.append(data);
+    }
+    else {
+      m_bundleData.clear();
+    }
+  }
+  else if (m_fields.value(m_partName).size() + data.size() <= FAKE_STORE_KEEP_SIZE) {
+    m_fields[m_partName].append(data);
+  }
+}
+
+void FakeStoreConnection::finishRequest() {
+  QByteArray body;
+  QByteArray content_type;
+
+  if (m_failing) {
+    respond("HTTP/1.1 503 Service Unavailable\r\nContent-Length: 0\r\n\r\n");
+    return;
+  }
+  else if (m_method == "POST") {
+    body = m_server->processRequest(m_fields, m_bundleHash.result().toHex(), m_bundleData, m_bundleSize);
+    content_type = "text/xml";
+  }
+  else {
+    // Any other request is considered to be endpoint discovery.
+    body = m_server->uploadUrl().toUtf8();
+    content_type = "text/plain";
+  }
+
+  respond("HTTP/1.1 200 OK\r\nContent-Type: " + content_type + "\r\nContent-Length: " +
+          QByteArray::number(body.size()) + "\r\n\r\n" + body);
+}
+
+void FakeStoreConnection::respond(const QByteArray &response) {
+  m_state = Responding;
+  m_response = response;
+
+  // Response is always sent later, so that rest of already received
+  // data is kept for the next request.
+  QTimer::singleShot(m_server->m_latency, this, SLOT(sendResponse()));
+}
+
+void FakeStoreConnection::reset() {
+  QByteArray pending_data = m_pendingData;
+
+  m_state = ReadingHeaders;
+  m_buffer.clear();
+  m_method.clear();
+  m_contentLength = 0;
+  m_bodyRead = 0;
+  m_failing = false;
+  m_dropping = false;
+  m_pendingData.clear();
+  m_delimiter.clear();
+  m_partBuffer.clear();
+  m_partState = PartData;
+  m_partName.clear();
+  m_fields.clear();
+  m_bundleHash.reset();
+  m_bundleData.clear();
+  m_bundleSize = 0;
+  m_response.clear();
+
+  processData(pending_data);
+  readData();
+}
@@ -0,0 +1,219 @@
+/*
+  Copyright (c) 2012, BuildmLearn Contributors listed at http://buildmlearn.org/people/
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+
+  * Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+
+  * Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+
+  * Neither the name of the BuildmLearn nor the names of its
+    contributors may be used to endorse or promote products derived from
+    this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef FAKESTORESERVER_H
+#define FAKESTORESERVER_H
+
+#include <QTcpServer>
+
+#include <QHash>
+#include <QSet>
+#include <QStringList>
+#include <QByteArray>
+#include <QCryptographicHash>
+
+
+class QTcpSocket;
+class QTimer;
+
+/// \brief Local stand-in for BuildmLearn Store server.
+///
+/// Server speaks just enough HTTP/1.1 to serve uploads made by BundleUploader.
+/// Multipart requests are parsed as they arrive, bundle data are hashed and
+/// counted but not kept in memory unless they are small, so the server does not
+/// distort memory measurements of the uploading side.
+///
+/// Server answers endpoint discovery (any GET request) with its own upload URL,
+/// plain uploads, chunked uploads (if enabled) and items queries of delta uploads.
+/// Network conditions can be simulated via response latency, limited receiving
+/// rate and randomly injected failures.
+/// \see BundleUploader, StoreBenchmark
+class FakeStoreServer : public QTcpServer {
+    Q_OBJECT
+
+  public:
+    // Constructors and destructors.
+    explicit FakeStoreServer(QObject *parent = 0);
+    virtual ~FakeStoreServer();
+
+    /// \brief Starts listening on local interface.
+    /// \return Returns true if server listens.
+    bool start();
+
+    /// \brief Access to URL to which bundles are uploaded.
+    QString uploadUrl() const;
+
+    /// \brief Access to URL of endpoint discovery.
+    QString endpointUrl() const;
+
+    /// \brief Sets delay before each response.
+    /// \param latency Delay in milliseconds.
+    void setLatency(int latency);
+
+    /// \brief Sets maximal receiving rate of each connection.
+    /// \param bytes_per_second Rate limit, zero means unlimited rate.
+    void setBandwidthLimit(qint64 bytes_per_second);
+
+    /// \brief Sets probability of injected failures.
+    /// \param percent Percentage of requests which fail, failed request is either
+    /// answered with HTTP error or its connection is dropped.
+    void setFailureRate(int percent);
+
+    /// \brief Enables or disables support for chunked uploads.
+    /// \param enabled If false, server behaves like legacy store and
+    /// accepts each chunk as a whole bundle.
+    void setChunkedUploads(bool enabled);
+
+    /// \brief Sets hashes of bundle items which server already has.
+    /// \param hashes Hashes of items, all other items are reported as missing.
+    void setKnownItems(const QSet<QString> &hashes);
+
+    /// \brief Access to number of received requests.
+    int requestCount() const;
+
+    /// \brief Access to number of bundles which were accepted as complete.
+    int storedBundles() const;
+
+    /// \brief Access to number of bundle bytes received, including retried data.
+    qint64 receivedBytes() const;
+
+    /// \brief Access to fields of the last upload request.
+    QHash<QString, QByteArray> lastFields() const;
+
+    /// \brief Access to data of the last uploaded bundle or chunk.
+    /// \return Returns data or empty array if data were too large to be kept.
+    QByteArray lastBundle() const;
+
+  private slots:
+    void onNewConnection();
+
+  private:
+    friend class FakeStoreConnection;
+
+    // Creates response to complete request.
+    QByteArray processRequest(const QHash<QString, QByteArray> &fields, const QByteArray &bundle_hash,
+                              const QByteArray &bundle_data, qint64 bundle_size);
+
+    // Decides whether next request fails.
+    bool injectFailure();
+
+    // Returns next pseudo-random number, sequence is the same in each run.
+    int nextRandom(int bound);
+
+    int m_latency;
+    qint64 m_bandwidthLimit;
+    int m_failureRate;
+    quint32 m_randomState;
+    bool m_chunkedUploads;
+    QSet<QString> m_knownItems;
+    QHash<QString, qint64> m_uploadOffsets;
+    int m_requestCount;
+    int m_storedBundles;
+    qint64 m_receivedBytes;
+    QHash<QString, QByteArray> m_lastFields;
+    QByteArray m_lastBundle;
+};
+
+/// \brief Single client connection of FakeStoreServer.
+class FakeStoreConnection : public QObject {
+    Q_OBJECT
+
+  public:
+    explicit FakeStoreConnection(QTcpSocket *socket, FakeStoreServer *server);
+    virtual ~FakeStoreConnection();
+
+  private slots:
+    // Reads available data with respect to bandwidth limit.
+    void readData();
+
+    // Sends prepared response.
+    void sendResponse();
+
+  private:
+    enum State {
+      ReadingHeaders,
+      ReadingBody,
+      Responding
+    };
+
+    enum PartState {
+      PartData,
+      PartDelimiter,
+      PartHeaders,
+      PartsFinished
+    };
+
+    // Processes received data of one or more requests.
+    void processData(QByteArray data);
+
+    // Processes request headers, returns false if request is malformed.
+    bool parseHeaders(const QByteArray &headers);
+
+    // Processes part of request body.
+    void parseBody(const QByteArray &data);
+
+    // Appends data to currently parsed part.
+    void appendPartData(const QByteArray &data);
+
+    // Creates response to complete request and sends it.
+    void finishRequest();
+
+    // Prepares response and sends it after configured latency.
+    void respond(const QByteArray &response);
+
+    // Resets state for next request on the same connection.
+    void reset();
+
+    QTcpSocket *m_socket;
+    FakeStoreServer *m_server;
+    QTimer *m_readTimer;
+    State m_state;
+    QByteArray m_buffer;
+    QByteArray m_method;
+    qint64 m_contentLength;
+    qint64 m_bodyRead;
+    bool m_failing;
+    bool m_dropping;
+    QByteArray m_pendingData;
+
+    // State of multipart parser.
+    QByteArray m_delimiter;
+    QByteArray m_partBuffer;
+    PartState m_partState;
+    QString m_partName;
+    QHash<QString, QByteArray> m_fields;
+    QCryptographicHash m_bundleHash;
+    QByteArray m_bundleData;
+    qint64 m_bundleSize;
+
+    QByteArray m_response;
+};
+
+#endif // FAKESTORESERVER_H
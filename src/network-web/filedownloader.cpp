@@ -0,0 +1,559 @@
+/*
+  Copyright (c) 2012, BuildmLearn Contributors listed at http://buildmlearn.org/people/
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+
+  * Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+
+  * Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+
+  * Neither the name of the BuildmLearn nor the names of its
+    contributors may be used to endorse or promote products derived from
+    this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "network-web/filedownloader.h"
+
+#include "definitions/definitions.h"
+#include "network-web/networkfactory.h"
+#include "network-web/silentnetworkaccessmanager.h"
+
+#include <QTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QDir>
+#include <QStringList>
+#include <QCryptographicHash>
+
+
+FileDownloader::FileDownloader(QObject *parent)
+  : QObject(parent),
+    m_url(QUrl()),
+    m_targetFile(QString()),
+    m_checksum(QString()),
+    m_partKey(QString()),
+    m_totalSize(-1),
+    m_segmentCount(1),
+    m_redirects(0),
+    m_probeReply(NULL),
+    m_abortStatus(QNetworkReply::NoError),
+    m_segments(QList<Segment*>()),
+    m_replies(QHash<QNetworkReply*, Segment*>()),
+    m_timer(new QTimer(this)) {
+
+  // Timeout is disabled by default.
+  m_timer->setInterval(0);
+  m_timer->setSingleShot(true);
+
+  connect(m_timer, SIGNAL(timeout()), this, SLOT(timeout()));
+}
+
+FileDownloader::~FileDownloader() {
+  cleanup();
+}
+
+int FileDownloader::timeout() const {
+  return m_timer->interval();
+}
+
+void FileDownloader::setTimeout(int timeout) {
+  m_timer->setInterval(qMax(timeout, 0));
+}
+
+int FileDownloader::segments() const {
+  return m_segmentCount;
+}
+
+void FileDownloader::setSegments(int segments) {
+  m_segmentCount = qMax(segments, 1);
+}
+
+bool FileDownloader::isRunning() const {
+  return m_probeReply != NULL || !m_segments.isEmpty();
+}
+
+bool FileDownloader::verifyChecksum(const QString &file_path, const QString &checksum) {
+  if (checksum.isEmpty()) {
+    return true;
+  }
+
+  // Plain digest without algorithm prefix is considered to be SHA-1.
+  QString algorithm_name = checksum.contains(':') ? checksum.section(':', 0, 0).trimmed().toLower() : "sha1";
+  QString digest = checksum.section(':', -1).trimmed().toLower();
+  QCryptographicHash::Algorithm algorithm;
+
+  if (algorithm_name == "md5") {
+    algorithm = QCryptographicHash::Md5;
+  }
+  else if (algorithm_name == "sha1") {
+    algorithm = QCryptographicHash::Sha1;
+  }
+#if QT_VERSION >= 0x050000
+  else if (algorithm_name == "sha256") {
+    algorithm = QCryptographicHash::Sha256;
+  }
+#endif
+  else {
+    qWarning("Checksum algorithm '%s' is not supported.", qPrintable(algorithm_name));
+    return false;
+  }
+
+  QFile file(file_path);
+
+  if (!file.open(QIODevice::ReadOnly)) {
+    return false;
+  }
+
+  QCryptographicHash hash(algorithm);
+
+  while (!file.atEnd()) {
+    hash.addData(file.read(FILE_DOWNLOAD_BLOCK_SIZE));
+  }
+
+  bool matches = hash.result().toHex() == digest.toLatin1();
+
+  if (!matches) {
+    qWarning("Checksum of file '%s' does not match expected value '%s'.",
+             qPrintable(file_path), qPrintable(checksum));
+  }
+
+  return matches;
+}
+
+void FileDownloader::download(const QString &url, const QString &target_file, const QString &checksum) {
+  if (isRunning()) {
+    qWarning("Download of '%s' requested while another download is running.", qPrintable(url));
+    return;
+  }
+
+  m_url = QUrl(url);
+  m_targetFile = target_file;
+  m_checksum = checksum;
+  m_totalSize = -1;
+
+  // Partial data are bound to exact file, which is identified by its checksum
+  // or at least by its original URL.
+  m_partKey = QString(QCryptographicHash::hash(checksum.isEmpty() ? url.toUtf8() : checksum.trimmed().toLower().toUtf8(),
+                                               QCryptographicHash::Sha1).toHex().left(16));
+  m_redirects = 0;
+  m_abortStatus = QNetworkReply::NoError;
+
+  if (m_segmentCount > 1) {
+    // Find out whether server supports ranges and what is the size of the file.
+    m_probeReply = NetworkFactory::sharedNetworkManager()->head(createRequest(m_url));
+    connect(m_probeReply, SIGNAL(finished()), this, SLOT(probeFinished()));
+
+    if (m_timer->interval() > 0) {
+      m_timer->start();
+    }
+  }
+  else {
+    startSegments(false);
+  }
+}
+
+void FileDownloader::cancel() {
+  if (isRunning()) {
+    finish(QNetworkReply::OperationCanceledError);
+  }
+}
+
+void FileDownloader::probeFinished() {
+  QNetworkReply *reply = qobject_cast<QNetworkReply*>(sender());
+
+  if (reply == NULL || reply != m_probeReply) {
+    return;
+  }
+
+  m_timer->stop();
+  m_probeReply = NULL;
+  reply->deleteLater();
+
+  QUrl redirection_url = reply->attribute(QNetworkRequest::RedirectionTargetAttribute).toUrl();
+
+  if (redirection_url.isValid() && reply->error() == QNetworkReply::NoError && m_redirects < DOWNLOAD_MAX_REDIRECTS) {
+    // Segments will be downloaded directly from final location.
+    m_url = reply->url().resolved(redirection_url);
+    m_redirects++;
+
+    m_probeReply = NetworkFactory::sharedNetworkManager()->head(createRequest(m_url));
+    connect(m_probeReply, SIGNAL(finished()), this, SLOT(probeFinished()));
+
+    if (m_timer->interval() > 0) {
+      m_timer->start();
+    }
+  }
+  else if (reply->error() == QNetworkReply::NoError) {
+    QVariant content_length = reply->header(QNetworkRequest::ContentLengthHeader);
+
+    if (content_length.isValid()) {
+      m_totalSize = content_length.toLongLong();
+    }
+
+    startSegments(reply->rawHeader("Accept-Ranges").trimmed() == "bytes" && m_totalSize > 0);
+  }
+  else {
+    // Some servers do not answer HEAD requests, try plain download.
+    qDebug("Probing of '%s' failed, file will be downloaded in one piece.", qPrintable(m_url.toString()));
+    startSegments(false);
+  }
+}
+
+void FileDownloader::segmentReadyRead() {
+  QNetworkReply *reply = qobject_cast<QNetworkReply*>(sender());
+  Segment *segment = m_replies.value(reply, NULL);
+
+  if (segment == NULL) {
+    return;
+  }
+
+  if (m_timer->interval() > 0) {
+    m_timer->start();
+  }
+
+  int status_code = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+
+  if (status_code >= 300) {
+    // Bodies of redirections and errors are not part of the file.
+    reply->readAll();
+    return;
+  }
+
+  if (!segment->m_validated) {
+    if (status_code == 200 && segment->m_start == 0 && segment->m_end < 0) {
+      // Server ignored our range, so whole file is coming again.
+      if (segment->m_file->size() > 0) {
+        qDebug("Server does not support resuming of '%s', restarting download.", qPrintable(reply->url().toString()));
+        segment->m_file->resize(0);
+      }
+    }
+    else if (status_code != 206) {
+      qWarning("Server ignored range request for segment of '%s', file will be downloaded in one piece.",
+               qPrintable(reply->url().toString()));
+
+      // Segments are dropped, segment is not valid anymore then.
+      cleanup();
+      startSegments(false);
+      return;
+    }
+
+    if (m_totalSize < 0) {
+      QVariant content_length = reply->header(QNetworkRequest::ContentLengthHeader);
+
+      if (content_length.isValid()) {
+        m_totalSize = segment->m_file->size() + content_length.toLongLong();
+      }
+    }
+
+    segment->m_validated = true;
+  }
+
+  QByteArray data = reply->readAll();
+
+  if (segment->m_end >= 0) {
+    // Never write past the end of the segment.
+    data.truncate((int) qMax(segment->m_end - segment->m_start + 1 - segment->m_file->size(), Q_INT64_C(0)));
+  }
+
+  if (segment->m_file->write(data) != data.size()) {
+    qWarning("Cannot write downloaded data into file '%s'.", qPrintable(segment->m_file->fileName()));
+
+    m_abortStatus = QNetworkReply::UnknownContentError;
+    reply->abort();
+    return;
+  }
+
+  reportProgress();
+}
+
+void FileDownloader::segmentFinished() {
+  QNetworkReply *reply = qobject_cast<QNetworkReply*>(sender());
+  Segment *segment = m_replies.take(reply);
+
+  if (segment == NULL) {
+    return;
+  }
+
+  segment->m_reply = NULL;
+  reply->deleteLater();
+
+  QUrl redirection_url = reply->attribute(QNetworkRequest::RedirectionTargetAttribute).toUrl();
+
+  if (redirection_url.isValid() && reply->error() == QNetworkReply::NoError && segment->m_redirects < DOWNLOAD_MAX_REDIRECTS) {
+    segment->m_redirects++;
+    startSegment(segment, reply->url().resolved(redirection_url));
+    return;
+  }
+
+  QNetworkReply::NetworkError reply_error = reply->error();
+
+  if (reply_error == QNetworkReply::OperationCanceledError && m_abortStatus != QNetworkReply::NoError) {
+    // Reply was aborted by us, report real reason.
+    reply_error = m_abortStatus;
+  }
+  else if (reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt() == 416 &&
+           segment->m_end < 0 && segment->m_file->size() > 0) {
+    // Requested range starts past the end of the file, it is already complete.
+    reply_error = QNetworkReply::NoError;
+  }
+
+  if (reply_error != QNetworkReply::NoError) {
+    finish(reply_error);
+  }
+  else if (m_replies.isEmpty()) {
+    finalize();
+  }
+}
+
+void FileDownloader::timeout() {
+  qWarning("Download of '%s' timed out.", qPrintable(m_url.toString()));
+  finish(QNetworkReply::TimeoutError);
+}
+
+void FileDownloader::startSegments(bool ranges_supported) {
+  int count = ranges_supported ? m_segmentCount : 1;
+
+  if (m_totalSize / count < FILE_DOWNLOAD_BLOCK_SIZE) {
+    // Splitting small files is not worth it.
+    count = 1;
+  }
+
+  qint64 segment_size = count > 1 ? m_totalSize / count : -1;
+  QStringList segment_files;
+
+  for (int i = 0; i < count; i++) {
+    segment_files.append(count == 1 ? partFileName() : segmentFileName(i, count));
+  }
+
+  removeStaleSegments(segment_files);
+
+  for (int i = 0; i < count; i++) {
+    Segment *segment = new Segment();
+
+    segment->m_start = i * segment_size;
+    segment->m_end = count == 1 ? -1 : (i == count - 1 ? m_totalSize - 1 : (i + 1) * segment_size - 1);
+    segment->m_validated = false;
+    segment->m_redirects = 0;
+    segment->m_reply = NULL;
+    segment->m_file = new QFile(segment_files.at(i));
+
+    m_segments.append(segment);
+
+    if (!segment->m_file->open(QIODevice::ReadWrite | QIODevice::Append)) {
+      qWarning("Cannot open file '%s' for download.", qPrintable(segment->m_file->fileName()));
+      finish(QNetworkReply::UnknownContentError);
+      return;
+    }
+  }
+
+  foreach (Segment *segment, m_segments) {
+    if (segment->m_end >= 0 && segment->m_file->size() >= segment->m_end - segment->m_start + 1) {
+      // This segment was completed in previous session.
+      continue;
+    }
+
+    startSegment(segment, m_url);
+  }
+
+  reportProgress();
+
+  if (m_replies.isEmpty()) {
+    finalize();
+  }
+}
+
+void FileDownloader::removeStaleSegments(const QStringList &segment_files) {
+  QFileInfo part_file(partFileName());
+  QDir part_directory = part_file.absoluteDir();
+  QStringList part_files = part_directory.entryList(QStringList() << part_file.fileName() + "*", QDir::Files);
+
+  foreach (const QString &file_name, part_files) {
+    QString file_path = part_directory.absoluteFilePath(file_name);
+    bool used = false;
+
+    foreach (const QString &segment_file, segment_files) {
+      if (QFileInfo(segment_file).absoluteFilePath() == file_path) {
+        used = true;
+        break;
+      }
+    }
+
+    if (!used) {
+      // Data of segments with different layout cannot be resumed.
+      qDebug("Removing stale partial file '%s'.", qPrintable(file_path));
+      part_directory.remove(file_name);
+    }
+  }
+}
+
+void FileDownloader::startSegment(Segment *segment, const QUrl &url) {
+  QNetworkRequest request = createRequest(url);
+  qint64 offset = segment->m_start + segment->m_file->size();
+
+  if (offset > 0 || segment->m_end >= 0) {
+    request.setRawHeader("Range", QString("bytes=%1-%2").arg(QString::number(offset),
+                                                             segment->m_end >= 0 ?
+                                                               QString::number(segment->m_end) :
+                                                               QString()).toLatin1());
+  }
+
+  segment->m_validated = false;
+  segment->m_reply = NetworkFactory::sharedNetworkManager()->get(request);
+  m_replies.insert(segment->m_reply, segment);
+
+  connect(segment->m_reply, SIGNAL(readyRead()), this, SLOT(segmentReadyRead()));
+  connect(segment->m_reply, SIGNAL(finished()), this, SLOT(segmentFinished()));
+
+  if (m_timer->interval() > 0) {
+    m_timer->start();
+  }
+}
+
+void FileDownloader::finalize() {
+  m_timer->stop();
+
+  QString part_file_name = partFileName();
+
+  foreach (Segment *segment, m_segments) {
+    segment->m_file->close();
+  }
+
+  if (m_segments.size() > 1) {
+    // Join segments into single file.
+    QFile part_file(part_file_name);
+
+    if (!part_file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+      finish(QNetworkReply::UnknownContentError);
+      return;
+    }
+
+    foreach (Segment *segment, m_segments) {
+      if (segment->m_file->size() != segment->m_end - segment->m_start + 1 || !segment->m_file->open(QIODevice::ReadOnly)) {
+        qWarning("Segment file '%s' is incomplete.", qPrintable(segment->m_file->fileName()));
+
+        segment->m_file->remove();
+        part_file.remove();
+        finish(QNetworkReply::UnknownContentError);
+        return;
+      }
+
+      while (!segment->m_file->atEnd()) {
+        part_file.write(segment->m_file->read(FILE_DOWNLOAD_BLOCK_SIZE));
+      }
+
+      segment->m_file->close();
+    }
+
+    part_file.close();
+
+    foreach (Segment *segment, m_segments) {
+      segment->m_file->remove();
+    }
+  }
+
+  if (!verifyChecksum(part_file_name, m_checksum)) {
+    // Corrupted file cannot be resumed, next download starts from scratch.
+    QFile::remove(part_file_name);
+    finish(QNetworkReply::UnknownContentError);
+    return;
+  }
+
+  // Replace target file with downloaded one.
+  if (QFile::exists(m_targetFile) && !QFile::remove(m_targetFile)) {
+    qWarning("Cannot replace existing file '%s'.", qPrintable(m_targetFile));
+    finish(QNetworkReply::UnknownContentError);
+    return;
+  }
+
+  if (!QFile::rename(part_file_name, m_targetFile)) {
+    qWarning("Cannot move downloaded file to '%s'.", qPrintable(m_targetFile));
+    finish(QNetworkReply::UnknownContentError);
+    return;
+  }
+
+  finish(QNetworkReply::NoError);
+}
+
+void FileDownloader::finish(QNetworkReply::NetworkError status) {
+  cleanup();
+
+  qDebug("Download of '%s' into '%s' finished with status '%s' (code %d).",
+         qPrintable(m_url.toString()),
+         qPrintable(m_targetFile),
+         qPrintable(NetworkFactory::networkErrorText(status)),
+         status);
+
+  emit completed(status, m_targetFile);
+}
+
+void FileDownloader::cleanup() {
+  m_timer->stop();
+  m_abortStatus = QNetworkReply::NoError;
+
+  // Replies belong to shared manager, make sure they do not outlive us.
+  if (m_probeReply != NULL) {
+    m_probeReply->disconnect(this);
+    m_probeReply->abort();
+    m_probeReply->deleteLater();
+    m_probeReply = NULL;
+  }
+
+  foreach (QNetworkReply *reply, m_replies.keys()) {
+    reply->disconnect(this);
+    reply->abort();
+    reply->deleteLater();
+  }
+
+  // Partially downloaded data stay on disk, so they can be resumed.
+  foreach (Segment *segment, m_segments) {
+    delete segment->m_file;
+  }
+
+  qDeleteAll(m_segments);
+  m_segments.clear();
+  m_replies.clear();
+}
+
+void FileDownloader::reportProgress() {
+  qint64 bytes_received = 0;
+
+  foreach (Segment *segment, m_segments) {
+    bytes_received += segment->m_file->size();
+  }
+
+  emit progress(bytes_received, m_totalSize);
+}
+
+QString FileDownloader::partFileName() const {
+  return m_targetFile + "." + m_partKey + ".part";
+}
+
+QString FileDownloader::segmentFileName(int index, int count) const {
+  return partFileName() + QString(".%1-%2").arg(QString::number(index + 1), QString::number(count));
+}
+
+QNetworkRequest FileDownloader::createRequest(const QUrl &url) const {
+  QNetworkRequest request(url);
+
+  // Large files are stored by us, keep them out of network cache.
+  request.setAttribute(QNetworkRequest::CacheLoadControlAttribute, QNetworkRequest::AlwaysNetwork);
+  request.setAttribute(QNetworkRequest::CacheSaveControlAttribute, false);
+
+  return request;
+}
@@ -0,0 +1,184 @@
+/*
+  Copyright (c) 2012, BuildmLearn Contributors listed at http://buildmlearn.org/people/
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+
+  * Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+
+  * Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+
+  * Neither the name of the BuildmLearn nor the names of its
+    contributors may be used to endorse or promote products derived from
+    this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef FILEDOWNLOADER_H
+#define FILEDOWNLOADER_H
+
+#include <QObject>
+
+#include <QNetworkReply>
+#include <QHash>
+#include <QList>
+
+
+class QTimer;
+class QFile;
+
+/// \brief Downloader which streams (possibly large) files directly to disk.
+///
+/// Data are written into "<target>.<key>.part" file as they arrive, so interrupted
+/// download can be resumed later via HTTP Range requests. Key is derived from
+/// expected checksum or, if there is none, from URL, so that data of different
+/// files are never mixed. If server supports ranges, file can be optionally
+/// fetched in several parallel segments, it falls back to single segment
+/// if server then ignores range of some segment.
+/// Once whole file is obtained, its checksum is verified and the file
+/// is renamed to its final name.
+///
+/// All operations are asynchronous, result is always reported
+/// via completed() signal, even if operation is cancelled or times out.
+class FileDownloader : public QObject {
+    Q_OBJECT
+
+  public:
+    /// \brief Constructor.
+    /// \param parent Parent to this instance.
+    explicit FileDownloader(QObject *parent = 0);
+    virtual ~FileDownloader();
+
+    /// \brief Access to inactivity timeout.
+    /// \return Returns number of milliseconds without any progress after which
+    /// running download is aborted, zero means that timeout is disabled.
+    int timeout() const;
+
+    /// \brief Sets inactivity timeout.
+    /// \param timeout Timeout in milliseconds, zero disables it.
+    void setTimeout(int timeout);
+
+    /// \brief Access to number of parallel segments.
+    /// \return Returns number of segments file is split into if
+    /// server supports range requests.
+    int segments() const;
+
+    /// \brief Sets number of parallel segments.
+    /// \param segments Number of segments, one disables segmenting.
+    /// \remarks Partially downloaded file can be resumed only with the same
+    /// number of segments it was started with, data of other segments are removed.
+    void setSegments(int segments);
+
+    /// \brief Indication of running download.
+    /// \return Returns true if download is in progress.
+    bool isRunning() const;
+
+    /// \brief Verifies checksum of given file.
+    /// \param file_path Path to the file.
+    /// \param checksum Expected checksum in form "algorithm:hex_digest",
+    /// supported algorithms are "md5", "sha1" and (with Qt 5) "sha256".
+    /// \return Returns true if checksum matches or if it is empty.
+    static bool verifyChecksum(const QString &file_path, const QString &checksum);
+
+  public slots:
+    /// \brief Starts asynchronous download of given file.
+    /// \param url URL of file to be downloaded.
+    /// \param target_file Path of file in which downloaded data are stored.
+    /// \param checksum Expected checksum of the file, see verifyChecksum().
+    void download(const QString &url, const QString &target_file, const QString &checksum = QString());
+
+    /// \brief Cancels running download.
+    /// \remarks Partially downloaded data are kept for later resuming,
+    /// completed() is emitted with QNetworkReply::OperationCanceledError.
+    void cancel();
+
+  signals:
+    /// \brief Emitted when new progress is known.
+    /// \param bytes_received Number of bytes stored on disk, including resumed data.
+    /// \param bytes_total Number of bytes total, -1 if unknown.
+    void progress(qint64 bytes_received, qint64 bytes_total);
+
+    /// \brief Emitted if download completes (un)successfully.
+    /// \param status Status of download, QNetworkReply::UnknownContentError
+    /// is reported if checksum of downloaded file does not match.
+    /// \param file_path Path to downloaded file.
+    void completed(QNetworkReply::NetworkError status, const QString &file_path);
+
+  private slots:
+    // Called when server answers HEAD request.
+    void probeFinished();
+
+    // Called when some segment receives new data.
+    void segmentReadyRead();
+
+    // Called when some segment is completed.
+    void segmentFinished();
+
+    // Called when download times out.
+    void timeout();
+
+  private:
+    struct Segment {
+        qint64 m_start;
+        qint64 m_end;
+        bool m_validated;
+        int m_redirects;
+        QFile *m_file;
+        QNetworkReply *m_reply;
+    };
+
+    // Splits file into segments and starts them.
+    void startSegments(bool ranges_supported);
+
+    // Removes partial files which do not belong to given segments.
+    void removeStaleSegments(const QStringList &segment_files);
+
+    // Issues request for remaining data of given segment.
+    void startSegment(Segment *segment, const QUrl &url);
+
+    // Joins segments, checks the file and moves it to target location.
+    void finalize();
+
+    // Aborts remaining requests and reports result.
+    void finish(QNetworkReply::NetworkError status);
+
+    // Aborts all requests and releases segments.
+    void cleanup();
+
+    // Emits progress of all segments.
+    void reportProgress();
+
+    QString partFileName() const;
+    QString segmentFileName(int index, int count) const;
+    QNetworkRequest createRequest(const QUrl &url) const;
+
+  private:
+    QUrl m_url;
+    QString m_targetFile;
+    QString m_checksum;
+    QString m_partKey;
+    qint64 m_totalSize;
+    int m_segmentCount;
+    int m_redirects;
+    QNetworkReply *m_probeReply;
+    QNetworkReply::NetworkError m_abortStatus;
+    QList<Segment*> m_segments;
+    QHash<QNetworkReply*, Segment*> m_replies;
+    QTimer *m_timer;
+};
+
+#endif // FILEDOWNLOADER_H
@@ -33,13 +33,22 @@
 
 #include "definitions/definitions.h"
 #include "miscellaneous/settings.h"
+#include "miscellaneous/application.h"
 #include "network-web/silentnetworkaccessmanager.h"
+#include "network-web/downloader.h"
 
-#include <QEventLoop>
-#include <QTimer>
 #include <QIcon>
 #include <QPixmap>
 #include <QTextDocument>
+#include <QThreadStorage>
+#include <QThread>
+#include <QNetworkDiskCache>
+#include <QFileInfo>
+#include <QDir>
+
+
+// Network access managers, one per thread.
+static QThreadStorage<SilentNetworkAccessManager*> s_networkManagers;
 
 
 NetworkFactory::NetworkFactory() {
@@ -109,103 +118,44 @@ QString NetworkFactory::networkErrorText(QNetworkReply::NetworkError error_code)
   }
 }
 
-QNetworkReply::NetworkError NetworkFactory::downloadFile(const QString &url,
-                                                             int timeout,
-                                                             QByteArray &output,
-                                                             bool protected_contents,
-                                                             const QString &username,
-                                                             const QString &password) {
-  // Original asynchronous behavior of QNetworkAccessManager
-  // is replaced by synchronous behavior in order to make
-  // process of downloading of a file easier to understand.
-
-  // Make necessary variables.
-  SilentNetworkAccessManager manager;
-  QEventLoop loop;
-  QTimer timer;
-  QNetworkRequest request;
-  QNetworkReply *reply;
-  QObject originatingObject;
-
-  // Set credential information as originating object.
-  originatingObject.setProperty("protected", protected_contents);
-  originatingObject.setProperty("username", username);
-  originatingObject.setProperty("password", password);
-  request.setOriginatingObject(&originatingObject);
-
-  // Set url for this reques.
-  request.setUrl(url);
-
-  // Create necessary connections.
-  // TODO: Edited, maybe remove this line.
-  QObject::connect(qApp, SIGNAL(aboutToQuit()), &loop, SLOT(quit()));
-  QObject::connect(&timer, SIGNAL(timeout()), &loop, SLOT(quit()));
-  QObject::connect(&manager, SIGNAL(finished(QNetworkReply*)), &loop, SLOT(quit()));
-
-  forever {
-    // This timer fires just ONCE.
-    timer.setSingleShot(true);
-
-    // Try to open communication channel.
-    reply = manager.get(request);
-
-    // Start the timeout timer.
-    timer.start(timeout);
-
-    // Enter the event loop.
-    loop.exec();
-
-    // At this point one of two things happened:
-    //  a) file download was completed,
-    //  b) communication timed-out.
-
-    if (timer.isActive()) {
-      // Download is complete because timer is still running.
-      timer.stop();
-    }
-    else {
-      if (reply != NULL) {
-        delete reply;
-        reply = NULL;
-      }
-
-      // Timer already fired. Download is NOT successful.
-      return QNetworkReply::TimeoutError;
-    }
-
-    // In this phase, some part of downloading process is completed.
-    QUrl redirection_url = reply->attribute(QNetworkRequest::RedirectionTargetAttribute).toUrl();
+SilentNetworkAccessManager *NetworkFactory::sharedNetworkManager() {
+  if (!s_networkManagers.hasLocalData()) {
+    // Storage deletes the manager when its thread finishes.
+    SilentNetworkAccessManager *manager = new SilentNetworkAccessManager();
 
-    if (redirection_url.isValid()) {
-      // Communication indicates that HTTP redirection is needed.
-      // Setup redirection URL and download again.
-      request.setUrl(redirection_url);
+    if (QThread::currentThread() == qApp->thread()) {
+      // Disk cache cannot be shared among threads, only
+      // manager of main thread gets it.
+      QNetworkDiskCache *cache = new QNetworkDiskCache(manager);
 
-      delete reply;
-      reply = NULL;
-    }
-    else {
-      // No redirection is indicated. Final file is obtained
-      // in our "reply" object.
-      break;
+      cache->setCacheDirectory(cacheDirectory());
+      cache->setMaximumCacheSize(qApp->settings()->value(APP_CFG_GEN, "network_cache_size",
+                                                         NETWORK_CACHE_SIZE).toLongLong() * 1024 * 1024);
+      manager->setCache(cache);
     }
+
+    s_networkManagers.setLocalData(manager);
   }
 
-  // Read the data into output buffer.
-  output = reply->readAll();
+  return s_networkManagers.localData();
+}
 
-  QNetworkReply::NetworkError reply_error = reply->error();
+QString NetworkFactory::cacheDirectory() {
+  return QFileInfo(qApp->settings()->fileName()).absolutePath() + QDir::separator() + NETWORK_CACHE_PATH;
+}
 
-  qDebug("File '%s' fetched with status '%s' (code %d).",
-         qPrintable(url),
-         qPrintable(networkErrorText(reply_error)),
-         reply_error);
+Downloader *NetworkFactory::downloadFileAsync(const QString &url,
+                                              int timeout,
+                                              bool protected_contents,
+                                              const QString &username,
+                                              const QString &password) {
+  Downloader *downloader = new Downloader();
 
-  // Delete needed stuff and exit.
-  if (reply != NULL) {
-    delete reply;
-    reply = NULL;
-  }
+  QObject::connect(downloader, SIGNAL(completed(QNetworkReply::NetworkError,QByteArray)),
+                   downloader, SLOT(deleteLater()));
+
+  downloader->setTimeout(timeout);
+  downloader->downloadFile(url, protected_contents, username, password);
 
-  return reply_error;
+  return downloader;
 }
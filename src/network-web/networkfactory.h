@@ -32,10 +32,15 @@
 #ifndef NETWORKFACTORY_H
 #define NETWORKFACTORY_H
 
+#include "definitions/definitions.h"
+
 #include <QNetworkReply>
 #include <QCoreApplication>
 
 
+class SilentNetworkAccessManager;
+class Downloader;
+
 /// \brief Network-related functionality.
 class NetworkFactory {
     Q_DECLARE_TR_FUNCTIONS(NetworkFactory)
@@ -50,20 +55,31 @@ class NetworkFactory {
     /// \return Returns human readable text for given network error.
     static QString networkErrorText(QNetworkReply::NetworkError error_code);
 
-    /// \brief Performs SYNCHRONOUS download of file with given URL and given timeout.
+    /// \brief Gets network access manager shared by all network operations of calling thread.
+    /// \remarks Each thread gets its own manager, which is destroyed together with the thread.
+    /// Reusing single manager allows reusing of established (keep-alive) connections to hosts.
+    /// \return Returns network access manager of calling thread.
+    static SilentNetworkAccessManager *sharedNetworkManager();
+
+    /// \brief Gets directory of persistent HTTP cache.
+    /// \return Returns directory of persistent HTTP cache.
+    static QString cacheDirectory();
+
+    /// \brief Starts ASYNCHRONOUS download of file with given URL.
     /// \param url Url.
-    /// \param timeout Download timeout.
-    /// \param output Output to store data to.
+    /// \param timeout Inactivity timeout of the download.
     /// \param protected_contents Is destination URL protected?
     /// \param username Username.
     /// \param password Password.
-    /// \return Returns indication of network status after the donwload finished.
-    static QNetworkReply::NetworkError downloadFile(const QString &url,
-                                                        int timeout,
-                                                        QByteArray &output,
-                                                        bool protected_contents = false,
-                                                        const QString &username = QString(),
-                                                        const QString &password = QString());
+    /// \return Returns running downloader. Connect to its Downloader::completed()
+    /// and Downloader::progress() signals, download can be aborted via Downloader::cancel().
+    /// \remarks Downloader deletes itself after it emits Downloader::completed(). Redirections
+    /// are followed. If parent is set to the downloader, it is aborted when the parent is destroyed.
+    static Downloader *downloadFileAsync(const QString &url,
+                                         int timeout = DOWNLOAD_TIMEOUT,
+                                         bool protected_contents = false,
+                                         const QString &username = QString(),
+                                         const QString &password = QString());
 };
 
 #endif // NETWORKFACTORY_H
@@ -0,0 +1,229 @@
+/*
+  Copyright (c) 2012, BuildmLearn Contributors listed at http://buildmlearn.org/people/
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+
+  * Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+
+  * Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+
+  * Neither the name of the BuildmLearn nor the names of its
+    contributors may be used to endorse or promote products derived from
+    this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "network-web/networkmetrics.h"
+
+#include "definitions/definitions.h"
+#include "miscellaneous/application.h"
+#include "miscellaneous/performancemonitor.h"
+
+#include <QMutexLocker>
+
+
+QPointer<NetworkMetrics> NetworkMetrics::s_instance;
+
+NetworkRequestMetrics::NetworkRequestMetrics()
+  : m_url(QString()), m_operation(QString()), m_started(QDateTime()),
+    m_connectionTime(-1), m_uploadTime(-1), m_firstByteTime(-1), m_transferTime(-1), m_totalTime(-1),
+    m_bytesSent(0), m_bytesReceived(0), m_redirects(0), m_httpStatus(0), m_fromCache(false),
+    m_error(QNetworkReply::NoError) {
+}
+
+NetworkMetrics::NetworkMetrics(QObject *parent)
+  : QObject(parent), m_records(QList<NetworkRequestMetrics>()), m_redirections(QHash<QString, int>()) {
+}
+
+NetworkMetrics::~NetworkMetrics() {
+  qDebug("Destroying NetworkMetrics instance.");
+}
+
+NetworkMetrics *NetworkMetrics::instance() {
+  if (s_instance.isNull()) {
+    s_instance = new NetworkMetrics(qApp);
+  }
+
+  return s_instance;
+}
+
+void NetworkMetrics::trackReply(QNetworkReply *reply, QNetworkAccessManager::Operation operation) {
+  new NetworkReplyTracker(reply, operation, takeRedirections(reply->url()));
+}
+
+QList<NetworkRequestMetrics> NetworkMetrics::records() const {
+  QMutexLocker locker(&m_mutex);
+  return m_records;
+}
+
+void NetworkMetrics::clear() {
+  m_mutex.lock();
+  m_records.clear();
+  m_mutex.unlock();
+
+  emit recordsChanged();
+}
+
+void NetworkMetrics::addRecord(const NetworkRequestMetrics &record) {
+  qDebug("Network request finished: operation=%s url='%s' status=%d error=%d cache=%d redirects=%d "
+         "connection_ms=%lld upload_ms=%lld first_byte_ms=%lld transfer_ms=%lld total_ms=%lld "
+         "bytes_sent=%lld bytes_received=%lld",
+         qPrintable(record.m_operation),
+         qPrintable(record.m_url),
+         record.m_httpStatus,
+         (int) record.m_error,
+         (int) record.m_fromCache,
+         record.m_redirects,
+         record.m_connectionTime,
+         record.m_uploadTime,
+         record.m_firstByteTime,
+         record.m_transferTime,
+         record.m_totalTime,
+         record.m_bytesSent,
+         record.m_bytesReceived);
+
+  m_mutex.lock();
+  m_records.append(record);
+
+  while (m_records.size() > NETWORK_METRICS_HISTORY) {
+    m_records.removeFirst();
+  }
+
+  m_mutex.unlock();
+
+  // Requests may finish in worker threads, listeners are always notified
+  // from the thread of this object.
+  QMetaObject::invokeMethod(this, "recordsChanged", Qt::QueuedConnection);
+}
+
+void NetworkMetrics::addRedirection(const QUrl &target, int redirects) {
+  QMutexLocker locker(&m_mutex);
+
+  // Targets which are never followed must not pile up.
+  if (m_redirections.size() >= NETWORK_METRICS_HISTORY) {
+    m_redirections.clear();
+  }
+
+  m_redirections.insert(target.toString(), redirects);
+}
+
+int NetworkMetrics::takeRedirections(const QUrl &url) {
+  QMutexLocker locker(&m_mutex);
+  return m_redirections.take(url.toString());
+}
+
+NetworkReplyTracker::NetworkReplyTracker(QNetworkReply *reply, QNetworkAccessManager::Operation operation, int redirects)
+  : QObject(reply), m_reply(reply), m_timer(QElapsedTimer()), m_metrics(NetworkRequestMetrics()) {
+  m_timer.start();
+
+  m_metrics.m_url = reply->url().toString();
+  m_metrics.m_started = QDateTime::currentDateTime();
+  m_metrics.m_redirects = redirects;
+
+  switch (operation) {
+    case QNetworkAccessManager::HeadOperation:
+      m_metrics.m_operation = "HEAD";
+      break;
+
+    case QNetworkAccessManager::GetOperation:
+      m_metrics.m_operation = "GET";
+      break;
+
+    case QNetworkAccessManager::PutOperation:
+      m_metrics.m_operation = "PUT";
+      break;
+
+    case QNetworkAccessManager::PostOperation:
+      m_metrics.m_operation = "POST";
+      break;
+
+    case QNetworkAccessManager::DeleteOperation:
+      m_metrics.m_operation = "DELETE";
+      break;
+
+    default:
+      m_metrics.m_operation = reply->request().attribute(QNetworkRequest::CustomVerbAttribute).toString();
+      break;
+  }
+
+#if QT_VERSION >= 0x050100
+  connect(reply, SIGNAL(encrypted()), this, SLOT(onEncrypted()));
+#endif
+  connect(reply, SIGNAL(metaDataChanged()), this, SLOT(onMetaDataChanged()));
+  connect(reply, SIGNAL(uploadProgress(qint64,qint64)), this, SLOT(onUploadProgress(qint64,qint64)));
+  connect(reply, SIGNAL(downloadProgress(qint64,qint64)), this, SLOT(onDownloadProgress(qint64,qint64)));
+  connect(reply, SIGNAL(finished()), this, SLOT(onFinished()));
+}
+
+NetworkReplyTracker::~NetworkReplyTracker() {
+}
+
+void NetworkReplyTracker::onEncrypted() {
+  if (m_metrics.m_connectionTime < 0) {
+    m_metrics.m_connectionTime = m_timer.elapsed();
+  }
+}
+
+void NetworkReplyTracker::onMetaDataChanged() {
+  if (m_metrics.m_firstByteTime < 0) {
+    m_metrics.m_firstByteTime = m_timer.elapsed();
+  }
+}
+
+void NetworkReplyTracker::onUploadProgress(qint64 bytes_sent, qint64 bytes_total) {
+  m_metrics.m_bytesSent = bytes_sent;
+
+  if (m_metrics.m_uploadTime < 0 && bytes_total > 0 && bytes_sent == bytes_total) {
+    m_metrics.m_uploadTime = m_timer.elapsed();
+  }
+}
+
+void NetworkReplyTracker::onDownloadProgress(qint64 bytes_received, qint64 bytes_total) {
+  Q_UNUSED(bytes_total)
+
+  m_metrics.m_bytesReceived = bytes_received;
+}
+
+void NetworkReplyTracker::onFinished() {
+  m_metrics.m_totalTime = m_timer.elapsed();
+
+  if (PerformanceMonitor::isEnabled()) {
+    PerformanceMonitor::record("network.request", m_metrics.m_totalTime * 1000);
+    PerformanceMonitor::count("network.bytesReceived", m_metrics.m_bytesReceived);
+    PerformanceMonitor::count("network.bytesSent", m_metrics.m_bytesSent);
+  }
+
+  if (m_metrics.m_firstByteTime >= 0) {
+    m_metrics.m_transferTime = m_metrics.m_totalTime - m_metrics.m_firstByteTime;
+  }
+
+  m_metrics.m_httpStatus = m_reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+  m_metrics.m_fromCache = m_reply->attribute(QNetworkRequest::SourceIsFromCacheAttribute).toBool();
+  m_metrics.m_error = m_reply->error();
+
+  QUrl redirection_url = m_reply->attribute(QNetworkRequest::RedirectionTargetAttribute).toUrl();
+
+  if (redirection_url.isValid()) {
+    NetworkMetrics::instance()->addRedirection(m_reply->url().resolved(redirection_url), m_metrics.m_redirects + 1);
+  }
+
+  NetworkMetrics::instance()->addRecord(m_metrics);
+
+  // Only first "finished" signal matters.
+  disconnect(m_reply, 0, this, 0);
+}
@@ -0,0 +1,165 @@
+/*
+  Copyright (c) 2012, BuildmLearn Contributors listed at http://buildmlearn.org/people/
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+
+  * Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+
+  * Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+
+  * Neither the name of the BuildmLearn nor the names of its
+    contributors may be used to endorse or promote products derived from
+    this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef NETWORKMETRICS_H
+#define NETWORKMETRICS_H
+
+#include <QObject>
+
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include <QElapsedTimer>
+#include <QDateTime>
+#include <QPointer>
+#include <QMutex>
+#include <QList>
+#include <QHash>
+
+
+/// \brief Timing information about single network request.
+///
+/// All times are in milliseconds since the request was created,
+/// -1 means that particular phase did not happen or is unknown.
+/// \note QNetworkAccessManager does not report queueing, DNS lookup and TCP
+/// connection separately, they are all included in time to first byte
+/// (and in connection time for encrypted connections).
+class NetworkRequestMetrics {
+  public:
+    explicit NetworkRequestMetrics();
+
+    QString m_url;
+    QString m_operation;
+    QDateTime m_started;
+
+    // Moment when TLS handshake was completed (Qt 5 only).
+    qint64 m_connectionTime;
+
+    // Moment when whole request body was sent.
+    qint64 m_uploadTime;
+
+    // Moment when response headers arrived.
+    qint64 m_firstByteTime;
+
+    // Time between response headers and end of the reply.
+    qint64 m_transferTime;
+    qint64 m_totalTime;
+
+    qint64 m_bytesSent;
+    qint64 m_bytesReceived;
+    int m_redirects;
+    int m_httpStatus;
+    bool m_fromCache;
+    QNetworkReply::NetworkError m_error;
+};
+
+/// \brief Collects timing metrics of all network requests.
+///
+/// Every reply created by BaseNetworkAccessManager is tracked, once it finishes
+/// its metrics are written to the log and kept in limited history for diagnostics.
+/// \warning Instance must be created in main thread, records are then
+/// collected from all threads.
+/// \see BaseNetworkAccessManager, FormDiagnostics
+class NetworkMetrics : public QObject {
+    Q_OBJECT
+
+    friend class NetworkReplyTracker;
+
+  public:
+    // Destructor.
+    virtual ~NetworkMetrics();
+
+    /// \brief Starts tracking of given reply.
+    /// \param reply Newly created reply.
+    /// \param operation Operation performed by the reply.
+    void trackReply(QNetworkReply *reply, QNetworkAccessManager::Operation operation);
+
+    /// \brief Access to metrics of finished requests.
+    /// \return Returns metrics of recently finished requests, oldest first.
+    QList<NetworkRequestMetrics> records() const;
+
+    /// \brief Clears history of finished requests.
+    void clear();
+
+    // Singleton getter.
+    // Instance is created by Application in the main thread.
+    static NetworkMetrics *instance();
+
+  signals:
+    /// \brief Emitted when history of requests changes.
+    /// \remarks This is always emitted from the thread of this object,
+    /// even if requests finish in other threads.
+    void recordsChanged();
+
+  private:
+    // Constructor.
+    explicit NetworkMetrics(QObject *parent = 0);
+
+    // Stores metrics of finished request and logs them.
+    void addRecord(const NetworkRequestMetrics &record);
+
+    // Remembers redirection, so that follow-up request is counted as its part.
+    void addRedirection(const QUrl &target, int redirects);
+    int takeRedirections(const QUrl &url);
+
+    mutable QMutex m_mutex;
+    QList<NetworkRequestMetrics> m_records;
+    QHash<QString, int> m_redirections;
+
+    // Singleton.
+    static QPointer<NetworkMetrics> s_instance;
+};
+
+/// \brief Observes lifecycle of single reply and measures its phases.
+/// \remarks Tracker is child of the reply, so it is destroyed together with it.
+class NetworkReplyTracker : public QObject {
+    Q_OBJECT
+
+  public:
+    /// \brief Constructor.
+    /// \param reply Tracked reply, becomes parent of the tracker.
+    /// \param operation Operation performed by the reply.
+    /// \param redirects Number of redirections which led to this reply.
+    explicit NetworkReplyTracker(QNetworkReply *reply, QNetworkAccessManager::Operation operation, int redirects);
+    virtual ~NetworkReplyTracker();
+
+  private slots:
+    void onEncrypted();
+    void onMetaDataChanged();
+    void onUploadProgress(qint64 bytes_sent, qint64 bytes_total);
+    void onDownloadProgress(qint64 bytes_received, qint64 bytes_total);
+    void onFinished();
+
+  private:
+    QNetworkReply *m_reply;
+    QElapsedTimer m_timer;
+    NetworkRequestMetrics m_metrics;
+};
+
+#endif // NETWORKMETRICS_H
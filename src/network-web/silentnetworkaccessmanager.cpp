@@ -49,7 +49,7 @@ void SilentNetworkAccessManager::onAuthenticationRequired(QNetworkReply *reply,
                                                           QAuthenticator *authenticator) {
   QObject *originating_object = reply->request().originatingObject();
 
-  if (originating_object->property("protected").toBool()) {
+  if (originating_object != NULL && originating_object->property("protected").toBool()) {
     // This feed contains authentication information, it is good.
     authenticator->setUser(originating_object->property("username").toString());
     authenticator->setPassword(originating_object->property("password").toString());
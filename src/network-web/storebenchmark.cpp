@@ -0,0 +1,257 @@
+/*
+  Copyright (c) 2012, BuildmLearn Contributors listed at http://buildmlearn.org/people/
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+
+  * Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+
+  * Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+
+  * Neither the name of the BuildmLearn nor the names of its
+    contributors may be used to endorse or promote products derived from
+    this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "network-web/storebenchmark.h"
+
+#include "definitions/definitions.h"
+#include "network-web/fakestoreserver.h"
+#include "network-web/bundleuploader.h"
+
+#include <QFile>
+#include <QTemporaryFile>
+#include <QTextStream>
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QTimer>
+
+
+StoreBenchmark::StoreBenchmark(QObject *parent)
+  : QObject(parent), m_server(new FakeStoreServer(this)), m_sampleTimer(new QTimer(this)),
+    m_peakMemory(-1), m_status(QNetworkReply::NoError), m_contents(QByteArray()) {
+  m_sampleTimer->setInterval(STORE_BENCHMARK_SAMPLE_INTERVAL);
+
+  connect(m_sampleTimer, SIGNAL(timeout()), this, SLOT(sampleMemory()));
+}
+
+StoreBenchmark::~StoreBenchmark() {
+  qDebug("Destroying StoreBenchmark instance.");
+}
+
+FakeStoreServer *StoreBenchmark::server() const {
+  return m_server;
+}
+
+StoreBenchmark::Result StoreBenchmark::measure(qint64 size, bool chunked) {
+  Result result;
+  QIODevice *bundle_data = createBundle(size);
+
+  result.m_size = size;
+  result.m_status = StoreFactory::OtherError;
+  result.m_elapsed = 0;
+  result.m_peakMemory = -1;
+  result.m_requests = 0;
+
+  if (bundle_data == NULL) {
+    return result;
+  }
+
+  QEventLoop loop;
+  QElapsedTimer timer;
+  BundleUploader uploader;
+  int requests = m_server->requestCount();
+
+  // Rate is limited by the server, which simulates slow link, so
+  // that measured rate is not capped by uploader's own limit.
+  uploader.setBandwidthLimit(0);
+  uploader.setChunkedUploads(chunked);
+  uploader.setDeltaUploads(false);
+
+  connect(&uploader, SIGNAL(completed(QNetworkReply::NetworkError,QByteArray)),
+          this, SLOT(uploadCompleted(QNetworkReply::NetworkError,QByteArray)));
+  connect(&uploader, SIGNAL(completed(QNetworkReply::NetworkError,QByteArray)), &loop, SLOT(quit()));
+
+  result.m_baseMemory = m_peakMemory = residentMemory();
+  m_sampleTimer->start();
+  timer.start();
+
+  uploader.upload(m_server->uploadUrl(), bundle_data, STORE_API_KEY, "Benchmark", "benchmark@localhost",
+                  QString("Benchmark %1").arg(size), QString());
+
+  if (uploader.isRunning()) {
+    loop.exec();
+  }
+
+  result.m_elapsed = timer.elapsed();
+  m_sampleTimer->stop();
+  sampleMemory();
+
+  result.m_status = StoreFactory::parseResponseXml(m_status, m_contents);
+  result.m_peakMemory = m_peakMemory;
+  result.m_requests = m_server->requestCount() - requests;
+
+  return result;
+}
+
+int StoreBenchmark::execute(const QStringList &arguments) {
+  int sizes_index = arguments.indexOf(APP_ARG_STORE_SIZES);
+  int latency_index = arguments.indexOf(APP_ARG_STORE_LATENCY);
+  int bandwidth_index = arguments.indexOf(APP_ARG_STORE_BANDWIDTH);
+  int failures_index = arguments.indexOf(APP_ARG_STORE_FAILURES);
+  int report_index = arguments.indexOf(APP_ARG_REPORT);
+  bool chunked = arguments.contains(APP_ARG_STORE_CHUNKED);
+  QStringList sizes = QString(STORE_BENCHMARK_SIZES).split(',');
+
+  if (sizes_index >= 0) {
+    sizes = arguments.value(sizes_index + 1).split(',', QString::SkipEmptyParts);
+  }
+
+  StoreBenchmark benchmark;
+
+  if (!benchmark.server()->start()) {
+    return EXIT_FAILURE;
+  }
+
+  benchmark.server()->setChunkedUploads(chunked);
+
+  if (latency_index >= 0) {
+    benchmark.server()->setLatency(arguments.value(latency_index + 1).toInt());
+  }
+
+  if (bandwidth_index >= 0) {
+    benchmark.server()->setBandwidthLimit(arguments.value(bandwidth_index + 1).toLongLong() * 1024);
+  }
+
+  if (failures_index >= 0) {
+    benchmark.server()->setFailureRate(arguments.value(failures_index + 1).toInt());
+  }
+
+  QFile report_file;
+  QTextStream report(stdout);
+
+  if (report_index >= 0) {
+    report_file.setFileName(arguments.value(report_index + 1));
+
+    if (!report_file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text)) {
+      qWarning("Report file '%s' cannot be opened for writing.", qPrintable(report_file.fileName()));
+      return EXIT_FAILURE;
+    }
+
+    report.setDevice(&report_file);
+  }
+
+  int failed_uploads = 0;
+
+  foreach (const QString &size, sizes) {
+    qint64 size_bytes = size.trimmed().toLongLong() * 1024;
+
+    if (size_bytes <= 0) {
+      qWarning("Invalid size '%s' of benchmarked bundle.", qPrintable(size));
+      return EXIT_FAILURE;
+    }
+
+    Result result = benchmark.measure(size_bytes, chunked);
+    qint64 throughput = result.m_elapsed > 0 ? result.m_size * 1000 / 1024 / result.m_elapsed : 0;
+
+    if (result.m_status != StoreFactory::Success) {
+      failed_uploads++;
+    }
+
+    report << "size_kb=" << (result.m_size / 1024) << " status=" << StoreFactory::uploadStatusToString(result.m_status) <<
+              " elapsed_ms=" << result.m_elapsed << " throughput_kbps=" << throughput <<
+              " requests=" << result.m_requests << " peak_rss_kb=" << result.m_peakMemory <<
+              " rss_growth_kb=" << (result.m_peakMemory >= 0 ? result.m_peakMemory - result.m_baseMemory : -1) << '\n';
+    report.flush();
+  }
+
+  report << "# uploads=" << sizes.size() << " failed=" << failed_uploads <<
+            " received_bytes=" << benchmark.server()->receivedBytes() << '\n';
+  report.flush();
+
+  return failed_uploads == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+qint64 StoreBenchmark::residentMemory() {
+#if defined(Q_OS_LINUX)
+  QFile status_file("/proc/self/status");
+
+  if (!status_file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+    return -1;
+  }
+
+  foreach (const QByteArray &line, status_file.readAll().split('\n')) {
+    if (line.startsWith("VmRSS:")) {
+      // Value is given in kilobytes.
+      return line.mid(6).trimmed().split(' ').value(0).toLongLong();
+    }
+  }
+#endif
+
+  return -1;
+}
+
+void StoreBenchmark::sampleMemory() {
+  m_peakMemory = qMax(m_peakMemory, residentMemory());
+}
+
+void StoreBenchmark::uploadCompleted(QNetworkReply::NetworkError status, const QByteArray &contents) {
+  m_status = status;
+  m_contents = contents;
+}
+
+QIODevice *StoreBenchmark::createBundle(qint64 size) {
+  QTemporaryFile *bundle_file = new QTemporaryFile();
+
+  if (!bundle_file->open()) {
+    qWarning("Temporary file for benchmarked bundle cannot be created.");
+    delete bundle_file;
+    return NULL;
+  }
+
+  // Data are written in blocks, so that generated bundle is never held in memory.
+  QByteArray header = "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<buildmlearn_application>\n<data>\n";
+  QByteArray footer = "</data>\n</buildmlearn_application>\n";
+  QByteArray item = "<item>Lorem ipsum dolor sit amet, consectetur adipiscing elit.</item>\n";
+  QByteArray block;
+  qint64 written = 0;
+
+  while (block.size() < STORE_BENCHMARK_BLOCK_SIZE) {
+    block.append(item);
+  }
+
+  bundle_file->write(header.left((int) size));
+  written = bundle_file->pos();
+
+  while (written < size - footer.size()) {
+    qint64 block_written = bundle_file->write(block.constData(), qMin((qint64) block.size(), size - footer.size() - written));
+
+    if (block_written <= 0) {
+      qWarning("Benchmarked bundle cannot be written, %lld bytes are written.", written);
+      delete bundle_file;
+      return NULL;
+    }
+
+    written += block_written;
+  }
+
+  bundle_file->write(footer.right((int) (size - written)));
+  bundle_file->seek(0);
+
+  return bundle_file;
+}
@@ -0,0 +1,115 @@
+/*
+  Copyright (c) 2012, BuildmLearn Contributors listed at http://buildmlearn.org/people/
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+
+  * Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+
+  * Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+
+  * Neither the name of the BuildmLearn nor the names of its
+    contributors may be used to endorse or promote products derived from
+    this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef STOREBENCHMARK_H
+#define STOREBENCHMARK_H
+
+#include <QObject>
+
+#include "miscellaneous/storefactory.h"
+
+#include <QStringList>
+#include <QNetworkReply>
+
+
+class FakeStoreServer;
+class QTimer;
+
+/// \brief Headless benchmark of bundle uploads.
+///
+/// Benchmark runs FakeStoreServer in the same process and uploads generated
+/// bundles of given sizes to it via BundleUploader. Wall time, throughput and
+/// peak resident memory of each upload are reported, so regressions in
+/// memory use of large uploads can be spotted.
+///
+/// Resident memory is sampled from /proc/self/status, so it is reported
+/// only on Linux. Memory of the server is not significant, it does not
+/// keep uploaded data.
+/// \see FakeStoreServer, BundleUploader
+class StoreBenchmark : public QObject {
+    Q_OBJECT
+
+  public:
+    /// \brief Result of single measured upload.
+    struct Result {
+      qint64 m_size;
+      StoreFactory::UploadStatus m_status;
+      qint64 m_elapsed;
+      qint64 m_peakMemory;
+      qint64 m_baseMemory;
+      int m_requests;
+    };
+
+    // Constructors and destructors.
+    explicit StoreBenchmark(QObject *parent = 0);
+    virtual ~StoreBenchmark();
+
+    /// \brief Access to store server used by benchmark.
+    FakeStoreServer *server() const;
+
+    /// \brief Uploads generated bundle of given size and measures the upload.
+    /// \param size Size of the bundle in bytes.
+    /// \param chunked True if bundle is uploaded in chunks.
+    /// \return Returns result of the upload.
+    Result measure(qint64 size, bool chunked);
+
+    /// \brief Performs complete benchmark as specified by command line arguments.
+    /// \param arguments Arguments of the application, they contain APP_ARG_STORE_BENCHMARK
+    /// and optionally APP_ARG_STORE_SIZES followed by comma-separated sizes in kilobytes,
+    /// APP_ARG_STORE_LATENCY followed by latency in milliseconds, APP_ARG_STORE_BANDWIDTH
+    /// followed by rate limit in kilobytes per second, APP_ARG_STORE_FAILURES followed
+    /// by percentage of failed requests, APP_ARG_STORE_CHUNKED and APP_ARG_REPORT
+    /// followed by report file name.
+    /// \return Returns exit code of the application.
+    static int execute(const QStringList &arguments);
+
+    /// \brief Access to current resident memory of the process.
+    /// \return Returns resident memory in kilobytes or -1 if it is unknown.
+    static qint64 residentMemory();
+
+  private slots:
+    // Samples resident memory during upload.
+    void sampleMemory();
+
+    // Stores result of the upload.
+    void uploadCompleted(QNetworkReply::NetworkError status, const QByteArray &contents);
+
+  private:
+    // Creates file with bundle-like data of given size.
+    QIODevice *createBundle(qint64 size);
+
+    FakeStoreServer *m_server;
+    QTimer *m_sampleTimer;
+    qint64 m_peakMemory;
+    QNetworkReply::NetworkError m_status;
+    QByteArray m_contents;
+};
+
+#endif // STOREBENCHMARK_H
@@ -0,0 +1,112 @@
+/*
+  Copyright (c) 2012, BuildmLearn Contributors listed at http://buildmlearn.org/people/
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+
+  * Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+
+  * Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+
+  * Neither the name of the BuildmLearn nor the names of its
+    contributors may be used to endorse or promote products derived from
+    this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#include "network-web/throttleddevice.h"
+
+#include "definitions/definitions.h"
+
+#include <QTimer>
+
+
+ThrottledDevice::ThrottledDevice(QIODevice *source, qint64 bytes_per_second, QObject *parent)
+  : QIODevice(parent), m_source(source), m_timer(new QTimer(this)), m_rate(0), m_allowance(0) {
+  m_source->setParent(this);
+  m_timer->setInterval(UPLOAD_THROTTLE_INTERVAL);
+
+  connect(m_timer, SIGNAL(timeout()), this, SLOT(releaseData()));
+
+  setRate(bytes_per_second);
+}
+
+ThrottledDevice::~ThrottledDevice() {
+  qDebug("Destroying ThrottledDevice instance.");
+}
+
+qint64 ThrottledDevice::rate() const {
+  return m_rate;
+}
+
+void ThrottledDevice::setRate(qint64 bytes_per_second) {
+  m_rate = qMax(bytes_per_second, (qint64) 0);
+
+  if (m_rate > 0) {
+    m_allowance = qMin(m_allowance, m_rate * UPLOAD_THROTTLE_INTERVAL / 1000);
+
+    if (!m_timer->isActive()) {
+      m_timer->start();
+    }
+  }
+  else {
+    // Reader may wait for more data.
+    m_timer->stop();
+    emit readyRead();
+  }
+}
+
+bool ThrottledDevice::isSequential() const {
+  return false;
+}
+
+qint64 ThrottledDevice::size() const {
+  return m_source->size();
+}
+
+bool ThrottledDevice::seek(qint64 pos) {
+  return QIODevice::seek(pos) && m_source->seek(pos);
+}
+
+qint64 ThrottledDevice::readData(char *data, qint64 max_size) {
+  if (m_rate <= 0) {
+    return m_source->read(data, max_size);
+  }
+
+  qint64 bytes_read = m_source->read(data, qMin(max_size, m_allowance));
+
+  if (bytes_read > 0) {
+    m_allowance -= bytes_read;
+  }
+
+  return bytes_read;
+}
+
+qint64 ThrottledDevice::writeData(const char *data, qint64 max_size) {
+  Q_UNUSED(data)
+  Q_UNUSED(max_size)
+
+  return -1;
+}
+
+void ThrottledDevice::releaseData() {
+  // Allowance is not accumulated while nothing is read,
+  // so that data are never sent in bursts.
+  m_allowance = qMax(m_rate * UPLOAD_THROTTLE_INTERVAL / 1000, (qint64) 1);
+  emit readyRead();
+}
@@ -0,0 +1,86 @@
+/*
+  Copyright (c) 2012, BuildmLearn Contributors listed at http://buildmlearn.org/people/
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+
+  * Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+
+  * Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+
+  * Neither the name of the BuildmLearn nor the names of its
+    contributors may be used to endorse or promote products derived from
+    this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#ifndef THROTTLEDDEVICE_H
+#define THROTTLEDDEVICE_H
+
+#include <QIODevice>
+
+
+class QTimer;
+
+/// \brief Read-only device which passes data of another device at limited rate.
+///
+/// Data are released in small portions on each tick of internal timer and
+/// readyRead() is emitted whenever new portion is available. Device is meant
+/// as outgoing data of network requests, so that the transfer itself is slowed
+/// down, not only scheduling of requests.
+class ThrottledDevice : public QIODevice {
+    Q_OBJECT
+
+  public:
+    /// \brief Constructor.
+    /// \param source Opened device with data, throttled device takes ownership of it.
+    /// \param bytes_per_second Maximal rate, zero means unlimited rate.
+    /// \param parent Parent to this instance.
+    explicit ThrottledDevice(QIODevice *source, qint64 bytes_per_second, QObject *parent = 0);
+    virtual ~ThrottledDevice();
+
+    /// \brief Access to rate limit.
+    /// \return Returns maximal rate in bytes per second, zero means unlimited rate.
+    qint64 rate() const;
+
+    /// \brief Sets rate limit, it applies also to data which are not read yet.
+    /// \param bytes_per_second Maximal rate, zero means unlimited rate.
+    void setRate(qint64 bytes_per_second);
+
+    bool isSequential() const;
+    qint64 size() const;
+    bool seek(qint64 pos);
+
+  protected:
+    qint64 readData(char *data, qint64 max_size);
+    qint64 writeData(const char *data, qint64 max_size);
+
+  private slots:
+    // Releases next portion of data.
+    void releaseData();
+
+  private:
+    QIODevice *m_source;
+    QTimer *m_timer;
+    qint64 m_rate;
+
+    // Number of bytes which can be read before next tick.
+    qint64 m_allowance;
+};
+
+#endif // THROTTLEDDEVICE_H
@@ -0,0 +1,378 @@
+/*
+  Copyright (c) 2012, BuildmLearn Contributors listed at http://buildmlearn.org/people/
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+
+  * Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+
+  * Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+
+  * Neither the name of the BuildmLearn nor the names of its
+    contributors may be used to endorse or promote products derived from
+    this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "network-web/ttsservice.h"
+
+#include "definitions/definitions.h"
+#include "miscellaneous/application.h"
+#include "miscellaneous/settings.h"
+#include "network-web/networkfactory.h"
+#include "network-web/silentnetworkaccessmanager.h"
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QFileInfo>
+#include <QFile>
+#include <QDir>
+#include <QTimer>
+#include <QUrl>
+
+
+QPointer<TtsService> TtsService::s_instance;
+
+TtsService::TtsService(QObject *parent)
+  : QObject(parent), m_queue(QStringList()),
+    m_activeReplies(QHash<QNetworkReply*, QString>()), m_cacheSize(-1), m_batchRunning(false),
+    m_batchSize(0), m_batchWords(QSet<QString>()), m_batchFiles(QHash<QString, QString>()),
+    m_pinnedFiles(QSet<QString>()) {
+}
+
+TtsService::~TtsService() {
+  qDebug("Destroying TtsService instance.");
+}
+
+QString TtsService::serviceUrl() const {
+  return qApp->settings()->value(APP_CFG_TTS, "service_url", TTS_SERVICE_URL).toString();
+}
+
+QString TtsService::locale() const {
+  return qApp->settings()->value(APP_CFG_TTS, "locale", TTS_DEFAULT_LOCALE).toString();
+}
+
+QString TtsService::voice() const {
+  return qApp->settings()->value(APP_CFG_TTS, "voice").toString();
+}
+
+QString TtsService::cacheDirectory() const {
+  return qApp->settings()->value(APP_CFG_TTS, "cache_directory",
+                                 QString(QFileInfo(qApp->settings()->fileName()).absolutePath() +
+                                         QDir::separator() + TTS_CACHE_PATH)).toString();
+}
+
+qint64 TtsService::cacheSizeLimit() const {
+  // Size is stored in megabytes.
+  return qApp->settings()->value(APP_CFG_TTS, "cache_size", TTS_CACHE_SIZE).toLongLong() * 1024 * 1024;
+}
+
+int TtsService::prefetchCount() const {
+  return qApp->settings()->value(APP_CFG_TTS, "prefetch_count", TTS_PREFETCH_COUNT).toInt();
+}
+
+int TtsService::parallelRequests() const {
+  return qMax(1, qApp->settings()->value(APP_CFG_TTS, "parallel_requests", TTS_PARALLEL_REQUESTS).toInt());
+}
+
+QString TtsService::cachedAudioFile(const QString &word) {
+  QString file_name = cacheFile(word);
+
+  if (!QFile::exists(file_name)) {
+    return QString();
+  }
+
+#if QT_VERSION >= 0x050A00
+  // Mark the file as recently used so that it is evicted last.
+  QFile file(file_name);
+
+  if (file.open(QIODevice::ReadWrite)) {
+    file.setFileTime(QDateTime::currentDateTime(), QFileDevice::FileModificationTime);
+    file.close();
+  }
+#endif
+
+  return file_name;
+}
+
+bool TtsService::isBatchRunning() const {
+  return m_batchRunning;
+}
+
+bool TtsService::startBatch(const QStringList &words) {
+  if (m_batchRunning) {
+    qWarning("Batch synthesis is already running.");
+    return false;
+  }
+
+  QStringList missing_words;
+
+  m_batchRunning = true;
+  m_batchSize = QSet<QString>::fromList(words).size();
+  m_batchFiles.clear();
+  m_batchWords.clear();
+
+  foreach (const QString &word, words) {
+    QString file_name = cachedAudioFile(word);
+
+    if (!file_name.isEmpty()) {
+      m_batchFiles.insert(word, file_name);
+      m_pinnedFiles.insert(QFileInfo(file_name).absoluteFilePath());
+    }
+    else if (!m_batchWords.contains(word)) {
+      m_batchWords.insert(word);
+      missing_words.append(word);
+    }
+  }
+
+  if (missing_words.isEmpty()) {
+    // Result is always delivered asynchronously.
+    QTimer::singleShot(0, this, SLOT(finishBatch()));
+  }
+  else {
+    // Words which were already being downloaded before are finished
+    // via the same path as words of this batch.
+    prefetchWords(missing_words);
+  }
+
+  return true;
+}
+
+void TtsService::releaseFiles(const QStringList &audio_files) {
+  foreach (const QString &file_name, audio_files) {
+    m_pinnedFiles.remove(QFileInfo(file_name).absoluteFilePath());
+  }
+
+  pruneCache();
+}
+
+TtsService *TtsService::instance() {
+  if (s_instance.isNull()) {
+    s_instance = new TtsService(qApp);
+  }
+
+  return s_instance;
+}
+
+void TtsService::requestWord(const QString &word) {
+  QString file_name = cachedAudioFile(word);
+
+  if (!file_name.isEmpty()) {
+    emit audioReady(word, file_name);
+    return;
+  }
+
+  if (!m_activeReplies.values().contains(word)) {
+    // Explicitly requested words go before prefetched ones.
+    m_queue.removeAll(word);
+    m_queue.prepend(word);
+    startRequests();
+  }
+}
+
+void TtsService::prefetchWords(const QStringList &words) {
+  QList<QString> active_words = m_activeReplies.values();
+
+  foreach (const QString &word, words) {
+    if (!m_queue.contains(word) && !active_words.contains(word) && !QFile::exists(cacheFile(word))) {
+      m_queue.append(word);
+    }
+  }
+
+  startRequests();
+}
+
+void TtsService::clearCache() {
+  QDir cache_directory(cacheDirectory());
+
+  foreach (const QFileInfo &file, cache_directory.entryInfoList(QStringList() << "*.wav", QDir::Files)) {
+    if (!m_pinnedFiles.contains(file.absoluteFilePath())) {
+      cache_directory.remove(file.fileName());
+    }
+  }
+
+  // Size is recomputed when it is needed next time.
+  m_cacheSize = m_pinnedFiles.isEmpty() ? 0 : -1;
+}
+
+void TtsService::onReplyFinished() {
+  QNetworkReply *reply = qobject_cast<QNetworkReply*>(sender());
+
+  if (reply == NULL || !m_activeReplies.contains(reply)) {
+    return;
+  }
+
+  QString word = m_activeReplies.take(reply);
+  QVariant redirection = reply->attribute(QNetworkRequest::RedirectionTargetAttribute);
+  int redirects = reply->property("redirects").toInt();
+
+  if (reply->error() == QNetworkReply::NoError && redirection.isValid() && redirects < TTS_MAX_REDIRECTS) {
+    // Follow the redirection.
+    startRequest(word, reply->url().resolved(redirection.toUrl()), redirects + 1);
+  }
+  else if (reply->error() == QNetworkReply::NoError) {
+    QString file_name = storeAudio(word, reply->readAll());
+
+    if (file_name.isEmpty()) {
+      finishBatchWord(word);
+      emit audioFailed(word, QNetworkReply::UnknownContentError);
+    }
+    else {
+      finishBatchWord(word, file_name);
+      emit audioReady(word, file_name);
+    }
+  }
+  else {
+    // Only requests which time out are aborted.
+    QNetworkReply::NetworkError error = reply->error() == QNetworkReply::OperationCanceledError ?
+                                          QNetworkReply::TimeoutError :
+                                          reply->error();
+
+    qWarning("Audio for word '%s' was not obtained: %s.",
+             qPrintable(word), qPrintable(NetworkFactory::networkErrorText(error)));
+    finishBatchWord(word);
+    emit audioFailed(word, error);
+  }
+
+  reply->deleteLater();
+  startRequests();
+}
+
+QString TtsService::cacheFile(const QString &word) const {
+  QByteArray key = QString("%1\n%2\n%3").arg(word.simplified(), locale(), voice()).toUtf8();
+
+  return cacheDirectory() + QDir::separator() +
+      QString(QCryptographicHash::hash(key, QCryptographicHash::Sha1).toHex()) + ".wav";
+}
+
+void TtsService::startRequests() {
+  while (!m_queue.isEmpty() && m_activeReplies.size() < parallelRequests()) {
+    QString word = m_queue.takeFirst();
+    QString url = serviceUrl();
+
+    // Placeholders are replaced from the last one, so that percent-encoded
+    // word cannot be mistaken for another placeholder.
+    url.replace("%3", QString(QUrl::toPercentEncoding(voice())));
+    url.replace("%2", QString(QUrl::toPercentEncoding(locale())));
+    url.replace("%1", QString(QUrl::toPercentEncoding(word.simplified())));
+
+    startRequest(word, QUrl::fromEncoded(url.toUtf8(), QUrl::TolerantMode));
+  }
+}
+
+void TtsService::startRequest(const QString &word, const QUrl &url, int redirects) {
+  QNetworkReply *reply = NetworkFactory::sharedNetworkManager()->get(QNetworkRequest(url));
+
+  reply->setProperty("redirects", redirects);
+  m_activeReplies.insert(reply, word);
+
+  connect(reply, SIGNAL(finished()), this, SLOT(onReplyFinished()));
+  QTimer::singleShot(qApp->settings()->value(APP_CFG_TTS, "timeout", TTS_TIMEOUT).toInt(), reply, SLOT(abort()));
+}
+
+QString TtsService::storeAudio(const QString &word, const QByteArray &audio) {
+  QString file_name = cacheFile(word);
+  QString partial_file_name = file_name + ".part";
+
+  if (audio.isEmpty() || !QDir().mkpath(cacheDirectory())) {
+    return QString();
+  }
+
+  // Audio is written to temporary file first, so that
+  // partially written file is never used.
+  QFile partial_file(partial_file_name);
+
+  if (!partial_file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+    return QString();
+  }
+
+  partial_file.write(audio);
+  partial_file.close();
+
+  QFile::remove(file_name);
+
+  if (!QFile::rename(partial_file_name, file_name)) {
+    QFile::remove(partial_file_name);
+    return QString();
+  }
+
+  // Previous file could have been played already.
+  emit audioFileReplaced(file_name);
+
+  if (m_cacheSize >= 0) {
+    m_cacheSize += audio.size();
+  }
+
+  pruneCache();
+  return file_name;
+}
+
+void TtsService::finishBatchWord(const QString &word, const QString &audio_file) {
+  if (!m_batchRunning || !m_batchWords.remove(word)) {
+    return;
+  }
+
+  if (!audio_file.isEmpty()) {
+    m_batchFiles.insert(word, audio_file);
+    m_pinnedFiles.insert(QFileInfo(audio_file).absoluteFilePath());
+  }
+
+  if (m_batchWords.isEmpty()) {
+    finishBatch();
+  }
+}
+
+void TtsService::finishBatch() {
+  if (!m_batchRunning) {
+    return;
+  }
+
+  QHash<QString, QString> audio_files = m_batchFiles;
+  int failed_words = m_batchSize - audio_files.size();
+
+  m_batchRunning = false;
+  m_batchSize = 0;
+  m_batchFiles.clear();
+
+  emit batchFinished(audio_files, failed_words);
+}
+
+void TtsService::pruneCache() {
+  qint64 limit = cacheSizeLimit();
+
+  if (m_cacheSize >= 0 && m_cacheSize <= limit) {
+    return;
+  }
+
+  // Files are sorted from the most recently used one.
+  QFileInfoList files = QDir(cacheDirectory()).entryInfoList(QStringList() << "*.wav", QDir::Files, QDir::Time);
+
+  m_cacheSize = 0;
+
+  foreach (const QFileInfo &file, files) {
+    if (m_pinnedFiles.contains(file.absoluteFilePath())) {
+      // Files of batch synthesis are kept until they are released.
+      m_cacheSize += file.size();
+    }
+    else if (m_cacheSize + file.size() > limit) {
+      QFile::remove(file.absoluteFilePath());
+    }
+    else {
+      m_cacheSize += file.size();
+    }
+  }
+}
@@ -0,0 +1,186 @@
+/*
+  Copyright (c) 2012, BuildmLearn Contributors listed at http://buildmlearn.org/people/
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+
+  * Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+
+  * Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+
+  * Neither the name of the BuildmLearn nor the names of its
+    contributors may be used to endorse or promote products derived from
+    this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef TTSSERVICE_H
+#define TTSSERVICE_H
+
+#include <QObject>
+
+#include <QPointer>
+#include <QStringList>
+#include <QHash>
+#include <QSet>
+#include <QNetworkReply>
+
+
+/// \brief Asynchronous text-to-speech service with persistent audio cache.
+///
+/// Audio of words is downloaded from configurable TTS endpoint. URL of the endpoint
+/// is a pattern in which %1 is replaced by the word, %2 by the locale and %3 by the voice,
+/// so that local stand-in synthesizer (or even "file://" directory) can be used instead
+/// of the default online service.
+///
+/// Downloaded audio files are stored in content-addressed disk cache, file names are
+/// derived from word, locale and voice. Cache is kept across sessions and its size is
+/// bounded, least recently used files are evicted first.
+class TtsService : public QObject {
+    Q_OBJECT
+
+  public:
+    // Destructor.
+    virtual ~TtsService();
+
+    /// \brief Access to URL pattern of TTS endpoint.
+    QString serviceUrl() const;
+
+    /// \brief Access to locale used for synthesis.
+    QString locale() const;
+
+    /// \brief Access to voice used for synthesis, may be empty.
+    QString voice() const;
+
+    /// \brief Access to directory of audio cache.
+    QString cacheDirectory() const;
+
+    /// \brief Access to maximal size of audio cache in bytes.
+    qint64 cacheSizeLimit() const;
+
+    /// \brief Access to number of words which should be prefetched
+    /// in advance.
+    int prefetchCount() const;
+
+    /// \brief Access to maximal number of parallel requests.
+    int parallelRequests() const;
+
+    /// \brief Returns cached audio file for given word.
+    /// \param word Word to look up.
+    /// \return Returns path to cached audio file or empty string
+    /// if word is not cached yet.
+    QString cachedAudioFile(const QString &word);
+
+    /// \brief Checks if batch synthesis is running.
+    bool isBatchRunning() const;
+
+    /// \brief Starts obtaining audio for all given words.
+    /// \param words List of words.
+    /// \return Returns true if batch was started, false if another
+    /// batch is already running.
+    /// \remarks Missing words are downloaded in parallel, number of parallel
+    /// requests is bounded by parallelRequests(). batchFinished() is emitted
+    /// once all words are resolved. Audio files of the batch are pinned in the
+    /// cache until they are released via releaseFiles().
+    bool startBatch(const QStringList &words);
+
+    /// \brief Allows pinned audio files to be evicted from cache again.
+    /// \param audio_files List of audio files obtained via batchFinished().
+    void releaseFiles(const QStringList &audio_files);
+
+    // Singleton getter.
+    static TtsService *instance();
+
+  public slots:
+    /// \brief Requests audio for given word.
+    /// \param word Requested word.
+    /// \remarks Either audioReady() or audioFailed() is emitted later. If word
+    /// is already cached, audioReady() is emitted immediately.
+    void requestWord(const QString &word);
+
+    /// \brief Fetches audio of given words in background so that
+    /// they are cached when they are requested.
+    /// \param words List of words.
+    void prefetchWords(const QStringList &words);
+
+    /// \brief Removes all files from audio cache.
+    void clearCache();
+
+  signals:
+    /// \brief Emitted when audio for word is available.
+    /// \param word Word which was requested.
+    /// \param audio_file Path to cached audio file.
+    void audioReady(const QString &word, const QString &audio_file);
+
+    /// \brief Emitted when audio for word cannot be obtained.
+    /// \param word Word which was requested.
+    /// \param error Network error which occurred.
+    void audioFailed(const QString &word, QNetworkReply::NetworkError error);
+
+    /// \brief Emitted when audio file is written to the cache, any
+    /// previous file with the same path is replaced.
+    /// \param audio_file Path to written audio file.
+    void audioFileReplaced(const QString &audio_file);
+
+    /// \brief Emitted when batch synthesis is finished.
+    /// \param audio_files Mapping of words to cached audio files, words
+    /// whose audio cannot be obtained are not contained.
+    /// \param failed_words Number of words whose audio cannot be obtained.
+    void batchFinished(const QHash<QString, QString> &audio_files, int failed_words);
+
+  private slots:
+    void onReplyFinished();
+    void finishBatch();
+
+  private:
+    // Constructor.
+    explicit TtsService(QObject *parent = 0);
+
+    // Returns path of cache file for given word.
+    QString cacheFile(const QString &word) const;
+
+    // Starts queued requests as long as limit of parallel requests allows it.
+    void startRequests();
+    void startRequest(const QString &word, const QUrl &url, int redirects = 0);
+
+    // Stores downloaded audio into cache and returns path to it.
+    QString storeAudio(const QString &word, const QByteArray &audio);
+
+    // Evicts least recently used files until cache fits its limit.
+    void pruneCache();
+
+    // Reports result of word to running batch synthesis.
+    void finishBatchWord(const QString &word, const QString &audio_file = QString());
+
+    QStringList m_queue;
+    QHash<QNetworkReply*, QString> m_activeReplies;
+    qint64 m_cacheSize;
+
+    // State of running batch synthesis.
+    bool m_batchRunning;
+    int m_batchSize;
+    QSet<QString> m_batchWords;
+    QHash<QString, QString> m_batchFiles;
+
+    // Files which must not be evicted from cache.
+    QSet<QString> m_pinnedFiles;
+
+    // Singleton.
+    static QPointer<TtsService> s_instance;
+};
+
+#endif // TTSSERVICE_H
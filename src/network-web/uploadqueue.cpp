@@ -0,0 +1,483 @@
+/*
+  Copyright (c) 2012, BuildmLearn Contributors listed at http://buildmlearn.org/people/
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+
+  * Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+
+  * Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+
+  * Neither the name of the BuildmLearn nor the names of its
+    contributors may be used to endorse or promote products derived from
+    this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "network-web/uploadqueue.h"
+
+#include "definitions/definitions.h"
+#include "miscellaneous/application.h"
+#include "miscellaneous/iofactory.h"
+#include "network-web/bundleuploader.h"
+#include "network-web/downloader.h"
+#include "network-web/networkfactory.h"
+
+#include <QDomDocument>
+#include <QDomElement>
+#include <QFileInfo>
+#include <QFile>
+#include <QDir>
+#include <QSet>
+#include <QUuid>
+#include <QTimer>
+
+
+QPointer<UploadQueue> UploadQueue::s_instance;
+
+UploadQueue::UploadQueue(QObject *parent)
+  : QObject(parent), m_items(QList<Item>()), m_activeUploads(QHash<BundleUploader*, QString>()),
+    m_endpoint(QString()), m_started(false), m_obtainingEndpoint(false), m_endpointRetries(0) {
+  loadQueue();
+}
+
+UploadQueue::~UploadQueue() {
+  qDebug("Destroying UploadQueue instance.");
+}
+
+QList<UploadQueue::Item> UploadQueue::items() const {
+  return m_items;
+}
+
+int UploadQueue::parallelUploads() const {
+  return qMax(qApp->settings()->value(APP_CFG_GEN, "upload_parallel", UPLOAD_PARALLEL_COUNT).toInt(), 1);
+}
+
+qint64 UploadQueue::bandwidthLimit() const {
+  // Limit is stored in kilobytes per second.
+  return qApp->settings()->value(APP_CFG_GEN, "upload_bandwidth_limit", 0).toLongLong() * 1024;
+}
+
+QString UploadQueue::queueDirectory() const {
+  return QFileInfo(qApp->settings()->fileName()).absolutePath() + QDir::separator() + UPLOAD_QUEUE_PATH;
+}
+
+QString UploadQueue::itemStateToString(ItemState state) {
+  switch (state) {
+    case Queued:
+      return tr("Queued");
+
+    case Uploading:
+      return tr("Uploading");
+
+    case Finished:
+      return tr("Uploaded");
+
+    case Failed:
+      return tr("Failed");
+
+    case Waiting:
+      return tr("Waiting for retry");
+
+    default:
+      return tr("Unknown state");
+  }
+}
+
+UploadQueue *UploadQueue::instance() {
+  if (s_instance.isNull()) {
+    s_instance = new UploadQueue(qApp);
+  }
+
+  return s_instance;
+}
+
+QString UploadQueue::enqueue(const QString &bundle_data, const QString &author_name,
+                             const QString &author_email, const QString &application_name,
+                             const QString &application_icon) {
+  Item item;
+
+  item.m_id = QUuid::createUuid().toString().remove('{').remove('}');
+  item.m_applicationName = application_name;
+  item.m_authorName = author_name;
+  item.m_authorEmail = author_email;
+  item.m_state = Queued;
+  item.m_status = StoreFactory::OtherError;
+  item.m_retries = 0;
+
+  QFile bundle_file(bundleFile(item.m_id));
+
+  if (!QDir().mkpath(queueDirectory()) || !bundle_file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+    qWarning("Application '%s' cannot be added to upload queue.", qPrintable(application_name));
+    return QString();
+  }
+
+  bundle_file.write(bundle_data.toUtf8());
+  bundle_file.close();
+
+  // Icon is copied too, so that it is available even if original file is removed.
+  if (!IOFactory::copyFile(application_icon, iconFile(item.m_id))) {
+    qWarning("Icon of application '%s' cannot be added to upload queue.", qPrintable(application_name));
+
+    QFile::remove(bundleFile(item.m_id));
+    return QString();
+  }
+
+  m_items.append(item);
+  saveQueue();
+
+  emit itemStateChanged(item.m_id, item.m_state, item.m_status);
+
+  if (m_started) {
+    startUploads();
+  }
+
+  return item.m_id;
+}
+
+void UploadQueue::removeItem(const QString &id) {
+  int index = indexOf(id);
+
+  if (index < 0) {
+    return;
+  }
+
+  BundleUploader *uploader = m_activeUploads.key(id, NULL);
+
+  if (uploader != NULL) {
+    uploader->disconnect(this);
+    uploader->cancel();
+    uploader->deleteLater();
+    m_activeUploads.remove(uploader);
+  }
+
+  QFile::remove(bundleFile(id));
+  QFile::remove(iconFile(id));
+
+  m_items.removeAt(index);
+  saveQueue();
+
+  emit itemRemoved(id);
+
+  updateBandwidthLimits();
+  startUploads();
+}
+
+void UploadQueue::start() {
+  m_started = true;
+  startUploads();
+}
+
+void UploadQueue::endpointObtained(QNetworkReply::NetworkError error, const QByteArray &endpoint) {
+  m_obtainingEndpoint = false;
+
+  if (error != QNetworkReply::NoError) {
+    // Each next lookup waits twice as long as the previous one, up to
+    // the delay of the last upload retry.
+    int delay = UPLOAD_RETRY_DELAY << qMin(m_endpointRetries, UPLOAD_MAX_RETRIES);
+
+    m_endpointRetries++;
+    qWarning("Store endpoint for upload queue was not obtained: '%s', retrying in %d ms.",
+             qPrintable(NetworkFactory::networkErrorText(error)), delay);
+
+    QTimer::singleShot(delay, this, SLOT(retryEndpoint()));
+    return;
+  }
+
+  m_endpointRetries = 0;
+  m_endpoint = QString(endpoint).trimmed();
+  startUploads();
+}
+
+void UploadQueue::retryEndpoint() {
+  startUploads();
+}
+
+void UploadQueue::retryItem() {
+  QTimer *retry_timer = qobject_cast<QTimer*>(sender());
+
+  if (retry_timer == NULL) {
+    return;
+  }
+
+  int index = indexOf(retry_timer->property("id").toString());
+
+  retry_timer->deleteLater();
+
+  // Item could have been removed in the meantime.
+  if (index >= 0 && m_items.at(index).m_state == Waiting) {
+    setItemState(index, Queued, m_items.at(index).m_status);
+    saveQueue();
+    startUploads();
+  }
+}
+
+void UploadQueue::uploadProgress(qint64 bytes_sent, qint64 bytes_total) {
+  BundleUploader *uploader = qobject_cast<BundleUploader*>(sender());
+
+  if (m_activeUploads.contains(uploader)) {
+    emit itemProgress(m_activeUploads.value(uploader), bytes_sent, bytes_total);
+  }
+}
+
+void UploadQueue::uploadCompleted(QNetworkReply::NetworkError error, QByteArray output) {
+  BundleUploader *uploader = qobject_cast<BundleUploader*>(sender());
+
+  if (!m_activeUploads.contains(uploader)) {
+    return;
+  }
+
+  QString id = m_activeUploads.take(uploader);
+  int index = indexOf(id);
+  StoreFactory::UploadStatus status = StoreFactory::parseResponseXml(error, output);
+
+  uploader->deleteLater();
+
+  qDebug("Queued upload '%s' finished with status '%s'.",
+         qPrintable(id), qPrintable(StoreFactory::uploadStatusToString(status)));
+
+  if (index >= 0) {
+    if (status == StoreFactory::Success) {
+      setItemState(index, Finished, status);
+
+      QFile::remove(bundleFile(id));
+      QFile::remove(iconFile(id));
+      m_items.removeAt(index);
+
+      emit itemRemoved(id);
+    }
+    else if (status == StoreFactory::NetworkError && error != QNetworkReply::OperationCanceledError &&
+             m_items.at(index).m_retries < UPLOAD_MAX_RETRIES) {
+      // Network errors and stalls are transient, each next
+      // retry waits twice as long as the previous one.
+      QTimer *retry_timer = new QTimer(this);
+      int delay = UPLOAD_RETRY_DELAY << m_items.at(index).m_retries;
+
+      m_items[index].m_retries++;
+      qWarning("Queued upload '%s' is retried in %d ms.", qPrintable(id), delay);
+
+      retry_timer->setSingleShot(true);
+      retry_timer->setProperty("id", id);
+      connect(retry_timer, SIGNAL(timeout()), this, SLOT(retryItem()));
+      retry_timer->start(delay);
+
+      setItemState(index, Waiting, status);
+    }
+    else {
+      setItemState(index, Failed, status);
+    }
+
+    saveQueue();
+  }
+
+  updateBandwidthLimits();
+  startUploads();
+}
+
+void UploadQueue::loadQueue() {
+  QFile queue_file(queueDirectory() + QDir::separator() + UPLOAD_QUEUE_FILE);
+  QDomDocument document;
+
+  if (!queue_file.open(QIODevice::ReadOnly) || !document.setContent(&queue_file)) {
+    return;
+  }
+
+  QDomNodeList items = document.documentElement().elementsByTagName("item");
+
+  for (int i = 0; i < items.size(); i++) {
+    QDomElement element = items.at(i).toElement();
+    Item item;
+
+    item.m_id = element.attribute("id");
+    item.m_applicationName = element.attribute("application_name");
+    item.m_authorName = element.attribute("author_name");
+    item.m_authorEmail = element.attribute("author_email");
+    item.m_state = static_cast<ItemState>(element.attribute("state").toInt());
+    item.m_status = static_cast<StoreFactory::UploadStatus>(element.attribute("status").toInt());
+    item.m_retries = 0;
+
+    if (!QFile::exists(bundleFile(item.m_id))) {
+      continue;
+    }
+
+    // Interrupted uploads and uploads which failed because
+    // of network are tried again.
+    if (item.m_state == Uploading || item.m_state == Waiting ||
+        (item.m_state == Failed && item.m_status == StoreFactory::NetworkError)) {
+      item.m_state = Queued;
+    }
+    else if (item.m_state != Queued) {
+      // Store rejected the item, it was reported in previous session.
+      continue;
+    }
+
+    m_items.append(item);
+  }
+
+  qDebug("Upload queue with %d items loaded.", m_items.size());
+
+  pruneQueueDirectory();
+  saveQueue();
+}
+
+void UploadQueue::pruneQueueDirectory() {
+  QDir queue_directory(queueDirectory());
+  QSet<QString> item_files;
+
+  foreach (const Item &item, m_items) {
+    item_files.insert(QFileInfo(bundleFile(item.m_id)).fileName());
+    item_files.insert(QFileInfo(iconFile(item.m_id)).fileName());
+  }
+
+  foreach (const QString &file_name, queue_directory.entryList(QStringList() << "*.xml" << "*.icon", QDir::Files)) {
+    if (file_name != UPLOAD_QUEUE_FILE && !item_files.contains(file_name)) {
+      queue_directory.remove(file_name);
+    }
+  }
+}
+
+void UploadQueue::saveQueue() {
+  QDomDocument document;
+  QDomElement root = document.createElement("queue");
+
+  document.appendChild(root);
+
+  foreach (const Item &item, m_items) {
+    QDomElement element = document.createElement("item");
+
+    element.setAttribute("id", item.m_id);
+    element.setAttribute("application_name", item.m_applicationName);
+    element.setAttribute("author_name", item.m_authorName);
+    element.setAttribute("author_email", item.m_authorEmail);
+    element.setAttribute("state", (int) item.m_state);
+    element.setAttribute("status", (int) item.m_status);
+    root.appendChild(element);
+  }
+
+  QFile queue_file(queueDirectory() + QDir::separator() + UPLOAD_QUEUE_FILE);
+
+  if (!QDir().mkpath(queueDirectory()) || !queue_file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+    qWarning("Upload queue cannot be saved.");
+    return;
+  }
+
+  queue_file.write(document.toByteArray());
+  queue_file.close();
+}
+
+void UploadQueue::startUploads() {
+  if (!m_started) {
+    return;
+  }
+
+  bool has_queued_items = false;
+
+  foreach (const Item &item, m_items) {
+    if (item.m_state == Queued) {
+      has_queued_items = true;
+      break;
+    }
+  }
+
+  if (!has_queued_items) {
+    return;
+  }
+
+  if (m_endpoint.isEmpty()) {
+    if (!m_obtainingEndpoint) {
+      Downloader *endpoint_downloader = NetworkFactory::downloadFileAsync(StoreFactory::endpointDiscoveryUrl());
+
+      m_obtainingEndpoint = true;
+      endpoint_downloader->setCacheTimeToLive(qApp->settings()->value(APP_CFG_GEN, "endpoint_cache_ttl",
+                                                                      ENDPOINT_CACHE_TTL).toInt());
+      connect(endpoint_downloader, SIGNAL(completed(QNetworkReply::NetworkError,QByteArray)),
+              this, SLOT(endpointObtained(QNetworkReply::NetworkError,QByteArray)));
+    }
+
+    return;
+  }
+
+  for (int i = 0; i < m_items.size() && m_activeUploads.size() < parallelUploads(); i++) {
+    if (m_items.at(i).m_state != Queued) {
+      continue;
+    }
+
+    Item item = m_items.at(i);
+    QFile *bundle_data = new QFile(bundleFile(item.m_id));
+
+    if (!bundle_data->open(QIODevice::ReadOnly)) {
+      delete bundle_data;
+      setItemState(i, Failed, StoreFactory::OtherError);
+      continue;
+    }
+
+    BundleUploader *uploader = new BundleUploader(this);
+
+    connect(uploader, SIGNAL(progress(qint64,qint64)), this, SLOT(uploadProgress(qint64,qint64)));
+    connect(uploader, SIGNAL(completed(QNetworkReply::NetworkError,QByteArray)),
+            this, SLOT(uploadCompleted(QNetworkReply::NetworkError,QByteArray)));
+
+    m_activeUploads.insert(uploader, item.m_id);
+    setItemState(i, Uploading, item.m_status);
+
+    uploader->upload(m_endpoint, bundle_data, STORE_API_KEY, item.m_authorName, item.m_authorEmail,
+                     item.m_applicationName, iconFile(item.m_id));
+  }
+
+  saveQueue();
+  updateBandwidthLimits();
+}
+
+void UploadQueue::updateBandwidthLimits() {
+  qint64 limit = bandwidthLimit();
+
+  if (m_activeUploads.isEmpty()) {
+    return;
+  }
+
+  // Total limit is split evenly among running uploads.
+  foreach (BundleUploader *uploader, m_activeUploads.keys()) {
+    uploader->setBandwidthLimit(limit / m_activeUploads.size());
+  }
+}
+
+void UploadQueue::setItemState(int index, ItemState state, StoreFactory::UploadStatus status) {
+  Item &item = m_items[index];
+
+  item.m_state = state;
+  item.m_status = status;
+
+  emit itemStateChanged(item.m_id, state, status);
+}
+
+int UploadQueue::indexOf(const QString &id) const {
+  for (int i = 0; i < m_items.size(); i++) {
+    if (m_items.at(i).m_id == id) {
+      return i;
+    }
+  }
+
+  return -1;
+}
+
+QString UploadQueue::bundleFile(const QString &id) const {
+  return queueDirectory() + QDir::separator() + id + ".xml";
+}
+
+QString UploadQueue::iconFile(const QString &id) const {
+  return queueDirectory() + QDir::separator() + id + ".icon";
+}
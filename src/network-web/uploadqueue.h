@@ -0,0 +1,187 @@
+/*
+  Copyright (c) 2012, BuildmLearn Contributors listed at http://buildmlearn.org/people/
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+
+  * Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+
+  * Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+
+  * Neither the name of the BuildmLearn nor the names of its
+    contributors may be used to endorse or promote products derived from
+    this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef UPLOADQUEUE_H
+#define UPLOADQUEUE_H
+
+#include <QObject>
+
+#include "miscellaneous/storefactory.h"
+
+#include <QPointer>
+#include <QList>
+#include <QHash>
+#include <QNetworkReply>
+
+
+class BundleUploader;
+
+/// \brief Background queue of application uploads to BuildmLearn Store.
+///
+/// Bundles are stored in queue directory together with their metadata,
+/// so that unfinished uploads continue after application restart. Several
+/// bundles are uploaded concurrently and their total upload rate can be limited.
+/// Items which fail because of network or stall are queued again with exponential
+/// backoff, items rejected by the store are marked as failed.
+/// \see BundleUploader, StoreFactory
+class UploadQueue : public QObject {
+    Q_OBJECT
+
+  public:
+    /// \brief States of queued items.
+    enum ItemState {
+      Queued,
+      Uploading,
+      Finished,
+      Failed,
+
+      // Upload failed because of network, it is queued again later.
+      Waiting
+    };
+
+    /// \brief Single queued application.
+    struct Item {
+      QString m_id;
+      QString m_applicationName;
+      QString m_authorName;
+      QString m_authorEmail;
+      ItemState m_state;
+      StoreFactory::UploadStatus m_status;
+
+      // Number of uploads which failed because of network in this session.
+      int m_retries;
+    };
+
+    // Destructor.
+    virtual ~UploadQueue();
+
+    /// \brief Access to queued items.
+    /// \return Returns all items which are not uploaded yet.
+    QList<Item> items() const;
+
+    /// \brief Access to maximal number of concurrent uploads.
+    /// \return Returns maximal number of concurrent uploads.
+    int parallelUploads() const;
+
+    /// \brief Access to bandwidth limit shared by all uploads.
+    /// \return Returns maximal total upload rate in bytes per second,
+    /// zero means unlimited rate.
+    qint64 bandwidthLimit() const;
+
+    /// \brief Access to directory with queued bundles.
+    /// \return Returns path to queue directory.
+    QString queueDirectory() const;
+
+    /// \brief Converts item state to textual representation.
+    /// \param state State of item.
+    /// \return Returns textual representation of the state.
+    static QString itemStateToString(ItemState state);
+
+    // Singleton getter.
+    static UploadQueue *instance();
+
+  public slots:
+    /// \brief Adds new application to the queue and starts its upload when possible.
+    /// \param bundle_data Bundle of the application.
+    /// \return Returns identifier of new item or empty string if item cannot be queued.
+    QString enqueue(const QString &bundle_data, const QString &author_name,
+                    const QString &author_email, const QString &application_name,
+                    const QString &application_icon);
+
+    /// \brief Removes item from the queue, its upload is cancelled if it runs.
+    /// \param id Identifier of the item.
+    void removeItem(const QString &id);
+
+    /// \brief Starts processing of the queue.
+    void start();
+
+  signals:
+    /// \brief Emitted when state of item changes.
+    /// \param id Identifier of the item.
+    /// \param state New state of the item.
+    /// \param status Store status of the item, valid for finished and failed items.
+    void itemStateChanged(const QString &id, UploadQueue::ItemState state, StoreFactory::UploadStatus status);
+
+    /// \brief Emitted when upload progress of item is known.
+    /// \param id Identifier of the item.
+    /// \param bytes_sent Number of bytes sent.
+    /// \param bytes_total Size of the bundle.
+    void itemProgress(const QString &id, qint64 bytes_sent, qint64 bytes_total);
+
+    /// \brief Emitted when item is removed from the queue.
+    /// \param id Identifier of the item.
+    void itemRemoved(const QString &id);
+
+  private slots:
+    void endpointObtained(QNetworkReply::NetworkError error, const QByteArray &endpoint);
+    void retryEndpoint();
+    void retryItem();
+    void uploadProgress(qint64 bytes_sent, qint64 bytes_total);
+    void uploadCompleted(QNetworkReply::NetworkError error, QByteArray output);
+
+  private:
+    // Constructor.
+    explicit UploadQueue(QObject *parent = 0);
+
+    // Loads and saves list of queued items.
+    void loadQueue();
+    void saveQueue();
+
+    // Removes files of failed items and files which do not belong to any item.
+    void pruneQueueDirectory();
+
+    // Starts uploads of queued items up to the concurrency limit.
+    void startUploads();
+
+    // Splits bandwidth limit among running uploads.
+    void updateBandwidthLimits();
+
+    // Changes state of given item and announces it.
+    void setItemState(int index, ItemState state, StoreFactory::UploadStatus status);
+
+    // Returns index of item with given identifier.
+    int indexOf(const QString &id) const;
+
+    // Returns paths to files of given item.
+    QString bundleFile(const QString &id) const;
+    QString iconFile(const QString &id) const;
+
+    QList<Item> m_items;
+    QHash<BundleUploader*, QString> m_activeUploads;
+    QString m_endpoint;
+    bool m_started;
+    bool m_obtainingEndpoint;
+    int m_endpointRetries;
+
+    // Singleton.
+    static QPointer<UploadQueue> s_instance;
+};
+
+#endif // UPLOADQUEUE_H
@@ -36,6 +36,7 @@
 #include "miscellaneous/iconfactory.h"
 #include "miscellaneous/iofactory.h"
 #include "core/templatefactory.h"
+#include "miscellaneous/performancemonitor.h"
 
 #include <QTimer>
 #include <QFileDialog>
@@ -141,6 +142,8 @@ bool FlashCardEditor::canGenerateApplications() {
 }
 
 QString FlashCardEditor::generateBundleData() {
+  PERF_SCOPE("bundle.generate");
+
   /*if (!canGenerateApplications()) {
     return QString();
   }*/
@@ -186,6 +189,8 @@ QString FlashCardEditor::generateBundleData() {
 }
 
 bool FlashCardEditor::loadBundleData(const QString &bundle_data) {
+  PERF_SCOPE("bundle.load");
+
   QDomDocument bundle_document;
   bundle_document.setContent(bundle_data);
 
@@ -242,6 +247,10 @@ QList<FlashCardQuestion> FlashCardEditor::activeQuestions() const {
   return questions;
 }
 
+FlashCardQuestion FlashCardEditor::questionAt(int index) const {
+  return m_ui->m_listQuestions->item(index)->data(Qt::UserRole).value<FlashCardQuestion>();
+}
+
 QString FlashCardEditor::projectName() {
   return m_ui->m_txtName->lineEdit()->text();
 }
@@ -334,6 +343,7 @@ void FlashCardEditor::moveQuestionUp() {
   m_ui->m_listQuestions->insertItem(index - 1, m_ui->m_listQuestions->takeItem(index));
   m_ui->m_listQuestions->setCurrentRow(index - 1);
 
+  emit itemMoved(index, index - 1);
   emit changed();
 }
 
@@ -343,6 +353,7 @@ void FlashCardEditor::moveQuestionDown() {
   m_ui->m_listQuestions->insertItem(index + 1, m_ui->m_listQuestions->takeItem(index));
   m_ui->m_listQuestions->setCurrentRow(index + 1);
 
+  emit itemMoved(index, index + 1);
   emit changed();
 }
 
@@ -395,6 +406,7 @@ void FlashCardEditor::addQuestion(const QString &question,
   }
 
   updateQuestionCount();
+  emit itemInserted(m_ui->m_listQuestions->currentRow());
 }
 
 void FlashCardEditor::addQuestion() {
@@ -451,6 +463,7 @@ void FlashCardEditor::saveQuestion() {
   m_ui->m_listQuestions->currentItem()->setData(Qt::UserRole, QVariant::fromValue(m_activeQuestion));
   m_ui->m_listQuestions->currentItem()->setText(m_activeQuestion.question());
 
+  emit itemModified(m_ui->m_listQuestions->currentRow());
   emit changed();
 }
 
@@ -466,6 +479,7 @@ void FlashCardEditor::removeQuestion() {
     }
 
     delete m_ui->m_listQuestions->takeItem(current_row);
+    emit itemRemoved(current_row);
   }
 
   updateQuestionCount();
@@ -493,6 +507,7 @@ void FlashCardEditor::onAuthorChanged(const QString& new_author) {
   checkAuthor();
 
   launch();
+  emit metadataModified();
   emit changed();
 }
 
@@ -502,6 +517,7 @@ void FlashCardEditor::onNameChanged(const QString& new_name) {
   checkName();
 
   launch();
+  emit metadataModified();
   emit changed();
 }
 
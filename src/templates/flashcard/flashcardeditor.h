@@ -56,6 +56,7 @@ class FlashCardEditor : public TemplateEditor {
     bool loadBundleData(const QString &bundle_data);
 
     QList<FlashCardQuestion> activeQuestions() const;
+    FlashCardQuestion questionAt(int index) const;
 
     QString projectName();
     QString authorName();
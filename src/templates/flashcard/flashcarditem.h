@@ -57,7 +57,9 @@ class FlashCardItem : public QWidget {
     /// \param question_number Number of the question.
     void setQuestion(const FlashCardQuestion &question, int question_number, int total_questions);
 
-  private slots:
+  public slots:
+    /// \brief Flips the card to given side.
+    /// \param target_side Index of target side, -1 flips to opposite side.
     void flip(int target_side = -1);
 
   signals:
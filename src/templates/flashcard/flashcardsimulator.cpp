@@ -40,7 +40,8 @@
 
 FlashCardSimulator::FlashCardSimulator(TemplateCore *core, QWidget *parent)
   : TemplateSimulator(core, parent),
-    m_ui(new Ui::FlashCardSimulator) {
+    m_ui(new Ui::FlashCardSimulator), m_cardItem(NULL),
+    m_questions(QList<FlashCardQuestion>()), m_activeQuestion(-1) {
   m_ui->setupUi(this);
 
   QFont caption_font = m_ui->m_lblHeading->font();
@@ -66,31 +67,15 @@ bool FlashCardSimulator::startSimulation() {
     return false;
   }
 
-  // Remove existing flash cards.
-  while (m_ui->m_phoneWidget->count() > 3) {
-    QWidget *question_widget = m_ui->m_phoneWidget->widget(2);
-
-    m_ui->m_phoneWidget->removeWidget(question_widget);
-    question_widget->deleteLater();
-  }
-
-  // Load the questions, setup the quiz and start it.
+  // Load the questions, setup the quiz and start it. Widgets for flash cards
+  // are not created here, single recycled widget is bound to active card
+  // once user gets there.
   m_ui->m_btnStart->setEnabled(true);
   m_ui->m_lblAuthor->setText(editor->m_ui->m_txtAuthor->lineEdit()->text());
   m_ui->m_lblHeading->setText(editor->m_ui->m_txtName->lineEdit()->text());
 
-  int question_number = 1;
-  QList<FlashCardQuestion> questions = editor->activeQuestions();
-
-  foreach (const FlashCardQuestion &question, questions) {
-    FlashCardItem *item = new FlashCardItem(m_ui->m_phoneWidget);
-
-    connect(item, SIGNAL(nextCardRequested()), this, SLOT(moveToNextCard()));
-    connect(item, SIGNAL(previousCardRequested()), this, SLOT(moveToPreviousCard()));
-
-    item->setQuestion(question, question_number++, questions.size());
-    m_ui->m_phoneWidget->insertWidget(m_ui->m_phoneWidget->count() - 1, item);
-  }
+  m_questions = editor->activeQuestions();
+  m_activeQuestion = -1;
 
   // Go to "start" page and begin.
   m_ui->m_phoneWidget->setCurrentIndex(1);
@@ -109,32 +94,193 @@ bool FlashCardSimulator::goBack() {
   return false;
 }
 
+bool FlashCardSimulator::performAction(const QString &action, const QString &argument) {
+  bool card_active = m_cardItem != NULL && m_ui->m_phoneWidget->currentWidget() == m_cardItem;
+
+  if (action == "start" && m_ui->m_phoneWidget->currentIndex() == 1) {
+    start();
+    return true;
+  }
+  else if (action == "flip" && card_active) {
+    m_cardItem->flip();
+    return true;
+  }
+  else if (action == "next" && card_active) {
+    moveToNextCard();
+    return true;
+  }
+  else if (action == "previous" && card_active) {
+    moveToPreviousCard();
+    return true;
+  }
+  else if (action == "restart" && m_ui->m_phoneWidget->currentWidget() == m_ui->m_pageFinish) {
+    restart();
+    return true;
+  }
+  else {
+    return TemplateSimulator::performAction(action, argument);
+  }
+}
+
+QString FlashCardSimulator::simulationState() const {
+  if (m_ui->m_phoneWidget->currentIndex() == 0) {
+    return "stopped";
+  }
+  else if (m_ui->m_phoneWidget->currentIndex() == 1) {
+    return "welcome";
+  }
+  else if (m_cardItem != NULL && m_ui->m_phoneWidget->currentWidget() == m_cardItem) {
+    return QString("card %1/%2").arg(QString::number(m_activeQuestion + 1),
+                                     QString::number(m_questions.size()));
+  }
+  else {
+    return "finished";
+  }
+}
+
+void FlashCardSimulator::onItemInserted(int index) {
+  if (!isRunning()) {
+    return;
+  }
+
+  m_questions.insert(index, static_cast<FlashCardEditor*>(core()->editor())->questionAt(index));
+
+  if (m_activeQuestion >= index) {
+    m_activeQuestion++;
+  }
+
+  refreshActiveCard();
+}
+
+void FlashCardSimulator::onItemRemoved(int index) {
+  if (!isRunning()) {
+    return;
+  }
+
+  m_questions.removeAt(index);
+
+  if (m_questions.isEmpty()) {
+    // There is nothing to simulate anymore.
+    stopSimulation();
+    emit simulationStopRequested();
+    return;
+  }
+
+  if (m_activeQuestion > index) {
+    m_activeQuestion--;
+  }
+  else if (m_activeQuestion == index) {
+    // Displayed card was removed, show the following one.
+    m_activeQuestion--;
+    moveToNextCard();
+    return;
+  }
+
+  refreshActiveCard();
+}
+
+void FlashCardSimulator::onItemMoved(int from_index, int to_index) {
+  if (!isRunning()) {
+    return;
+  }
+
+  m_questions.move(from_index, to_index);
+
+  if (m_activeQuestion == from_index) {
+    m_activeQuestion = to_index;
+  }
+  else if (from_index < m_activeQuestion && to_index >= m_activeQuestion) {
+    m_activeQuestion--;
+  }
+  else if (from_index > m_activeQuestion && to_index <= m_activeQuestion) {
+    m_activeQuestion++;
+  }
+
+  refreshActiveCard();
+}
+
+void FlashCardSimulator::onItemModified(int index) {
+  if (!isRunning() || index < 0 || index >= m_questions.size()) {
+    return;
+  }
+
+  m_questions[index] = static_cast<FlashCardEditor*>(core()->editor())->questionAt(index);
+  refreshActiveCard();
+}
+
+void FlashCardSimulator::onMetadataModified() {
+  if (!isRunning()) {
+    return;
+  }
+
+  FlashCardEditor *editor = static_cast<FlashCardEditor*>(core()->editor());
+
+  m_ui->m_lblAuthor->setText(editor->m_ui->m_txtAuthor->lineEdit()->text());
+  m_ui->m_lblHeading->setText(editor->m_ui->m_txtName->lineEdit()->text());
+}
+
+bool FlashCardSimulator::isRunning() const {
+  return m_ui->m_phoneWidget->currentIndex() != 0;
+}
+
+void FlashCardSimulator::refreshActiveCard() {
+  if (m_ui->m_phoneWidget->currentWidget() == m_cardItem &&
+      m_activeQuestion >= 0 && m_activeQuestion < m_questions.size()) {
+    m_cardItem->setQuestion(m_questions.at(m_activeQuestion), m_activeQuestion + 1, m_questions.size());
+  }
+}
+
 void FlashCardSimulator::start() {
   moveToNextCard();
 }
 
 void FlashCardSimulator::restart() {
+  m_activeQuestion = -1;
   m_ui->m_phoneWidget->setCurrentIndex(1);
 }
 
-void FlashCardSimulator::moveToNextCard() {
-  int current_index = m_ui->m_phoneWidget->currentIndex();
+FlashCardItem *FlashCardSimulator::cardItem() {
+  if (m_cardItem == NULL) {
+    m_cardItem = new FlashCardItem(m_ui->m_phoneWidget);
 
-  if (current_index < m_ui->m_phoneWidget->count() - 2) {
-    // We are not on the last flash card.
-    static_cast<FlashCardItem*>(m_ui->m_phoneWidget->widget(current_index + 1))->reset();
+    connect(m_cardItem, SIGNAL(nextCardRequested()), this, SLOT(moveToNextCard()));
+    connect(m_cardItem, SIGNAL(previousCardRequested()), this, SLOT(moveToPreviousCard()));
+
+    m_ui->m_phoneWidget->insertWidget(m_ui->m_phoneWidget->indexOf(m_ui->m_pageFinish), m_cardItem);
   }
 
-  m_ui->m_phoneWidget->setCurrentIndex(current_index + 1);
+  return m_cardItem;
 }
 
-void FlashCardSimulator::moveToPreviousCard() {
-  int current_index = m_ui->m_phoneWidget->currentIndex();
+void FlashCardSimulator::displayCard(int index) {
+  FlashCardItem *item = cardItem();
 
-  if (current_index > 1) {
-    // We are not on the first flash card.
-    static_cast<FlashCardItem*>(m_ui->m_phoneWidget->widget(current_index - 1))->reset();
+  m_activeQuestion = index;
+
+  item->setQuestion(m_questions.at(index), index + 1, m_questions.size());
+  item->reset();
+
+  m_ui->m_phoneWidget->setCurrentWidget(item);
+}
+
+void FlashCardSimulator::moveToNextCard() {
+  if (m_activeQuestion + 1 < m_questions.size()) {
+    // We are not on the last flash card.
+    displayCard(m_activeQuestion + 1);
+  }
+  else {
+    m_activeQuestion = m_questions.size();
+    m_ui->m_phoneWidget->setCurrentWidget(m_ui->m_pageFinish);
   }
+}
 
-  m_ui->m_phoneWidget->setCurrentIndex(current_index - 1);
+void FlashCardSimulator::moveToPreviousCard() {
+  if (m_activeQuestion > 0) {
+    // We are not on the first flash card.
+    displayCard(m_activeQuestion - 1);
+  }
+  else {
+    m_activeQuestion = -1;
+    m_ui->m_phoneWidget->setCurrentIndex(1);
+  }
 }
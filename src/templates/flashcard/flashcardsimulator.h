@@ -34,12 +34,15 @@
 #include "core/templatesimulator.h"
 
 #include "ui_flashcardsimulator.h"
+#include "templates/flashcard/flashcardquestion.h"
 
 
 namespace Ui {
   class FlashCardSimulator;
 }
 
+class FlashCardItem;
+
 class FlashCardSimulator : public TemplateSimulator {
     Q_OBJECT
 
@@ -48,19 +51,46 @@ class FlashCardSimulator : public TemplateSimulator {
     explicit FlashCardSimulator(TemplateCore *core, QWidget *parent = 0);
     virtual ~FlashCardSimulator();
 
+    bool performAction(const QString &action, const QString &argument = QString());
+    QString simulationState() const;
+
   public slots:
     bool startSimulation();
     bool stopSimulation();
     bool goBack();
 
+    void onItemInserted(int index);
+    void onItemRemoved(int index);
+    void onItemMoved(int from_index, int to_index);
+    void onItemModified(int index);
+    void onMetadataModified();
+
   private slots:
     void start();
     void restart();
     void moveToNextCard();
     void moveToPreviousCard();
 
+  private:
+    // Returns recycled widget for displaying of flash cards, widget
+    // is created when it is needed for the first time.
+    FlashCardItem *cardItem();
+
+    // Binds flash card with given index to recycled widget and displays it.
+    void displayCard(int index);
+
+    // Refreshes displayed flash card after cards were patched
+    // by the editor, visible side of the card is kept.
+    void refreshActiveCard();
+
+    // Returns true if simulation is running and follows editor changes.
+    bool isRunning() const;
+
   private:
     Ui::FlashCardSimulator *m_ui;
+    FlashCardItem *m_cardItem;
+    QList<FlashCardQuestion> m_questions;
+    int m_activeQuestion;
 };
 
 #endif // FLASHCARDSIMULATOR_H
@@ -38,20 +38,64 @@
 #include "core/templatefactory.h"
 #include "core/templategenerator.h"
 #include "core/templateentrypoint.h"
+#include "network-web/ttsservice.h"
 
 #include <QFile>
 #include <QTextStream>
 #include <QDir>
 #include <QProcess>
+#include <QDomDocument>
+#include <QFileInfo>
 
 
 LearnSpellingsCore::LearnSpellingsCore(TemplateEntryPoint *entry_point, QObject *parent)
-  : TemplateCore(entry_point, parent) {
+  : TemplateCore(entry_point, parent), m_audioFiles(QHash<QString, QString>()) {
   m_editor = new LearnSpellingsEditor(this);
   m_simulator = new LearnSpellingsSimulator(this);
 }
 
 LearnSpellingsCore::~LearnSpellingsCore() {
+  releaseAudio();
+}
+
+void LearnSpellingsCore::prepareGeneration() {
+  if (!qApp->settings()->value(APP_CFG_TTS, "bundle_audio", false).toBool()) {
+    TemplateCore::prepareGeneration();
+    return;
+  }
+
+  // Audio of words is pre-synthesized, so that application
+  // does not need to call TTS service.
+  TtsService *tts = TtsService::instance();
+  QStringList words;
+
+  foreach (const LearnSpellingsItem &item, learnSpellingsEditor()->activeWords()) {
+    words.append(item.word());
+  }
+
+  emit generationProgress(2, tr("Synthesizing audio of words..."));
+
+  connect(tts, SIGNAL(batchFinished(QHash<QString,QString>,int)), this, SLOT(onAudioSynthesized(QHash<QString,QString>,int)));
+
+  if (!tts->startBatch(words)) {
+    disconnect(tts, SIGNAL(batchFinished(QHash<QString,QString>,int)), this, SLOT(onAudioSynthesized(QHash<QString,QString>,int)));
+    emit generationPrepared(false);
+  }
+}
+
+void LearnSpellingsCore::onAudioSynthesized(const QHash<QString, QString> &audio_files, int failed_words) {
+  disconnect(TtsService::instance(), SIGNAL(batchFinished(QHash<QString,QString>,int)),
+             this, SLOT(onAudioSynthesized(QHash<QString,QString>,int)));
+
+  if (failed_words > 0) {
+    // Application uses online TTS service for words which are missing.
+    qWarning("Audio of %d words was not synthesized, they are not bundled.", failed_words);
+  }
+
+  releaseAudio();
+  m_audioFiles = audio_files;
+
+  emit generationPrepared(true);
 }
 
 TemplateCore::GenerationResult LearnSpellingsCore::generateMobileApplication(const QString &input_apk_file, QString &output_file) {
@@ -66,6 +110,7 @@ TemplateCore::GenerationResult LearnSpellingsCore::generateMobileApplication(con
 
   if (quiz_data.isEmpty()) {
     // No date received, this is big problem.
+    releaseAudio();
     return BundleProblem;
   }
 
@@ -91,6 +136,20 @@ TemplateCore::GenerationResult LearnSpellingsCore::generateMobileApplication(con
   out.flush();
   index_file.close();
 
+  if (qApp->settings()->value(APP_CFG_TTS, "bundle_audio", false).toBool()) {
+    // Audio was synthesized when generating was prepared.
+    emit generationProgress(35, tr("Bundling audio of words..."));
+
+    bool audio_bundled = bundleAudio(base_folder + "/assets/audio");
+
+    releaseAudio();
+
+    if (!audio_bundled) {
+      qApp->templateManager()->generator()->cleanWorkspace();
+      return CopyProblem;
+    }
+  }
+
   emit generationProgress(40, tr("Copying template apk file..."));
 
   // Copying of target apk file.
@@ -150,6 +209,63 @@ TemplateCore::GenerationResult LearnSpellingsCore::generateMobileApplication(con
   return Success;
 }
 
+bool LearnSpellingsCore::bundleAudio(const QString &audio_folder) {
+  TtsService *tts = TtsService::instance();
+  const QHash<QString, QString> &audio_files = m_audioFiles;
+
+  if (!QDir().mkpath(audio_folder)) {
+    return false;
+  }
+
+  QDomDocument index_document;
+  QDomElement root_element = index_document.createElement("audio");
+
+  root_element.setAttribute("locale", tts->locale());
+  root_element.setAttribute("voice", tts->voice());
+  index_document.appendChild(root_element);
+
+  foreach (const QString &word, audio_files.keys()) {
+    QString file_name = QFileInfo(audio_files.value(word)).fileName();
+
+    if (!QFile::exists(audio_folder + "/" + file_name) &&
+        !QFile::copy(audio_files.value(word), audio_folder + "/" + file_name)) {
+      // Files are pinned in cache, so this is an I/O error.
+      qWarning("Audio of word '%s' cannot be bundled.", qPrintable(word));
+      continue;
+    }
+
+    QDomElement item_element = index_document.createElement("item");
+    QDomElement word_element = index_document.createElement("word");
+    QDomElement file_element = index_document.createElement("file");
+
+    word_element.appendChild(index_document.createTextNode(word));
+    file_element.appendChild(index_document.createTextNode(file_name));
+    item_element.appendChild(word_element);
+    item_element.appendChild(file_element);
+    root_element.appendChild(item_element);
+  }
+
+  QFile audio_index_file(audio_folder + "/index.xml");
+
+  if (!audio_index_file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+    return false;
+  }
+
+  QTextStream out(&audio_index_file);
+  out << index_document.toString(XML_BUNDLE_INDENTATION);
+  out.flush();
+  audio_index_file.close();
+
+  return true;
+}
+
+void LearnSpellingsCore::releaseAudio() {
+  if (!m_audioFiles.isEmpty()) {
+    TtsService::instance()->releaseFiles(m_audioFiles.values());
+    m_audioFiles.clear();
+  }
+}
+
 LearnSpellingsEditor *LearnSpellingsCore::learnSpellingsEditor() {
   return static_cast<LearnSpellingsEditor*>(editor());
 }
@@ -33,6 +33,8 @@
 
 #include "core/templatecore.h"
 
+#include <QHash>
+
 
 class TemplateEntryPoint;
 class LearnSpellingsEditor;
@@ -48,8 +50,20 @@ class LearnSpellingsCore : public TemplateCore {
     virtual ~LearnSpellingsCore();
 
     GenerationResult generateMobileApplication(const QString &input_apk_file, QString &output_file);
+    void prepareGeneration();
+
+  private slots:
+    void onAudioSynthesized(const QHash<QString, QString> &audio_files, int failed_words);
 
   private:
+    // Stores synthesized audio together with index file into given folder.
+    bool bundleAudio(const QString &audio_folder);
+
+    // Releases synthesized audio files back to TTS cache.
+    void releaseAudio();
+
+    QHash<QString, QString> m_audioFiles;
+
     LearnSpellingsEditor *learnSpellingsEditor();
     LearnSpellingsSimulator *learnSpellingsSimulator();
 };
@@ -35,6 +35,7 @@
 #include "core/templatefactory.h"
 #include "core/templatecore.h"
 #include "core/templateentrypoint.h"
+#include "miscellaneous/performancemonitor.h"
 
 #include <QTimer>
 
@@ -102,6 +103,8 @@ LearnSpellingsEditor::~LearnSpellingsEditor() {
 }
 
 QString LearnSpellingsEditor::generateBundleData() {
+  PERF_SCOPE("bundle.generate");
+
   /*if (!canGenerateApplications()) {
     return QString();
   }*/
@@ -134,6 +137,8 @@ QString LearnSpellingsEditor::generateBundleData() {
 }
 
 bool LearnSpellingsEditor::loadBundleData(const QString &bundle_data) {
+  PERF_SCOPE("bundle.load");
+
   QDomDocument bundle_document;
   bundle_document.setContent(bundle_data);
 
@@ -192,6 +197,7 @@ void LearnSpellingsEditor::addQuizWord(const QString &title, const QString &desc
   }
 
   updateItemCount();
+  emit itemInserted(m_ui->m_listItems->currentRow());
 }
 
 void LearnSpellingsEditor::addQuizWord() {
@@ -228,6 +234,7 @@ void LearnSpellingsEditor::onAuthorChanged(const QString& new_author) {
   checkAuthor();
 
   launch();
+  emit metadataModified();
   emit changed();
 }
 
@@ -237,6 +244,7 @@ void LearnSpellingsEditor::onNameChanged(const QString& new_name) {
   checkName();
 
   launch();
+  emit metadataModified();
   emit changed();
 }
 
@@ -273,6 +281,10 @@ QList<LearnSpellingsItem> LearnSpellingsEditor::activeWords() const {
   return questions;
 }
 
+LearnSpellingsItem LearnSpellingsEditor::wordAt(int index) const {
+  return m_ui->m_listItems->item(index)->data(Qt::UserRole).value<LearnSpellingsItem>();
+}
+
 bool LearnSpellingsEditor::canGenerateApplications() {
   return
       !activeWords().isEmpty() &&
@@ -311,6 +323,7 @@ void LearnSpellingsEditor::removeSelectedWord() {
     }
 
     delete m_ui->m_listItems->takeItem(current_row);
+    emit itemRemoved(current_row);
   }
 
   updateItemCount();
@@ -325,6 +338,7 @@ void LearnSpellingsEditor::saveWord() {
   m_ui->m_listItems->currentItem()->setData(Qt::UserRole, QVariant::fromValue(m_activeItem));
   m_ui->m_listItems->currentItem()->setText(m_activeItem.word());
 
+  emit itemModified(m_ui->m_listItems->currentRow());
   emit changed();
 }
 
@@ -359,6 +373,7 @@ void LearnSpellingsEditor::moveWordUp() {
   m_ui->m_listItems->insertItem(index - 1, m_ui->m_listItems->takeItem(index));
   m_ui->m_listItems->setCurrentRow(index - 1);
 
+  emit itemMoved(index, index - 1);
   emit changed();
 }
 
@@ -368,6 +383,7 @@ void LearnSpellingsEditor::moveWordDown() {
   m_ui->m_listItems->insertItem(index + 1, m_ui->m_listItems->takeItem(index));
   m_ui->m_listItems->setCurrentRow(index + 1);
 
+  emit itemMoved(index, index + 1);
   emit changed();
 }
 
@@ -54,6 +54,7 @@ class LearnSpellingsEditor : public TemplateEditor {
     virtual ~LearnSpellingsEditor();
 
     QList<LearnSpellingsItem> activeWords() const;
+    LearnSpellingsItem wordAt(int index) const;
 
     QString generateBundleData();
     bool loadBundleData(const QString &bundle_data);
@@ -32,9 +32,9 @@
 
 #include "definitions/definitions.h"
 #include "core/templatecore.h"
-#include "core/templatefactory.h"
 #include "gui/custommessagebox.h"
 #include "network-web/networkfactory.h"
+#include "network-web/ttsservice.h"
 #include "miscellaneous/iofactory.h"
 #include "miscellaneous/application.h"
 #include "templates/learnspellings/learnspellingseditor.h"
@@ -44,11 +44,11 @@
 #include <QTextStream>
 #include <QDataStream>
 #include <QDir>
-#include <QDateTime>
 
 
 LearnSpellingsSimulator::LearnSpellingsSimulator(TemplateCore *core, QWidget *parent)
-  : TemplateSimulator(core, parent), m_ui(new Ui::LearnSpellingsSimulator), m_words(QList<LearnSpellingsItem>()), m_activeWord(-1) {
+  : TemplateSimulator(core, parent), m_ui(new Ui::LearnSpellingsSimulator), m_words(QList<LearnSpellingsItem>()), m_activeWord(-1),
+    m_pendingWord(QString()) {
   m_ui->setupUi(this);
 
   QFont caption_font = m_ui->m_lblQuestionNumber->font();
@@ -66,6 +66,9 @@ LearnSpellingsSimulator::LearnSpellingsSimulator(TemplateCore *core, QWidget *pa
   connect(m_ui->m_btnSkip, SIGNAL(clicked()), this, SLOT(skipThisWord()));
   connect(m_ui->m_btnSpellIt, SIGNAL(clicked()), this, SLOT(spellThisWord()));
   connect(m_ui->m_btnGoToNextWord, SIGNAL(clicked()), this, SLOT(loadNextWord()));
+  connect(TtsService::instance(), SIGNAL(audioReady(QString,QString)), this, SLOT(onAudioReady(QString,QString)));
+  connect(TtsService::instance(), SIGNAL(audioFailed(QString,QNetworkReply::NetworkError)),
+          this, SLOT(onAudioFailed(QString,QNetworkReply::NetworkError)));
 }
 
 LearnSpellingsSimulator::~LearnSpellingsSimulator() {
@@ -108,6 +111,151 @@ bool LearnSpellingsSimulator::goBack() {
   return false;
 }
 
+bool LearnSpellingsSimulator::performAction(const QString &action, const QString &argument) {
+  bool word_active = m_ui->m_phoneWidget->currentIndex() == 2;
+
+  if (action == "start" && m_ui->m_phoneWidget->currentIndex() == 1) {
+    start();
+    return true;
+  }
+  else if (action == "play" && word_active && m_ui->m_listener->currentIndex() == 0) {
+    playWord();
+    return true;
+  }
+  else if (action == "spell" && word_active && m_ui->m_listener->currentIndex() == 0 && !argument.simplified().isEmpty()) {
+    checkSpelling(argument.simplified());
+    return true;
+  }
+  else if (action == "skip" && word_active && m_ui->m_listener->currentIndex() == 0) {
+    skipThisWord();
+    return true;
+  }
+  else if (action == "next" && word_active && m_ui->m_listener->currentIndex() == 1) {
+    loadNextWord();
+    return true;
+  }
+  else if (action == "restart" && m_ui->m_phoneWidget->currentIndex() == 3) {
+    restart();
+    return true;
+  }
+  else if (action == "exit" && m_ui->m_phoneWidget->currentIndex() == 3) {
+    exit();
+    return true;
+  }
+  else {
+    return TemplateSimulator::performAction(action, argument);
+  }
+}
+
+QString LearnSpellingsSimulator::simulationState() const {
+  switch (m_ui->m_phoneWidget->currentIndex()) {
+    case 0:
+      return "stopped";
+
+    case 1:
+      return "welcome";
+
+    case 2:
+      return QString("word %1/%2").arg(QString::number(m_activeWord + 1),
+                                       QString::number(m_words.size()));
+
+    default:
+      return QString("finished correct=%1 wrong=%2 skipped=%3").arg(QString::number(m_resultCorrect),
+                                                                  QString::number(m_resultIncorrect),
+                                                                  QString::number(m_resultSkipped));
+  }
+}
+
+void LearnSpellingsSimulator::onItemInserted(int index) {
+  if (!isRunning()) {
+    return;
+  }
+
+  m_words.insert(index, static_cast<LearnSpellingsEditor*>(core()->editor())->wordAt(index));
+
+  if (m_activeWord >= index) {
+    m_activeWord++;
+  }
+
+  refreshWordNumber();
+}
+
+void LearnSpellingsSimulator::onItemRemoved(int index) {
+  if (!isRunning()) {
+    return;
+  }
+
+  m_words.removeAt(index);
+
+  if (m_words.isEmpty()) {
+    // There is nothing to simulate anymore.
+    exit();
+    return;
+  }
+
+  if (m_activeWord > index) {
+    m_activeWord--;
+  }
+  else if (m_activeWord == index && m_ui->m_phoneWidget->currentIndex() == 2) {
+    // Active word was removed, continue with the following one.
+    m_activeWord--;
+    loadNextWord();
+    return;
+  }
+
+  refreshWordNumber();
+}
+
+void LearnSpellingsSimulator::onItemMoved(int from_index, int to_index) {
+  if (!isRunning()) {
+    return;
+  }
+
+  m_words.move(from_index, to_index);
+
+  if (m_activeWord == from_index) {
+    m_activeWord = to_index;
+  }
+  else if (from_index < m_activeWord && to_index >= m_activeWord) {
+    m_activeWord--;
+  }
+  else if (from_index > m_activeWord && to_index <= m_activeWord) {
+    m_activeWord++;
+  }
+
+  refreshWordNumber();
+}
+
+void LearnSpellingsSimulator::onItemModified(int index) {
+  if (!isRunning() || index < 0 || index >= m_words.size()) {
+    return;
+  }
+
+  m_words[index] = static_cast<LearnSpellingsEditor*>(core()->editor())->wordAt(index);
+}
+
+void LearnSpellingsSimulator::onMetadataModified() {
+  if (!isRunning()) {
+    return;
+  }
+
+  LearnSpellingsEditor *editor = static_cast<LearnSpellingsEditor*>(core()->editor());
+
+  m_ui->m_lblAuthor->setText(editor->m_ui->m_txtAuthor->lineEdit()->text());
+  m_ui->m_lblHeading->setText(editor->m_ui->m_txtName->lineEdit()->text());
+}
+
+bool LearnSpellingsSimulator::isRunning() const {
+  return m_ui->m_phoneWidget->currentIndex() != 0;
+}
+
+void LearnSpellingsSimulator::refreshWordNumber() {
+  if (m_ui->m_phoneWidget->currentIndex() == 2) {
+    m_ui->m_lblQuestionNumber->setText(tr("Word #%1 of %2").arg(QString::number(m_activeWord + 1),
+                                                                QString::number(m_words.size())));
+  }
+}
+
 void LearnSpellingsSimulator::start() {
   m_activeWord = -1;
   m_resultCorrect = m_resultIncorrect = m_resultSkipped = 0;
@@ -132,53 +280,51 @@ void LearnSpellingsSimulator::playWord() {
   else {
     CustomMessageBox::show(this, QMessageBox::Warning, tr("Cannot play sound"), tr("Sound cannot play on this platform."));
   }
+
+  m_ui->m_btnSkip->setEnabled(true);
+  m_ui->m_btnSpellIt->setEnabled(true);
 #else
-  // Play sound.
-  QByteArray output;
-
-  LearnSpellingsItem current_item = m_words.at(m_activeWord);
-
-  if (current_item.audioFilePath().isEmpty() || !QFile::exists(current_item.audioFilePath())) {
-    // Current word does not contain downloaded audio file.
-    QString word = m_words.at(m_activeWord).word().replace(' ', '+');
-    //QString word = QUrl::toPercentEncoding(m_words.at(m_activeWord).word());
-    QString url = QString(TTS_SERVICE_URL).arg(word);
-    QNetworkReply::NetworkError result_of_download = NetworkFactory::downloadFile(url, 10000, output);
-
-    if (result_of_download != QNetworkReply::NoError) {
-      // There was apparently some error.
-      if (SystemTrayIcon::isSystemTrayAvailable()) {
-        qApp->trayIcon()->showMessage(tr("Cannot play sound"), tr("Sound cannot play on this platform because sound file was not downloaded."),
-                                      QSystemTrayIcon::Warning);
-      }
-      else {
-        CustomMessageBox::show(this, QMessageBox::Warning, tr("Cannot play sound"), tr("Sound cannot play on this platform because sound file was not downloaded."));
-      }
-
-      return;
-    }
+  // Audio is obtained asynchronously, it is played once it is available.
+  m_pendingWord = m_words.at(m_activeWord).word();
+  m_ui->m_btnPlayWord->setEnabled(false);
 
-    // Store downloaded sound file.
-    QString sound_file_name = qApp->templateManager()->tempDirectory() + QDir::separator() +
-                              "sound_" + QDateTime::currentDateTime().toString("yyyy-MM-dd-hhmmss") + ".wav";
-    QFile sound_file(sound_file_name);
-    sound_file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Unbuffered);
-    sound_file.write(output);
-    sound_file.close();
+  TtsService::instance()->requestWord(m_pendingWord);
+#endif
+}
 
-    // We obtained new sound file for this particular word.
-    // So, store the path.
-    // NOTE: Note that this is forgotten when new simulation is started.
-    m_words[m_activeWord].setAudioFilePath(sound_file_name);
+void LearnSpellingsSimulator::onAudioReady(const QString &word, const QString &audio_file) {
+  if (m_pendingWord.isEmpty() || word != m_pendingWord) {
+    // This is not audio for active word, it was probably prefetched.
+    return;
   }
 
-  IOFactory::playWaveFile(m_words.at(m_activeWord).audioFilePath());
-#endif
+  m_pendingWord.clear();
+  m_ui->m_btnPlayWord->setEnabled(true);
+
+  IOFactory::playWaveFile(audio_file);
 
   m_ui->m_btnSkip->setEnabled(true);
   m_ui->m_btnSpellIt->setEnabled(true);
 }
 
+void LearnSpellingsSimulator::onAudioFailed(const QString &word, QNetworkReply::NetworkError error) {
+  if (m_pendingWord.isEmpty() || word != m_pendingWord) {
+    return;
+  }
+
+  m_pendingWord.clear();
+  m_ui->m_btnPlayWord->setEnabled(true);
+
+  QString message = tr("Sound cannot play because sound file was not downloaded: %1.").arg(NetworkFactory::networkErrorText(error));
+
+  if (SystemTrayIcon::isSystemTrayAvailable()) {
+    qApp->trayIcon()->showMessage(tr("Cannot play sound"), message, QSystemTrayIcon::Warning);
+  }
+  else {
+    CustomMessageBox::show(this, QMessageBox::Warning, tr("Cannot play sound"), message);
+  }
+}
+
 void LearnSpellingsSimulator::skipThisWord() {
   m_resultSkipped++;
   loadNextWord();
@@ -189,30 +335,35 @@ void LearnSpellingsSimulator::spellThisWord() {
   // then increment.
   // then display "word result page"
   QString guessed_word = QInputDialog::getText(this, tr("Enter spelling"), tr("Enter spelling")).simplified();
-  LearnSpellingsItem current_word = m_words.at(m_activeWord);
 
   if (!guessed_word.isEmpty()) {
-    if (QString::compare(guessed_word, current_word.word(), Qt::CaseInsensitive) == 0) {
-      // User guessed the word!!!
-      m_resultCorrect++;
-      m_ui->m_lblResultCaption->setText(tr("This is correct spelling"));
-    }
-    else {
-      // User made a mistake.
-      m_resultIncorrect++;
-      m_ui->m_lblResultCaption->setText(tr("This is not the correct spelling"));
-    }
-
-    // Display page with overview of current word status.
-    m_ui->m_lblEnteredWord->setText(tr("You entered %1").arg(guessed_word));
-    m_ui->m_lblCorrectWordDescription->setText(tr("<p style=\" font-size: 18pt;\">%1</p><p>%2</p>").arg(current_word.word(), current_word.meaning()));
-    m_ui->m_listener->setCurrentIndex(1);
+    checkSpelling(guessed_word);
   }
   else {
     CustomMessageBox::show(this, QMessageBox::Warning, tr("Enter some word"), tr("You must enter some word"));
   }
 }
 
+void LearnSpellingsSimulator::checkSpelling(const QString &guessed_word) {
+  LearnSpellingsItem current_word = m_words.at(m_activeWord);
+
+  if (QString::compare(guessed_word, current_word.word(), Qt::CaseInsensitive) == 0) {
+    // User guessed the word!!!
+    m_resultCorrect++;
+    m_ui->m_lblResultCaption->setText(tr("This is correct spelling"));
+  }
+  else {
+    // User made a mistake.
+    m_resultIncorrect++;
+    m_ui->m_lblResultCaption->setText(tr("This is not the correct spelling"));
+  }
+
+  // Display page with overview of current word status.
+  m_ui->m_lblEnteredWord->setText(tr("You entered %1").arg(guessed_word));
+  m_ui->m_lblCorrectWordDescription->setText(tr("<p style=\" font-size: 18pt;\">%1</p><p>%2</p>").arg(current_word.word(), current_word.meaning()));
+  m_ui->m_listener->setCurrentIndex(1);
+}
+
 void LearnSpellingsSimulator::loadNextWord() {
   m_activeWord++;
   m_ui->m_lblQuestionNumber->setText(tr("Word #%1 of %2").arg(QString::number(m_activeWord + 1),
@@ -220,8 +371,20 @@ void LearnSpellingsSimulator::loadNextWord() {
 
   if (m_activeWord < m_words.size()) {
     // We are not viewing last word, display the "listening" page.
+    m_pendingWord.clear();
+    m_ui->m_btnPlayWord->setEnabled(true);
     m_ui->m_btnSkip->setEnabled(false);
     m_ui->m_btnSpellIt->setEnabled(false);
+
+    // Fetch audio of active and following words while user is spelling.
+    QStringList prefetched_words;
+
+    for (int i = m_activeWord; i < m_words.size() && i <= m_activeWord + TtsService::instance()->prefetchCount(); i++) {
+      prefetched_words.append(m_words.at(i).word());
+    }
+
+    TtsService::instance()->prefetchWords(prefetched_words);
+
     m_ui->m_listener->setCurrentIndex(0);
     m_ui->m_phoneWidget->setCurrentIndex(2);
   }
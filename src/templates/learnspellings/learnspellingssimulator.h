@@ -36,6 +36,8 @@
 #include "ui_learnspellingssimulator.h"
 #include "templates/learnspellings/learnspellingsitem.h"
 
+#include <QNetworkReply>
+
 
 namespace Ui {
   class LearnSpellingsSimulator;
@@ -50,11 +52,20 @@ class LearnSpellingsSimulator : public TemplateSimulator {
     explicit LearnSpellingsSimulator(TemplateCore *core, QWidget *parent = 0);
     virtual ~LearnSpellingsSimulator();
 
+    bool performAction(const QString &action, const QString &argument = QString());
+    QString simulationState() const;
+
   public slots:
     bool startSimulation();
     bool stopSimulation();
     bool goBack();
 
+    void onItemInserted(int index);
+    void onItemRemoved(int index);
+    void onItemMoved(int from_index, int to_index);
+    void onItemModified(int index);
+    void onMetadataModified();
+
   private slots:
     void start();
     void restart();
@@ -63,11 +74,27 @@ class LearnSpellingsSimulator : public TemplateSimulator {
     void skipThisWord();
     void spellThisWord();
     void loadNextWord();
+    void onAudioReady(const QString &word, const QString &audio_file);
+    void onAudioFailed(const QString &word, QNetworkReply::NetworkError error);
+
+  private:
+    // Evaluates entered spelling of active word and displays
+    // page with the result.
+    void checkSpelling(const QString &guessed_word);
+
+    // Updates "word number" header after words were patched by the editor.
+    void refreshWordNumber();
+
+    // Returns true if simulation is running and follows editor changes.
+    bool isRunning() const;
 
   private:
     Ui::LearnSpellingsSimulator *m_ui;
     QList<LearnSpellingsItem> m_words;
     int m_activeWord;
+
+    // Word whose audio was requested and should be played once it is available.
+    QString m_pendingWord;
     int m_resultCorrect;
     int m_resultIncorrect;
     int m_resultSkipped;
@@ -35,6 +35,7 @@
 #include "core/templatefactory.h"
 #include "core/templatecore.h"
 #include "core/templateentrypoint.h"
+#include "miscellaneous/performancemonitor.h"
 
 #include <QTimer>
 
@@ -100,6 +101,8 @@ BasicmLearningEditor::~BasicmLearningEditor() {
 }
 
 bool BasicmLearningEditor::loadBundleData(const QString &bundle_data) {
+  PERF_SCOPE("bundle.load");
+
   QDomDocument bundle_document;
   bundle_document.setContent(bundle_data);
 
@@ -166,6 +169,7 @@ void BasicmLearningEditor::addNewItem(const QString &title, const QString &descr
   }
 
   updateItemCount();
+  emit itemInserted(m_ui->m_listItems->currentRow());
 }
 
 void BasicmLearningEditor::addNewItem() {
@@ -202,6 +206,7 @@ void BasicmLearningEditor::onAuthorChanged(const QString& new_author) {
   checkAuthor();
 
   launch();
+  emit metadataModified();
   emit changed();
 }
 
@@ -211,6 +216,7 @@ void BasicmLearningEditor::onNameChanged(const QString& new_name) {
   checkName();
 
   launch();
+  emit metadataModified();
   emit changed();
 }
 
@@ -247,6 +253,10 @@ QList<BasicmLearningItem> BasicmLearningEditor::activeItems() const {
   return questions;
 }
 
+BasicmLearningItem BasicmLearningEditor::itemAt(int index) const {
+  return m_ui->m_listItems->item(index)->data(Qt::UserRole).value<BasicmLearningItem>();
+}
+
 bool BasicmLearningEditor::canGenerateApplications() {
   return
       !activeItems().isEmpty() &&
@@ -255,6 +265,8 @@ bool BasicmLearningEditor::canGenerateApplications() {
 }
 
 QString BasicmLearningEditor::generateBundleData() {
+  PERF_SCOPE("bundle.generate");
+
   /*if (!canGenerateApplications()) {
     return QString();
   }*/
@@ -309,6 +321,7 @@ void BasicmLearningEditor::removeSelectedItem() {
     }
 
     delete m_ui->m_listItems->takeItem(current_row);
+    emit itemRemoved(current_row);
   }
 
   updateItemCount();
@@ -324,6 +337,8 @@ void BasicmLearningEditor::saveItem() {
   {
     m_ui->m_listItems->currentItem()->setData(Qt::UserRole, QVariant::fromValue(m_activeItem));
     m_ui->m_listItems->currentItem()->setText(m_activeItem.title());
+
+    emit itemModified(m_ui->m_listItems->currentRow());
   }
 
   emit changed();
@@ -360,6 +375,7 @@ void BasicmLearningEditor::moveItemUp() {
   m_ui->m_listItems->insertItem(index - 1, m_ui->m_listItems->takeItem(index));
   m_ui->m_listItems->setCurrentRow(index - 1);
 
+  emit itemMoved(index, index - 1);
   emit changed();
 }
 
@@ -369,6 +385,7 @@ void BasicmLearningEditor::moveItemDown() {
   m_ui->m_listItems->insertItem(index + 1, m_ui->m_listItems->takeItem(index));
   m_ui->m_listItems->setCurrentRow(index + 1);
 
+  emit itemMoved(index, index + 1);
   emit changed();
 }
 
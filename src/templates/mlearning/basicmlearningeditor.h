@@ -54,6 +54,7 @@ class BasicmLearningEditor : public TemplateEditor {
     virtual ~BasicmLearningEditor();
 
     QList<BasicmLearningItem> activeItems() const;
+    BasicmLearningItem itemAt(int index) const;
 
     bool canGenerateApplications();
     QString generateBundleData();
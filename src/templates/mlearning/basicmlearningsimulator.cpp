@@ -91,6 +91,97 @@ bool BasicmLearningSimulator::goBack() {
   }
 }
 
+bool BasicmLearningSimulator::performAction(const QString &action, const QString &argument) {
+  if (action == "open" && m_ui->m_phoneWidget->currentIndex() == 1) {
+    QListWidgetItem *list_item = m_ui->m_listItems->item(argument.toInt());
+
+    if (list_item == NULL) {
+      return false;
+    }
+
+    m_ui->m_listItems->setCurrentItem(list_item);
+    displayDescription(list_item);
+    return true;
+  }
+  else {
+    return TemplateSimulator::performAction(action, argument);
+  }
+}
+
+QString BasicmLearningSimulator::simulationState() const {
+  switch (m_ui->m_phoneWidget->currentIndex()) {
+    case 0:
+      return "stopped";
+
+    case 1:
+      return QString("list %1").arg(QString::number(m_ui->m_listItems->count()));
+
+    default:
+      return QString("item %1").arg(QString::number(m_ui->m_listItems->currentRow()));
+  }
+}
+
+void BasicmLearningSimulator::onItemInserted(int index) {
+  if (m_ui->m_phoneWidget->currentIndex() == 0) {
+    return;
+  }
+
+  BasicmLearningItem item = static_cast<BasicmLearningEditor*>(core()->editor())->itemAt(index);
+  QListWidgetItem *list_item = new QListWidgetItem(item.title());
+
+  list_item->setData(Qt::UserRole, QVariant::fromValue(item));
+  m_ui->m_listItems->insertItem(index, list_item);
+}
+
+void BasicmLearningSimulator::onItemRemoved(int index) {
+  if (m_ui->m_phoneWidget->currentIndex() == 0) {
+    return;
+  }
+
+  if (m_ui->m_phoneWidget->currentIndex() == 2 && m_ui->m_listItems->currentRow() == index) {
+    // Details of removed item are displayed, return to the list.
+    goBack();
+  }
+
+  delete m_ui->m_listItems->takeItem(index);
+
+  if (m_ui->m_listItems->count() == 0) {
+    // There is nothing to simulate anymore.
+    stopSimulation();
+    emit simulationStopRequested();
+  }
+}
+
+void BasicmLearningSimulator::onItemMoved(int from_index, int to_index) {
+  if (m_ui->m_phoneWidget->currentIndex() == 0) {
+    return;
+  }
+
+  bool was_current = m_ui->m_listItems->currentRow() == from_index;
+
+  m_ui->m_listItems->insertItem(to_index, m_ui->m_listItems->takeItem(from_index));
+
+  if (was_current) {
+    m_ui->m_listItems->setCurrentRow(to_index);
+  }
+}
+
+void BasicmLearningSimulator::onItemModified(int index) {
+  if (m_ui->m_phoneWidget->currentIndex() == 0 || index < 0 || index >= m_ui->m_listItems->count()) {
+    return;
+  }
+
+  BasicmLearningItem item = static_cast<BasicmLearningEditor*>(core()->editor())->itemAt(index);
+  QListWidgetItem *list_item = m_ui->m_listItems->item(index);
+
+  list_item->setText(item.title());
+  list_item->setData(Qt::UserRole, QVariant::fromValue(item));
+
+  if (m_ui->m_phoneWidget->currentIndex() == 2 && m_ui->m_listItems->currentRow() == index) {
+    m_ui->m_lblDetails->setText(item.description());
+  }
+}
+
 void BasicmLearningSimulator::displayDescription(QListWidgetItem *list_item) {
   m_ui->m_lblDetails->setText(list_item->data(Qt::UserRole).value<BasicmLearningItem>().description());
   m_ui->m_phoneWidget->setCurrentIndex(2);
@@ -47,11 +47,19 @@ class BasicmLearningSimulator : public TemplateSimulator {
     explicit BasicmLearningSimulator(TemplateCore *core, QWidget *parent = 0);
     virtual ~BasicmLearningSimulator();
 
+    bool performAction(const QString &action, const QString &argument = QString());
+    QString simulationState() const;
+
   public slots:
     bool startSimulation();
     bool stopSimulation();
     bool goBack();
 
+    void onItemInserted(int index);
+    void onItemRemoved(int index);
+    void onItemMoved(int from_index, int to_index);
+    void onItemModified(int index);
+
   private slots:
     void displayDescription(QListWidgetItem *list_item);
 
@@ -35,6 +35,7 @@
 #include "core/templatefactory.h"
 #include "core/templatecore.h"
 #include "core/templateentrypoint.h"
+#include "miscellaneous/performancemonitor.h"
 
 #include <QToolTip>
 #include <QTimer>
@@ -148,6 +149,10 @@ QList<QuizQuestion> QuizEditor::activeQuestions() const {
   return questions;
 }
 
+QuizQuestion QuizEditor::questionAt(int index) const {
+  return m_ui->m_listQuestions->item(index)->data(Qt::UserRole).value<QuizQuestion>();
+}
+
 QString QuizEditor::projectName() {
   return m_ui->m_txtName->lineEdit()->text();
 }
@@ -198,6 +203,7 @@ void QuizEditor::addQuestion(const QString &question, const QStringList &answers
   }
 
   updateQuestionCount();
+  emit itemInserted(m_ui->m_listQuestions->currentRow());
 }
 
 void QuizEditor::addQuestion() {
@@ -273,6 +279,7 @@ void QuizEditor::removeQuestion() {
     }
 
     delete m_ui->m_listQuestions->takeItem(current_row);
+    emit itemRemoved(current_row);
   }
 
   updateQuestionCount();
@@ -335,6 +342,7 @@ void QuizEditor::saveQuestion() {
   m_ui->m_listQuestions->currentItem()->setData(Qt::UserRole, QVariant::fromValue(m_activeQuestion));
   m_ui->m_listQuestions->currentItem()->setText(m_activeQuestion.question());
 
+  emit itemModified(m_ui->m_listQuestions->currentRow());
   emit changed();
 }
 
@@ -344,6 +352,7 @@ void QuizEditor::moveQuestionUp() {
   m_ui->m_listQuestions->insertItem(index - 1, m_ui->m_listQuestions->takeItem(index));
   m_ui->m_listQuestions->setCurrentRow(index - 1);
 
+  emit itemMoved(index, index - 1);
   emit changed();
 }
 
@@ -353,6 +362,7 @@ void QuizEditor::moveQuestionDown() {
   m_ui->m_listQuestions->insertItem(index + 1, m_ui->m_listQuestions->takeItem(index));
   m_ui->m_listQuestions->setCurrentRow(index + 1);
 
+  emit itemMoved(index, index + 1);
   emit changed();
 }
 
@@ -404,12 +414,14 @@ void QuizEditor::checkAuthor() {
 void QuizEditor::updateNameStatus() {
   checkName();
   launch();
+  emit metadataModified();
   emit changed();
 }
 
 void QuizEditor::updateAuthorStatus() {
   checkAuthor();
   launch();
+  emit metadataModified();
   emit changed();
 }
 
@@ -421,6 +433,8 @@ bool QuizEditor::canGenerateApplications() {
 }
 
 bool QuizEditor::loadBundleData(const QString &bundle_data) {
+  PERF_SCOPE("bundle.load");
+
   QDomDocument bundle_document;
   bundle_document.setContent(bundle_data);
 
@@ -460,6 +474,8 @@ bool QuizEditor::loadBundleData(const QString &bundle_data) {
 }
 
 QString QuizEditor::generateBundleData() {
+  PERF_SCOPE("bundle.generate");
+
   /*if (!canGenerateApplications()) {
     return QString();
   }*/
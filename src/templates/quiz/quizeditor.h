@@ -67,6 +67,11 @@ class QuizEditor : public TemplateEditor {
     /// \return Returns list of added questions.
     QList<QuizQuestion> activeQuestions() const;
 
+    /// \brief Access to single added question.
+    /// \param index Position of question.
+    /// \return Returns question at given position.
+    QuizQuestion questionAt(int index) const;
+
     QString projectName();
     QString authorName();
 
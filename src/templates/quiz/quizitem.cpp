@@ -134,23 +134,50 @@ void QuizItem::onSubmitClicked() {
       }
     }
 
-    if (selected_answer == m_question.correctAnswer()) {
-      m_ui->m_lblWarning->setText("That is correct answer.");
-      m_answerButtons.at(selected_answer)->setStyleSheet("background-color: green;");
-      m_state = AnsweredCorrectly;
-    }
-    else {
-      m_ui->m_lblWarning->setText("That is wrong answer.");
-      m_answerButtons.at(selected_answer)->setStyleSheet("background-color: red;");
-      m_answerButtons.at(m_question.correctAnswer())->setStyleSheet("background-color: green;");
-      m_state = AnsweredWrongly;
-    }
+    displayAnswer(selected_answer);
+    emit questionAnswered(selected_answer);
+  }
+}
 
-    foreach (QRadioButton *button, m_answerButtons) {
-      button->setEnabled(false);
-    }
+bool QuizItem::submitAnswer(int selected_answer) {
+  if (!m_ui->m_btnConfirm->isEnabled()) {
+    return false;
+  }
 
-    m_ui->m_btnConfirm->setEnabled(false);
-    m_ui->m_lblWarning->setVisible(true);
+  if (selected_answer >= 0 && selected_answer < m_answerButtons.size()) {
+    m_answerButtons.at(selected_answer)->setChecked(true);
+  }
+
+  m_ui->m_btnConfirm->click();
+  return true;
+}
+
+void QuizItem::restoreAnswer(int selected_answer) {
+  reset();
+
+  if (selected_answer >= 0 && selected_answer < m_answerButtons.size()) {
+    m_answerButtons.at(selected_answer)->setChecked(true);
+    displayAnswer(selected_answer);
+  }
+}
+
+void QuizItem::displayAnswer(int selected_answer) {
+  if (selected_answer == m_question.correctAnswer()) {
+    m_ui->m_lblWarning->setText("That is correct answer.");
+    m_answerButtons.at(selected_answer)->setStyleSheet("background-color: green;");
+    m_state = AnsweredCorrectly;
   }
+  else {
+    m_ui->m_lblWarning->setText("That is wrong answer.");
+    m_answerButtons.at(selected_answer)->setStyleSheet("background-color: red;");
+    m_answerButtons.at(m_question.correctAnswer())->setStyleSheet("background-color: green;");
+    m_state = AnsweredWrongly;
+  }
+
+  foreach (QRadioButton *button, m_answerButtons) {
+    button->setEnabled(false);
+  }
+
+  m_ui->m_btnConfirm->setEnabled(false);
+  m_ui->m_lblWarning->setVisible(true);
 }
@@ -68,6 +68,20 @@ class QuizItem : public QWidget {
     /// \return Returns the state of quiz question widget.
     State state() const;
 
+    /// \brief Restores previously submitted answer.
+    /// \param selected_answer Index of selected answer or -1 if
+    /// question was not answered yet.
+    /// \remarks This is used when widget is recycled for another
+    /// question and user returns to already answered question.
+    void restoreAnswer(int selected_answer);
+
+    /// \brief Selects given answer and submits it as user would do.
+    /// \param selected_answer Index of answer to select.
+    /// \return Returns true if answer was submitted, false if
+    /// question was already answered.
+    /// \remarks This is used by scripted simulation runs.
+    bool submitAnswer(int selected_answer);
+
   public slots:
     /// \brief Resets widget for the question to its original/default state.
     void reset();
@@ -76,6 +90,10 @@ class QuizItem : public QWidget {
     /// \brief Emitted if users clicks "Next" or "Submit"
     void questionSubmitted();
 
+    /// \brief Emitted if user confirms some answer.
+    /// \param selected_answer Index of selected answer.
+    void questionAnswered(int selected_answer);
+
   private slots:
     void onNextClicked();
     void onSubmitClicked();
@@ -84,6 +102,7 @@ class QuizItem : public QWidget {
     void setupButtons();
     void createConnections();
     void clearStylesheets();
+    void displayAnswer(int selected_answer);
 
   private:
     State m_state;
@@ -43,7 +43,8 @@
 
 
 QuizSimulator::QuizSimulator(TemplateCore *core, QWidget *parent)
-  : TemplateSimulator(core, parent), m_ui(new Ui::QuizSimulator) {
+  : TemplateSimulator(core, parent), m_ui(new Ui::QuizSimulator), m_questionItem(NULL),
+    m_questions(QList<QuizQuestion>()), m_answers(QVector<qint8>()), m_activeQuestion(-1) {
   m_ui->setupUi(this);
 
   QFont caption_font = m_ui->m_lblHeading->font();
@@ -70,30 +71,16 @@ bool QuizSimulator::startSimulation() {
     return false;
   }
 
-  // Remove existing questions.
-  while (m_ui->m_phoneWidget->count() > 3) {
-    QWidget *question_widget = m_ui->m_phoneWidget->widget(2);
-
-    m_ui->m_phoneWidget->removeWidget(question_widget);
-    question_widget->deleteLater();
-  }
-
-  // Load the questions, setup the quiz and start it.
+  // Load the questions, setup the quiz and start it. Widgets for questions
+  // are not created here, single recycled widget is bound to active question
+  // once user gets there.
   m_ui->m_btnStart->setEnabled(true);
   m_ui->m_lblAuthor->setText(editor->m_ui->m_txtAuthor->lineEdit()->text());
   m_ui->m_lblHeading->setText(editor->m_ui->m_txtName->lineEdit()->text());
 
-  int question_number = 1;
-  QList<QuizQuestion> questions = editor->activeQuestions();
-
-  foreach (const QuizQuestion &question, questions) {
-    QuizItem *item = new QuizItem(m_ui->m_phoneWidget);
-
-    connect(item, SIGNAL(questionSubmitted()), this, SLOT(questionSubmitted()));
-
-    item->setQuestion(question, question_number++, questions.size());
-    m_ui->m_phoneWidget->insertWidget(m_ui->m_phoneWidget->count() - 1, item);
-  }
+  m_questions = editor->activeQuestions();
+  m_answers.fill(-1, m_questions.size());
+  m_activeQuestion = -1;
 
   m_ui->m_phoneWidget->setCurrentIndex(1);
   return true;
@@ -111,33 +98,218 @@ bool QuizSimulator::goBack() {
   return false;
 }
 
+bool QuizSimulator::performAction(const QString &action, const QString &argument) {
+  QWidget *active_page = m_ui->m_phoneWidget->currentWidget();
+
+  if (action == "start" && m_ui->m_phoneWidget->currentIndex() == 1) {
+    start();
+    return true;
+  }
+  else if (action == "answer" && active_page == m_questionItem && m_questionItem != NULL) {
+    return m_questionItem->submitAnswer(argument.toInt());
+  }
+  else if (action == "next" && active_page == m_questionItem && m_questionItem != NULL) {
+    questionSubmitted();
+    return true;
+  }
+  else if (action == "restart" && active_page == m_ui->m_pageFinish) {
+    restart();
+    return true;
+  }
+  else if (action == "exit" && active_page == m_ui->m_pageFinish) {
+    exit();
+    return true;
+  }
+  else {
+    return TemplateSimulator::performAction(action, argument);
+  }
+}
+
+QString QuizSimulator::simulationState() const {
+  QWidget *active_page = m_ui->m_phoneWidget->currentWidget();
+
+  if (m_ui->m_phoneWidget->currentIndex() == 0) {
+    return "stopped";
+  }
+  else if (m_ui->m_phoneWidget->currentIndex() == 1) {
+    return "welcome";
+  }
+  else if (active_page == m_questionItem && m_questionItem != NULL) {
+    return QString("question %1/%2").arg(QString::number(m_activeQuestion + 1),
+                                         QString::number(m_questions.size()));
+  }
+  else {
+    int answered_correctly, answered_wrongly, unanswered;
+
+    countResults(answered_correctly, answered_wrongly, unanswered);
+    return QString("finished correct=%1 wrong=%2 unanswered=%3").arg(QString::number(answered_correctly),
+                                                                    QString::number(answered_wrongly),
+                                                                    QString::number(unanswered));
+  }
+}
+
+void QuizSimulator::onItemInserted(int index) {
+  if (!isRunning()) {
+    return;
+  }
+
+  QuizEditor *editor = static_cast<QuizEditor*>(core()->editor());
+
+  m_questions.insert(index, editor->questionAt(index));
+  m_answers.insert(index, -1);
+
+  if (m_activeQuestion >= index) {
+    m_activeQuestion++;
+  }
+
+  refreshActivePage();
+}
+
+void QuizSimulator::onItemRemoved(int index) {
+  if (!isRunning()) {
+    return;
+  }
+
+  m_questions.removeAt(index);
+  m_answers.remove(index);
+
+  if (m_questions.isEmpty()) {
+    // There is nothing to simulate anymore.
+    exit();
+    return;
+  }
+
+  if (m_activeQuestion > index) {
+    m_activeQuestion--;
+  }
+  else if (m_activeQuestion == index &&
+           m_ui->m_phoneWidget->currentWidget() == m_questionItem) {
+    // Displayed question was removed, bind next question
+    // or go to "summary" if removed question was the last one.
+    if (index < m_questions.size()) {
+      displayQuestion(index);
+    }
+    else {
+      m_activeQuestion = -1;
+      m_ui->m_phoneWidget->setCurrentWidget(m_ui->m_pageFinish);
+    }
+  }
+
+  refreshActivePage();
+}
+
+void QuizSimulator::onItemMoved(int from_index, int to_index) {
+  if (!isRunning()) {
+    return;
+  }
+
+  qint8 answer = m_answers.at(from_index);
+
+  m_questions.move(from_index, to_index);
+  m_answers.remove(from_index);
+  m_answers.insert(to_index, answer);
+
+  if (m_activeQuestion == from_index) {
+    m_activeQuestion = to_index;
+  }
+  else if (from_index < m_activeQuestion && to_index >= m_activeQuestion) {
+    m_activeQuestion--;
+  }
+  else if (from_index > m_activeQuestion && to_index <= m_activeQuestion) {
+    m_activeQuestion++;
+  }
+
+  refreshActivePage();
+}
+
+void QuizSimulator::onItemModified(int index) {
+  if (!isRunning() || index < 0 || index >= m_questions.size()) {
+    return;
+  }
+
+  m_questions[index] = static_cast<QuizEditor*>(core()->editor())->questionAt(index);
+  refreshActivePage();
+}
+
+void QuizSimulator::onMetadataModified() {
+  if (!isRunning()) {
+    return;
+  }
+
+  QuizEditor *editor = static_cast<QuizEditor*>(core()->editor());
+
+  m_ui->m_lblAuthor->setText(editor->m_ui->m_txtAuthor->lineEdit()->text());
+  m_ui->m_lblHeading->setText(editor->m_ui->m_txtName->lineEdit()->text());
+}
+
+bool QuizSimulator::isRunning() const {
+  return m_ui->m_phoneWidget->currentIndex() != 0;
+}
+
+void QuizSimulator::refreshActivePage() {
+  QWidget *active_page = m_ui->m_phoneWidget->currentWidget();
+
+  if (active_page == m_questionItem && m_activeQuestion >= 0) {
+    // Rebind active question, its number or contents might have changed.
+    // Selected answer is restored and evaluated against new correct answer.
+    m_questionItem->setQuestion(m_questions.at(m_activeQuestion), m_activeQuestion + 1, m_questions.size());
+    m_questionItem->restoreAnswer(m_answers.at(m_activeQuestion));
+  }
+  else if (active_page == m_ui->m_pageFinish) {
+    prepareSummary();
+  }
+}
+
 void QuizSimulator::start() {
-  m_ui->m_phoneWidget->setCurrentIndex(2);
+  displayQuestion(0);
 }
 
-void QuizSimulator::prepareSummary() {
-  int answered_correctly = 0;
-  int answered_wrongly = 0;
-  int unanswered = 0;
-
-  for (int i = 2; i < m_ui->m_phoneWidget->count() - 1; i++) {
-    QuizItem *widget = static_cast<QuizItem*>(m_ui->m_phoneWidget->widget(i));
-
-    switch (widget->state()) {
-      case QuizItem::AnsweredCorrectly:
-        answered_correctly++;
-        break;
-
-      case QuizItem::AnsweredWrongly:
-        answered_wrongly++;
-        break;
-
-      case QuizItem::Unanswered:
-      default:
-        unanswered++;
-        break;
+QuizItem *QuizSimulator::questionItem() {
+  if (m_questionItem == NULL) {
+    m_questionItem = new QuizItem(m_ui->m_phoneWidget);
+
+    connect(m_questionItem, SIGNAL(questionSubmitted()), this, SLOT(questionSubmitted()));
+    connect(m_questionItem, SIGNAL(questionAnswered(int)), this, SLOT(questionAnswered(int)));
+
+    m_ui->m_phoneWidget->insertWidget(m_ui->m_phoneWidget->indexOf(m_ui->m_pageFinish), m_questionItem);
+  }
+
+  return m_questionItem;
+}
+
+void QuizSimulator::displayQuestion(int index) {
+  QuizItem *item = questionItem();
+
+  m_activeQuestion = index;
+
+  item->setQuestion(m_questions.at(index), index + 1, m_questions.size());
+  item->restoreAnswer(m_answers.at(index));
+
+  m_ui->m_phoneWidget->setCurrentWidget(item);
+}
+
+void QuizSimulator::countResults(int &answered_correctly, int &answered_wrongly, int &unanswered) const {
+  answered_correctly = 0;
+  answered_wrongly = 0;
+  unanswered = 0;
+
+  for (int i = 0; i < m_answers.size(); i++) {
+    if (m_answers.at(i) < 0) {
+      unanswered++;
+    }
+    else if (m_answers.at(i) == m_questions.at(i).correctAnswer()) {
+      answered_correctly++;
+    }
+    else {
+      answered_wrongly++;
     }
   }
+}
+
+void QuizSimulator::prepareSummary() {
+  int answered_correctly, answered_wrongly, unanswered;
+
+  countResults(answered_correctly, answered_wrongly, unanswered);
 
   m_ui->m_lblTotalCorrect->setText(tr("Total correct %1").arg(answered_correctly));
   m_ui->m_lblTotalWrong->setText(tr("Total wrong %1").arg(answered_wrongly));
@@ -145,21 +317,26 @@ void QuizSimulator::prepareSummary() {
 }
 
 void QuizSimulator::questionSubmitted() {
-  int current_index = m_ui->m_phoneWidget->currentIndex();
-
-  if (current_index == m_ui->m_phoneWidget->count() - 2) {
+  if (m_activeQuestion + 1 < m_questions.size()) {
+    displayQuestion(m_activeQuestion + 1);
+  }
+  else {
     // This is the last confirmed question. Go to "summary".
     prepareSummary();
+    m_ui->m_phoneWidget->setCurrentWidget(m_ui->m_pageFinish);
   }
+}
 
-  m_ui->m_phoneWidget->setCurrentIndex(current_index + 1);
+void QuizSimulator::questionAnswered(int selected_answer) {
+  if (m_activeQuestion >= 0 && m_activeQuestion < m_answers.size()) {
+    m_answers[m_activeQuestion] = selected_answer;
+  }
 }
 
 void QuizSimulator::restart() {
   // Reset all the questions.
-  for (int i = 2; i < m_ui->m_phoneWidget->count() - 1; i++) {
-    static_cast<QuizItem*>(m_ui->m_phoneWidget->widget(i))->reset();
-  }
+  m_answers.fill(-1);
+  m_activeQuestion = -1;
 
   m_ui->m_phoneWidget->setCurrentIndex(1);
 }
@@ -34,6 +34,9 @@
 #include "core/templatesimulator.h"
 
 #include "ui_quizsimulator.h"
+#include "templates/quiz/quizquestion.h"
+
+#include <QVector>
 
 
 namespace Ui {
@@ -41,6 +44,7 @@ namespace Ui {
 }
 
 class TemplateCore;
+class QuizItem;
 class QLabel;
 class QPushButton;
 class QRadioButton;
@@ -55,11 +59,20 @@ class QuizSimulator : public TemplateSimulator {
     explicit QuizSimulator(TemplateCore *core, QWidget *parent = 0);
     virtual ~QuizSimulator();
 
+    bool performAction(const QString &action, const QString &argument = QString());
+    QString simulationState() const;
+
   public slots:
     bool startSimulation();
     bool stopSimulation();
     bool goBack();
 
+    void onItemInserted(int index);
+    void onItemRemoved(int index);
+    void onItemMoved(int from_index, int to_index);
+    void onItemModified(int index);
+    void onMetadataModified();
+
   private slots:
     void start();
     void restart();
@@ -67,9 +80,34 @@ class QuizSimulator : public TemplateSimulator {
 
     void prepareSummary();
     void questionSubmitted();
+    void questionAnswered(int selected_answer);
+
+  private:
+    // Returns recycled widget for displaying of questions, widget
+    // is created when it is needed for the first time.
+    QuizItem *questionItem();
+
+    // Binds question with given index to recycled widget and displays it.
+    void displayQuestion(int index);
+
+    // Counts results of all questions.
+    void countResults(int &answered_correctly, int &answered_wrongly, int &unanswered) const;
+
+    // Refreshes currently displayed page after questions
+    // were patched by the editor.
+    void refreshActivePage();
+
+    // Returns true if simulation is running and follows editor changes.
+    bool isRunning() const;
 
   private:
     Ui::QuizSimulator *m_ui;
+    QuizItem *m_questionItem;
+    QList<QuizQuestion> m_questions;
+
+    // Selected answers for all questions, -1 for unanswered questions.
+    QVector<qint8> m_answers;
+    int m_activeQuestion;
 };
 
 #endif // QUIZSIMULATOR_H
@@ -35,6 +35,7 @@
 #include "core/templatefactory.h"
 #include "core/templatecore.h"
 #include "core/templateentrypoint.h"
+#include "miscellaneous/performancemonitor.h"
 
 #include <QToolTip>
 #include <QTimer>
@@ -469,6 +470,8 @@ bool SampleEditor::canGenerateApplications() {
 }
 
 bool SampleEditor::loadBundleData(const QString &bundle_data) {
+  PERF_SCOPE("bundle.load");
+
   QDomDocument bundle_document;
   bundle_document.setContent(bundle_data);
 
@@ -508,6 +511,8 @@ bool SampleEditor::loadBundleData(const QString &bundle_data) {
 }
 
 QString SampleEditor::generateBundleData() {
+  PERF_SCOPE("bundle.generate");
+
   /*if (!canGenerateApplications()) {
     return QString();
   }*/
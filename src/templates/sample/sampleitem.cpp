@@ -110,6 +110,19 @@ void SampleItem::reset() {
   m_state = Unanswered;
 }
 
+bool SampleItem::submitAnswer(int selected_answer) {
+  if (!m_ui->m_btnConfirm->isEnabled()) {
+    return false;
+  }
+
+  if (selected_answer >= 0 && selected_answer < m_answerButtons.size()) {
+    m_answerButtons.at(selected_answer)->setChecked(true);
+  }
+
+  m_ui->m_btnConfirm->click();
+  return true;
+}
+
 void SampleItem::onNextClicked() {
   // Just signal that user is done with this question.
   emit questionSubmitted();
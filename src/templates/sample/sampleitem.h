@@ -68,6 +68,13 @@ class SampleItem : public QWidget {
     /// \return Returns the state of sample question widget.
     State state() const;
 
+    /// \brief Selects given answer and submits it as user would do.
+    /// \param selected_answer Index of answer to select.
+    /// \return Returns true if answer was submitted, false if
+    /// question was already answered.
+    /// \remarks This is used by scripted simulation runs.
+    bool submitAnswer(int selected_answer);
+
   public slots:
     /// \brief Resets widget for the question to its original/default state.
     void reset();
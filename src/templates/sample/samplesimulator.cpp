@@ -113,6 +113,43 @@ bool SampleSimulator::goBack() {
   return false;
 }
 
+bool SampleSimulator::performAction(const QString &action, const QString &argument) {
+  int current_index = m_ui->m_phoneWidget->currentIndex();
+  SampleItem *item = qobject_cast<SampleItem*>(m_ui->m_phoneWidget->currentWidget());
+
+  if (action == "start" && current_index == 1) {
+    start();
+    return true;
+  }
+  else if (action == "continue" && current_index == 2) {
+    continueBtn();
+    return true;
+  }
+  else if (action == "answer" && item != NULL) {
+    return item->submitAnswer(argument.toInt());
+  }
+  else if (action == "next" && item != NULL) {
+    questionSubmitted();
+    return true;
+  }
+  else if (action == "restart" && current_index == m_ui->m_phoneWidget->count() - 1) {
+    restart();
+    return true;
+  }
+  else if (action == "exit" && current_index == m_ui->m_phoneWidget->count() - 1) {
+    exit();
+    return true;
+  }
+  else {
+    return TemplateSimulator::performAction(action, argument);
+  }
+}
+
+QString SampleSimulator::simulationState() const {
+  return QString("page %1/%2").arg(QString::number(m_ui->m_phoneWidget->currentIndex()),
+                                   QString::number(m_ui->m_phoneWidget->count()));
+}
+
 void SampleSimulator::start() {
   m_ui->m_phoneWidget->setCurrentIndex(2);
 }
@@ -56,6 +56,9 @@ class SampleSimulator : public TemplateSimulator {
     explicit SampleSimulator(TemplateCore *core, QWidget *parent = 0);
     virtual ~SampleSimulator();
 
+    bool performAction(const QString &action, const QString &argument = QString());
+    QString simulationState() const;
+
   public slots:
     bool startSimulation();
     bool stopSimulation();
@@ -0,0 +1,325 @@
+/*
+  Copyright (c) 2012, BuildmLearn Contributors listed at http://buildmlearn.org/people/
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+
+  * Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+
+  * Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+
+  * Neither the name of the BuildmLearn nor the names of its
+    contributors may be used to endorse or promote products derived from
+    this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "storetest.h"
+
+#include "definitions/definitions.h"
+#include "miscellaneous/application.h"
+#include "miscellaneous/settings.h"
+#include "miscellaneous/storefactory.h"
+#include "network-web/fakestoreserver.h"
+#include "network-web/bundleuploader.h"
+#include "network-web/downloader.h"
+#include "network-web/ttsservice.h"
+
+#include <QtTest>
+#include <QBuffer>
+#include <QEventLoop>
+#include <QTimer>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QDomDocument>
+
+
+#define TEST_TIMEOUT 10000
+
+static const char *TEST_BUNDLE =
+    "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+    "<buildmlearn_application type=\"test\">\n"
+    "  <data>\n"
+    "    <item><word>alpha</word></item>\n"
+    "    <item><word>beta</word></item>\n"
+    "    <item><word>gamma</word></item>\n"
+    "  </data>\n"
+    "</buildmlearn_application>\n";
+
+void StoreTest::requestCompleted(QNetworkReply::NetworkError status, const QByteArray &contents) {
+  m_completed = true;
+  m_status = status;
+  m_contents = contents;
+}
+
+void StoreTest::batchFinished(const QHash<QString, QString> &audio_files, int failed_words) {
+  m_completed = true;
+  m_audioFiles = audio_files;
+  m_failedWords = failed_words;
+}
+
+void StoreTest::initTestCase() {
+  m_testDirectory = QDir::tempPath() + QDir::separator() +
+                    QString("%1-tests-%2").arg(APP_LOW_NAME, QString::number(Application::applicationPid()));
+
+  QVERIFY(QDir().mkpath(m_testDirectory));
+}
+
+void StoreTest::init() {
+  Settings *settings = qApp->settings();
+
+  m_server = new FakeStoreServer(this);
+  m_completed = false;
+  m_status = QNetworkReply::NoError;
+  m_contents.clear();
+  m_audioFiles.clear();
+  m_failedWords = 0;
+
+  // Each test starts with default upload behavior.
+  settings->setValue(APP_CFG_GEN, "upload_chunk_size", UPLOAD_CHUNK_SIZE);
+  settings->setValue(APP_CFG_GEN, "upload_max_retries", UPLOAD_MAX_RETRIES);
+
+  QVERIFY(m_server->start());
+}
+
+void StoreTest::cleanup() {
+  delete m_server;
+  m_server = NULL;
+}
+
+void StoreTest::cleanupTestCase() {
+  QDir test_directory(m_testDirectory);
+
+  foreach (const QString &file_name, test_directory.entryList(QDir::Files)) {
+    test_directory.remove(file_name);
+  }
+
+  QDir().rmdir(m_testDirectory);
+}
+
+void StoreTest::endpointDiscovery() {
+  Downloader downloader;
+
+  connect(&downloader, SIGNAL(completed(QNetworkReply::NetworkError,QByteArray)),
+          this, SLOT(requestCompleted(QNetworkReply::NetworkError,QByteArray)));
+  downloader.downloadFile(m_server->endpointUrl());
+
+  QVERIFY(waitForSignal(&downloader, SIGNAL(completed(QNetworkReply::NetworkError,QByteArray))));
+  QCOMPARE(m_status, QNetworkReply::NoError);
+  QCOMPARE(QString::fromUtf8(m_contents), m_server->uploadUrl());
+}
+
+void StoreTest::multipartUpload() {
+  BundleUploader uploader;
+  QByteArray bundle_data(TEST_BUNDLE);
+
+  uploader.setChunkedUploads(false);
+  uploader.setDeltaUploads(false);
+
+  QVERIFY(upload(&uploader, bundle_data));
+  QCOMPARE(StoreFactory::parseResponseXml(m_status, m_contents), StoreFactory::Success);
+  QCOMPARE(m_server->storedBundles(), 1);
+  QCOMPARE(m_server->lastBundle(), bundle_data);
+  QCOMPARE(m_server->lastFields().value("key"), QByteArray(STORE_API_KEY));
+  QCOMPARE(m_server->lastFields().value("application_name"), QByteArray("Test application"));
+  QVERIFY(!m_server->lastFields().contains("upload_id"));
+}
+
+void StoreTest::chunkedUpload() {
+  BundleUploader uploader;
+  QByteArray bundle_data(5000, 'x');
+
+  // Chunk size is given in kilobytes.
+  qApp->settings()->setValue(APP_CFG_GEN, "upload_chunk_size", 1);
+  uploader.setChunkedUploads(true);
+  uploader.setDeltaUploads(false);
+
+  QVERIFY(upload(&uploader, bundle_data));
+  QCOMPARE(StoreFactory::parseResponseXml(m_status, m_contents), StoreFactory::Success);
+  QCOMPARE(m_server->requestCount(), 5);
+  QCOMPARE(m_server->storedBundles(), 1);
+  QCOMPARE(m_server->receivedBytes(), (qint64) bundle_data.size());
+
+  // Only the first chunk carries all fields.
+  QVERIFY(!m_server->lastFields().contains("application_name"));
+}
+
+void StoreTest::legacyStoreChunks() {
+  BundleUploader uploader;
+  QByteArray bundle_data(3000, 'x');
+
+  qApp->settings()->setValue(APP_CFG_GEN, "upload_chunk_size", 1);
+  m_server->setChunkedUploads(false);
+  uploader.setChunkedUploads(true);
+  uploader.setDeltaUploads(false);
+
+  // Legacy store answers the first chunk with final status, so only
+  // the first chunk is uploaded and treated as complete upload.
+  QVERIFY(upload(&uploader, bundle_data));
+  QCOMPARE(StoreFactory::parseResponseXml(m_status, m_contents), StoreFactory::Success);
+  QCOMPARE(m_server->requestCount(), 1);
+}
+
+void StoreTest::injectedFailure() {
+  BundleUploader uploader;
+
+  qApp->settings()->setValue(APP_CFG_GEN, "upload_max_retries", 0);
+  m_server->setFailureRate(100);
+  uploader.setChunkedUploads(false);
+  uploader.setDeltaUploads(false);
+
+  QVERIFY(upload(&uploader, QByteArray(TEST_BUNDLE)));
+  QVERIFY(m_status != QNetworkReply::NoError);
+  QCOMPARE(StoreFactory::parseResponseXml(m_status, m_contents), StoreFactory::NetworkError);
+  QCOMPARE(m_server->storedBundles(), 0);
+}
+
+void StoreTest::deltaBundle() {
+  QDomDocument bundle_document;
+
+  QVERIFY(bundle_document.setContent(QString(TEST_BUNDLE)));
+
+  QStringList item_hashes = StoreFactory::bundleItemHashes(bundle_document);
+  QSet<QString> missing_hashes;
+
+  QCOMPARE(item_hashes.size(), 3);
+  QCOMPARE(item_hashes.toSet().size(), 3);
+
+  missing_hashes.insert(item_hashes.at(1));
+
+  QString delta_bundle = StoreFactory::createDeltaBundle(bundle_document, item_hashes, missing_hashes);
+
+  QVERIFY(!delta_bundle.contains("alpha"));
+  QVERIFY(delta_bundle.contains("beta"));
+  QVERIFY(!delta_bundle.contains("gamma"));
+  QVERIFY(delta_bundle.contains(item_hashes.at(0)));
+
+  // Hashes which do not match items are refused.
+  QVERIFY(StoreFactory::createDeltaBundle(bundle_document, item_hashes.mid(1), missing_hashes).isEmpty());
+
+  QCOMPARE(StoreFactory::parseMissingItems("<response><status>success</status><missing>"
+                                           "<hash>a1</hash><hash>b2</hash></missing></response>"),
+           QSet<QString>() << "a1" << "b2");
+}
+
+void StoreTest::deltaUpload() {
+  BundleUploader uploader;
+  QDomDocument bundle_document;
+
+  QVERIFY(bundle_document.setContent(QString(TEST_BUNDLE)));
+
+  QStringList item_hashes = StoreFactory::bundleItemHashes(bundle_document);
+
+  // Store already has the first two items.
+  m_server->setKnownItems(QSet<QString>() << item_hashes.at(0) << item_hashes.at(1));
+  uploader.setChunkedUploads(false);
+  uploader.setDeltaUploads(true);
+
+  QVERIFY(upload(&uploader, QByteArray(TEST_BUNDLE)));
+  QCOMPARE(StoreFactory::parseResponseXml(m_status, m_contents), StoreFactory::Success);
+
+  // Items query and upload of delta bundle.
+  QCOMPARE(m_server->requestCount(), 2);
+  QCOMPARE(m_server->lastFields().value("delta"), QByteArray("1"));
+  QVERIFY(!m_server->lastBundle().contains("alpha"));
+  QVERIFY(!m_server->lastBundle().contains("beta"));
+  QVERIFY(m_server->lastBundle().contains("gamma"));
+}
+
+void StoreTest::ttsBatch() {
+  Settings *settings = qApp->settings();
+  TtsService *service = TtsService::instance();
+  QStringList words = QStringList() << "alpha" << "beta" << "alpha";
+
+  // Stand-in answers each request with non-empty body, that is enough for the cache.
+  settings->setValue(APP_CFG_TTS, "service_url", m_server->endpointUrl() + "?word=%1&locale=%2&voice=%3");
+  settings->setValue(APP_CFG_TTS, "cache_directory", m_testDirectory);
+  service->clearCache();
+
+  connect(service, SIGNAL(batchFinished(QHash<QString,QString>,int)), this, SLOT(batchFinished(QHash<QString,QString>,int)));
+
+  QVERIFY(service->startBatch(words));
+  QVERIFY(service->isBatchRunning());
+  QVERIFY(!service->startBatch(words));
+  QVERIFY(waitForSignal(service, SIGNAL(batchFinished(QHash<QString,QString>,int))));
+  QVERIFY(!service->isBatchRunning());
+  QCOMPARE(m_failedWords, 0);
+  QCOMPARE(m_audioFiles.size(), 2);
+  QVERIFY(QFile::exists(m_audioFiles.value("alpha")));
+  QVERIFY(QFile::exists(m_audioFiles.value("beta")));
+
+  // Pinned files survive clearing of the cache until they are released.
+  service->clearCache();
+  QVERIFY(QFile::exists(m_audioFiles.value("alpha")));
+
+  service->releaseFiles(m_audioFiles.values());
+  service->clearCache();
+  QVERIFY(!QFile::exists(m_audioFiles.value("alpha")));
+
+  disconnect(service, SIGNAL(batchFinished(QHash<QString,QString>,int)), this, SLOT(batchFinished(QHash<QString,QString>,int)));
+}
+
+bool StoreTest::upload(BundleUploader *uploader, const QByteArray &bundle_data) {
+  QBuffer *bundle_buffer = new QBuffer();
+
+  bundle_buffer->setData(bundle_data);
+  bundle_buffer->open(QIODevice::ReadOnly);
+
+  connect(uploader, SIGNAL(completed(QNetworkReply::NetworkError,QByteArray)),
+          this, SLOT(requestCompleted(QNetworkReply::NetworkError,QByteArray)));
+  uploader->upload(m_server->uploadUrl(), bundle_buffer, STORE_API_KEY, "Test author",
+                   "test@localhost", "Test application", QString());
+
+  return m_completed || waitForSignal(uploader, SIGNAL(completed(QNetworkReply::NetworkError,QByteArray)));
+}
+
+bool StoreTest::waitForSignal(QObject *sender, const char *signal) {
+  QEventLoop loop;
+  QTimer timer;
+
+  timer.setSingleShot(true);
+  connect(&timer, SIGNAL(timeout()), &loop, SLOT(quit()));
+  connect(sender, signal, &loop, SLOT(quit()));
+
+  timer.start(TEST_TIMEOUT);
+  loop.exec();
+
+  return m_completed;
+}
+
+int main(int argc, char *argv[]) {
+  // Portable settings next to the test keep user settings untouched.
+  QString settings_directory = QFileInfo(QString::fromLocal8Bit(argv[0])).absolutePath() +
+                               QDir::separator() + APP_CFG_PATH;
+  QFile settings_file(settings_directory + QDir::separator() + APP_CFG_FILE);
+
+  QDir().mkpath(settings_directory);
+  settings_file.open(QIODevice::WriteOnly | QIODevice::Append);
+  settings_file.close();
+
+#if QT_VERSION >= 0x050000
+  if (qgetenv("QT_QPA_PLATFORM").isEmpty()) {
+    qputenv("QT_QPA_PLATFORM", "offscreen");
+  }
+#endif
+
+  Application application(argc, argv);
+  StoreTest test;
+
+  return QTest::qExec(&test, argc, argv);
+}
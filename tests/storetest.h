@@ -0,0 +1,86 @@
+/*
+  Copyright (c) 2012, BuildmLearn Contributors listed at http://buildmlearn.org/people/
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are met:
+
+  * Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+
+  * Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+
+  * Neither the name of the BuildmLearn nor the names of its
+    contributors may be used to endorse or promote products derived from
+    this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef STORETEST_H
+#define STORETEST_H
+
+#include <QObject>
+
+#include <QNetworkReply>
+#include <QHash>
+
+
+class FakeStoreServer;
+class BundleUploader;
+
+/// \brief Tests of store uploads and text-to-speech against local stand-ins.
+///
+/// FakeStoreServer stands in for BuildmLearn Store and for text-to-speech
+/// service, so tests do not need network access.
+class StoreTest : public QObject {
+    Q_OBJECT
+
+  public slots:
+    // Collect results of asynchronous operations.
+    void requestCompleted(QNetworkReply::NetworkError status, const QByteArray &contents);
+    void batchFinished(const QHash<QString, QString> &audio_files, int failed_words);
+
+  private slots:
+    void initTestCase();
+    void init();
+    void cleanup();
+    void cleanupTestCase();
+
+    void endpointDiscovery();
+    void multipartUpload();
+    void chunkedUpload();
+    void legacyStoreChunks();
+    void injectedFailure();
+    void deltaBundle();
+    void deltaUpload();
+    void ttsBatch();
+
+  private:
+    // Uploads bundle and waits until upload completes, returns false on timeout.
+    bool upload(BundleUploader *uploader, const QByteArray &bundle_data);
+
+    // Waits until given signal is emitted, returns false on timeout.
+    bool waitForSignal(QObject *sender, const char *signal);
+
+    FakeStoreServer *m_server;
+    QString m_testDirectory;
+    bool m_completed;
+    QNetworkReply::NetworkError m_status;
+    QByteArray m_contents;
+    QHash<QString, QString> m_audioFiles;
+    int m_failedWords;
+};
+
+#endif // STORETEST_H